@@ -6,1486 +6,3695 @@
 #include <cmath>
 #include <cstring>
 
-// VSeq: 3 CV sequencers + 1 gate sequencer
+// VSeq: CV sequencers + 1 gate sequencer, sized by the factory specifications
 // - Clock and Reset inputs
-// - 3 CV sequencers × 3 outputs = 9 CV outputs
-// - 1 Gate sequencer with 6 tracks
-// - Each sequencer has 32 steps
+// - VSeq: up to 3 CV sequencers × 3 outputs, 6 gate tracks, 32 steps
+// - VSeq Lite: up to 1 CV sequencer × 3 outputs, 4 gate tracks, 16 steps
 // - Direction control: Forward, Backward, Pingpong
 // - Section looping with configurable repeats
 // - Fill feature for gate sequencer
+// - Per-sequencer clock division/multiplication, scheduled to the sample
 
-struct VSeq : public _NT_algorithm {
-    // Sequencer data: 3 CV sequencers × 32 steps × 3 outputs
-    int16_t stepValues[3][32][3];
-    
-    // Gate sequencer data: 6 tracks × 32 steps
-    // 0 = off, 1 = normal velocity, 2 = accent velocity
-    uint8_t gateSteps[6][32];
-    
-    // CV Sequencer state (3 sequencers)
-    int currentStep[3];         // Current step for each sequencer (0-31)
-    bool pingpongForward[3];    // Direction state for pingpong mode
-    int section1Counter[3];     // Track section 1 repeat count
-    int section2Counter[3];     // Track section 2 repeat count
-    bool inSection2[3];         // Which section is currently playing
-    
-    // Gate sequencer state (6 tracks)
-    int gateCurrentStep[6];     // Current step for each gate track (0-31)
-    bool gatePingpongForward[6]; // Direction state for pingpong mode
-    int gateSwingCounter[6];    // Counter for swing timing
-    int gateSection1Counter[6]; // Track section 1 repeat count
-    int gateSection2Counter[6]; // Track section 2 repeat count
-    bool gateInSection2[6];     // Which section is currently playing
-    bool gateInFill[6];         // Whether we're in the fill section
-    int gateTriggerCounter[6];  // Countdown for trigger pulse duration
-    bool gateTriggered[6];      // Whether gate was just triggered this step
+// Maximum number of rising edges recorded per block on each of the clock and reset inputs.
+// A rising edge needs at least one low frame before it, so this covers blocks of up to 128 frames.
+static const int kMaxEdgesPerBlock = 64;
+
+// Most outputs a CV sequencer can have; the editor has one pot per output
+static const int kMaxOuts = 3;
+
+// Size of a VSeq instance, chosen by the factory specifications. Clock tracks are the CV
+// sequencers followed by the gate tracks; output slots are the CV outputs (sequencer-major)
+// followed by the gate outputs and the clock output.
+struct VSeqDims {
+    int cvSeqs;         // CV sequencers
+    int outs;           // Outputs per CV sequencer (1 to kMaxOuts)
+    int gateTracks;     // Gate tracks
+    int maxSteps;       // Steps per track (up to 32, one bit each in the step masks)
+    int banks;          // Pattern banks held in DRAM
     
-    // Edge detection
-    float lastClockIn;
-    float lastResetIn;
+    int tracks() const { return cvSeqs + gateTracks; }
+    int cvSlots() const { return cvSeqs * outs; }
+    int clockOutSlot() const { return cvSlots() + gateTracks; }
+    int outputSlots() const { return clockOutSlot() + 1; }
+};
+
+// Hands out consecutive aligned arrays from one memory block. With a NULL base it only
+// adds up the size, so the same layout code serves calculateRequirements and construct.
+struct MemoryCarver {
+    uint8_t* base;
+    uint32_t used;
     
-    // UI state
-    int selectedStep;           // 0-31
-    int selectedSeq;            // 0-2 for CV seqs, 3 for gate seq
-    int selectedTrack;          // 0-5 (for gate sequencer)
-    int lastSelectedStep;       // Track when step changes to update pots
-    uint16_t lastButton4State;  // For debouncing button 4
-    uint16_t lastEncoderRButton; // For debouncing right encoder button
-    float lastPotLValue;        // Track left pot position for relative movement
-    bool potCaught[3];          // Track if each pot has caught the step value
-    bool trackPotCaught;        // Track if left pot has caught track position (for gate seq)
+    explicit MemoryCarver(uint8_t* base_) : base(base_), used(0) {}
+    
+    template <class T>
+    T* take(int count) {
+        used = (used + 7u) & ~7u;
+        T* p = base ? (T*)(base + used) : NULL;
+        used += (uint32_t)(sizeof(T) * count);
+        return p;
+    }
+};
+
+// Timed events waiting to fire, kept sorted by time
+// Times are absolute sample counts; comparisons use wrapping differences
+struct ClockEvent {
+    uint32_t time;      // Sample at which the event fires
+    uint8_t type;       // What to do when it fires
+    uint8_t track;      // Clock track it belongs to
+};
+
+enum {
+    kEventSubTick = 0,  // Clock multiplier sub-tick
+    kEventSwungTick,    // Gate track tick delayed by swing
+    kEventGateOff,      // End of a trigger pulse
+    kEventNoteOff,      // End of a CV sequencer's MIDI notes
+    kEventClockOutOff,  // End of a clock output pulse
+    kEventRatchet,      // Gate track sub-trigger within a ratcheted step
+};
+
+static const int kMaxClockEvents = 48;
+
+struct ClockEventQueue {
+    ClockEvent events[kMaxClockEvents];
+    int count;
     
-    // Debug: track actual output bus assignments
-    int debugOutputBus[12];
+    // Insert keeping time order; events at the same time keep insertion order
+    void push(uint32_t time, uint8_t type, uint8_t track) {
+        if (count >= kMaxClockEvents) return;
+        int i = count;
+        while (i > 0 && (int32_t)(events[i - 1].time - time) > 0) {
+            events[i] = events[i - 1];
+            i--;
+        }
+        events[i].time = time;
+        events[i].type = type;
+        events[i].track = track;
+        count++;
+    }
     
-    VSeq() {
-        // Initialize step values to test patterns (visible voltages)
-        // Each sequencer gets different voltage levels for testing
-        for (int seq = 0; seq < 3; seq++) {
-            for (int step = 0; step < 32; step++) {
-                for (int out = 0; out < 3; out++) {
-                    // Create test patterns: different voltages for each output
-                    // seq 0: 2V, 4V, 6V
-                    // seq 1: 1V, 3V, 5V
-                    // seq 2: 3V, 5V, 7V
-                    float voltage = 2.0f + (seq * 1.0f) + (out * 2.0f);
-                    if (seq == 1) voltage -= 1.0f;
-                    
-                    // Convert voltage (0-10V range) to int16_t (-32768 to 32767)
-                    // 0V = -32768, 10V = 32767
-                    float normalized = voltage / 10.0f;  // 0.0-1.0
-                    stepValues[seq][step][out] = (int16_t)((normalized * 65535.0f) - 32768.0f);
-                }
+    // Remove and return the earliest event
+    ClockEvent pop() {
+        ClockEvent e = events[0];
+        for (int i = 1; i < count; i++) {
+            events[i - 1] = events[i];
+        }
+        count--;
+        return e;
+    }
+    
+    // Drop all pending events of one type for a track, returning how many were dropped
+    int cancel(uint8_t type, uint8_t track) {
+        int dst = 0;
+        for (int i = 0; i < count; i++) {
+            if (events[i].type != type || events[i].track != track) {
+                events[dst++] = events[i];
             }
-            currentStep[seq] = 0;
-            pingpongForward[seq] = true;
-            section1Counter[seq] = 0;
-            section2Counter[seq] = 0;
-            inSection2[seq] = false;
         }
+        int dropped = count - dst;
+        count = dst;
+        return dropped;
+    }
+};
+
+// Fill out[start, end) with one value, 4 frames per iteration once aligned
+static inline void fillSpan(float* out, int start, int end, float value) {
+    int frame = start;
+    for (; frame < end && (frame & 3); frame++) {
+        out[frame] = value;
+    }
+    for (; frame + 4 <= end; frame += 4) {
+        out[frame] = value;
+        out[frame + 1] = value;
+        out[frame + 2] = value;
+        out[frame + 3] = value;
+    }
+    for (; frame < end; frame++) {
+        out[frame] = value;
+    }
+}
+
+// Glide ramp shapes
+enum {
+    kRampLinear = 0,
+    kRampExponential
+};
+
+// Fill out[start, start + n) with a linear ramp that reaches 'target' 'left' frames after
+// 'start', 4 frames per iteration. Each frame is computed from the distance to the end, so
+// long ramps do not accumulate rounding.
+static inline void fillLinearRamp(float* out, int start, int n, float target, float increment, int left) {
+    float k0 = (float)left;
+    float k1 = k0 - 1.0f;
+    float k2 = k0 - 2.0f;
+    float k3 = k0 - 3.0f;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        out[start + i] = target - (increment * k0);
+        out[start + i + 1] = target - (increment * k1);
+        out[start + i + 2] = target - (increment * k2);
+        out[start + i + 3] = target - (increment * k3);
+        k0 -= 4.0f;
+        k1 -= 4.0f;
+        k2 -= 4.0f;
+        k3 -= 4.0f;
+    }
+    for (; i < n; i++) {
+        out[start + i] = target - (increment * k0);
+        k0 -= 1.0f;
+    }
+}
+
+// Fill out[start, start + n) with an exponential ramp from 'value' that closes the gap to
+// 'target' by 'ratio' per frame, 4 frames per iteration. Returns the value after the span.
+static inline float fillExponentialRamp(float* out, int start, int n, float value, float target, float ratio) {
+    float r2 = ratio * ratio;
+    float r4 = r2 * r2;
+    float d0 = value - target;
+    float d1 = d0 * ratio;
+    float d2 = d0 * r2;
+    float d3 = d1 * r2;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        out[start + i] = target + d0;
+        out[start + i + 1] = target + d1;
+        out[start + i + 2] = target + d2;
+        out[start + i + 3] = target + d3;
+        d0 *= r4;
+        d1 *= r4;
+        d2 *= r4;
+        d3 *= r4;
+    }
+    for (; i < n; i++) {
+        out[start + i] = target + d0;
+        d0 *= ratio;
+    }
+    return target + d0;
+}
+
+// Writes every output as a series of constant spans. Events set a slot's value at a
+// frame; the previous value is filled up to that frame and the rest waits for the next
+// change or the end of the block. A gliding slot writes a ramp instead until it reaches its
+// target, carrying the ramp across blocks; slots that are not gliding keep the constant path.
+struct OutputWriter {
+    float* busFrames;
+    int numFrames;
+    int numSlots;
+    int* bus;               // Output bus per slot for this block (0 = none, 1-28)
+    float* value;           // Value of the span in progress (while gliding, at the span start)
+    int* spanStart;         // Frame the span in progress started at
+    
+    // Glide ramp per slot, from the span start
+    int* rampLeft;          // Frames until the ramp reaches its target (0 = not gliding)
+    float* rampTarget;
+    float* rampStep;        // Linear: change per frame. Exponential: remaining gap ratio per frame
+    uint8_t* rampShape;
+    
+    // Take the per-slot arrays from instance memory
+    void carve(MemoryCarver& mem, int slots) {
+        numSlots = slots;
+        bus = mem.take<int>(slots);
+        value = mem.take<float>(slots);
+        spanStart = mem.take<int>(slots);
+        rampLeft = mem.take<int>(slots);
+        rampTarget = mem.take<float>(slots);
+        rampStep = mem.take<float>(slots);
+        rampShape = mem.take<uint8_t>(slots);
+    }
+    
+    void init() {
+        busFrames = NULL;
+        numFrames = 0;
+        for (int slot = 0; slot < numSlots; slot++) {
+            bus[slot] = 0;
+            value[slot] = 0.0f;
+            spanStart[slot] = 0;
+            rampLeft[slot] = 0;
+            rampTarget[slot] = 0.0f;
+            rampStep[slot] = 0.0f;
+            rampShape[slot] = kRampLinear;
+        }
+    }
+    
+    void beginBlock(float* frames, int frames_) {
+        busFrames = frames;
+        numFrames = frames_;
+        for (int slot = 0; slot < numSlots; slot++) {
+            spanStart[slot] = 0;
+        }
+    }
+    
+    float* output(int slot) const {
+        return busFrames + ((bus[slot] - 1) * numFrames);
+    }
+    
+    // Write the span in progress up to 'end' and start the next one there
+    void fillTo(int slot, int end) {
+        int frame = spanStart[slot];
+        if (end <= frame) return;
+        float* out = (bus[slot] > 0) ? output(slot) : NULL;
         
-        lastClockIn = 0.0f;
-        lastResetIn = 0.0f;
-        selectedStep = 0;
-        selectedSeq = 0;
-        selectedTrack = 0;
-        lastSelectedStep = 0;
-        lastButton4State = 0;
-        lastEncoderRButton = 0;
-        lastPotLValue = 0.5f;
-        potCaught[0] = false;
-        potCaught[1] = false;
-        potCaught[2] = false;
-        trackPotCaught = false;
-        
-        // Initialize gate sequencer
-        for (int track = 0; track < 6; track++) {
-            for (int step = 0; step < 32; step++) {
-                gateSteps[track][step] = false;
+        int left = rampLeft[slot];
+        if (left > 0) {
+            int n = (end - frame < left) ? end - frame : left;
+            float target = rampTarget[slot];
+            if (rampShape[slot] == kRampLinear) {
+                if (out) fillLinearRamp(out, frame, n, target, rampStep[slot], left);
+                value[slot] = target - (rampStep[slot] * (float)(left - n));
+            } else if (out) {
+                value[slot] = fillExponentialRamp(out, frame, n, value[slot], target, rampStep[slot]);
+            } else {
+                value[slot] = target + ((value[slot] - target) * powf(rampStep[slot], (float)n));
             }
-            gateCurrentStep[track] = 0;
-            gatePingpongForward[track] = true;
-            gateSwingCounter[track] = 0;
-            gateSection1Counter[track] = 0;
-            gateSection2Counter[track] = 0;
-            gateInSection2[track] = false;
-            gateInFill[track] = false;
-            gateTriggerCounter[track] = 0;
-            gateTriggered[track] = false;
+            left -= n;
+            frame += n;
+            rampLeft[slot] = left;
+            if (left == 0) value[slot] = target;
         }
         
-        for (int i = 0; i < 12; i++) {
-            debugOutputBus[i] = 0;
+        if (out && end > frame) {
+            fillSpan(out, frame, end, value[slot]);
         }
+        spanStart[slot] = end;
     }
     
-    // Advance sequencer to next step based on direction, with section looping
-    void advanceSequencer(int seq, int direction, int stepCount, int splitPoint, int sec1Reps, int sec2Reps) {
-        // If no sections (splitPoint >= stepCount), use simple wrapping logic
-        if (splitPoint >= stepCount) {
-            if (direction == 0) {
-                // Forward
-                currentStep[seq]++;
-                if (currentStep[seq] >= stepCount) {
-                    currentStep[seq] = 0;
-                }
-            } else if (direction == 1) {
-                // Backward
-                currentStep[seq]--;
-                if (currentStep[seq] < 0) {
-                    currentStep[seq] = stepCount - 1;
-                }
-            } else {
-                // Pingpong
-                if (pingpongForward[seq]) {
-                    currentStep[seq]++;
-                    if (currentStep[seq] >= stepCount) {
-                        currentStep[seq] = stepCount - 1;
-                        pingpongForward[seq] = false;
-                    }
-                } else {
-                    currentStep[seq]--;
-                    if (currentStep[seq] < 0) {
-                        currentStep[seq] = 0;
-                        pingpongForward[seq] = true;
-                    }
-                }
-            }
+    // Change a slot's value from 'frame' onwards, ending any glide
+    void set(int slot, int frame, float newValue) {
+        if (rampLeft[slot] == 0 && newValue == value[slot]) return;
+        fillTo(slot, frame);
+        spanStart[slot] = frame;
+        rampLeft[slot] = 0;
+        value[slot] = newValue;
+    }
+    
+    // Glide a slot from where it is at 'frame' to 'target' over 'frames'. An exponential ramp
+    // closes the gap by 'ratio' per frame and lands on the target at the end.
+    void glide(int slot, int frame, float target, int frames, int shape, float ratio) {
+        if (frames <= 0) {
+            set(slot, frame, target);
             return;
         }
-        
-        // Section-based logic
-        if (direction == 0) {
-            // Forward
-            currentStep[seq]++;
-            
-            // Check if we've reached the end of a section
-            if (!inSection2[seq]) {
-                // In section 1
-                if (currentStep[seq] >= splitPoint) {
-                    section1Counter[seq]++;
-                    if (section1Counter[seq] >= sec1Reps) {
-                        // Move to section 2
-                        inSection2[seq] = true;
-                        section1Counter[seq] = 0;
-                    } else {
-                        // Repeat section 1
-                        currentStep[seq] = 0;
-                    }
-                }
-            } else {
-                // In section 2
-                if (currentStep[seq] >= stepCount) {
-                    section2Counter[seq]++;
-                    if (section2Counter[seq] >= sec2Reps) {
-                        // Loop back to section 1
-                        inSection2[seq] = false;
-                        section2Counter[seq] = 0;
-                        currentStep[seq] = 0;
-                    } else {
-                        // Repeat section 2
-                        currentStep[seq] = splitPoint;
-                    }
-                }
-            }
-        } else if (direction == 1) {
-            // Backward
-            currentStep[seq]--;
-            
-            // Check if we've reached the start of a section
-            if (inSection2[seq]) {
-                // In section 2
-                if (currentStep[seq] < splitPoint) {
-                    section2Counter[seq]++;
-                    if (section2Counter[seq] >= sec2Reps) {
-                        // Move to section 1
-                        inSection2[seq] = false;
-                        section2Counter[seq] = 0;
-                    } else {
-                        // Repeat section 2
-                        currentStep[seq] = stepCount - 1;
-                    }
-                }
-            } else {
-                // In section 1
-                if (currentStep[seq] < 0) {
-                    section1Counter[seq]++;
-                    if (section1Counter[seq] >= sec1Reps) {
-                        // Move to section 2
-                        inSection2[seq] = true;
-                        section1Counter[seq] = 0;
-                        currentStep[seq] = stepCount - 1;
-                    } else {
-                        // Repeat section 1
-                        currentStep[seq] = splitPoint - 1;
-                    }
-                }
-            }
-        } else {
-            // Pingpong
-            if (pingpongForward[seq]) {
-                currentStep[seq]++;
-                if (currentStep[seq] >= stepCount) {
-                    currentStep[seq] = stepCount - 1;
-                    pingpongForward[seq] = false;
-                }
-            } else {
-                currentStep[seq]--;
-                if (currentStep[seq] <= 0) {
-                    currentStep[seq] = 0;
-                    pingpongForward[seq] = true;
-                }
-            }
+        fillTo(slot, frame);
+        spanStart[slot] = frame;
+        if (target == value[slot]) {
+            rampLeft[slot] = 0;
+            return;
         }
+        rampLeft[slot] = frames;
+        rampTarget[slot] = target;
+        rampShape[slot] = (uint8_t)shape;
+        rampStep[slot] = (shape == kRampLinear) ? (target - value[slot]) / (float)frames : ratio;
     }
     
-    void resetSequencer(int seq) {
-        int direction = 0;  // Will be set from parameters in process()
-        if (direction == 1) {
-            // Backward: start at last step
-            currentStep[seq] = 31;
-        } else {
-            // Forward and Pingpong: start at step 0
-            currentStep[seq] = 0;
-        }
-        pingpongForward[seq] = true;
-        section1Counter[seq] = 0;
-        section2Counter[seq] = 0;
-        inSection2[seq] = false;
-    }
-    
-    // Advance gate sequencer to next step based on direction, with section looping and fill
-    void advanceGateSequencer(int track, int direction, int trackLength, int splitPoint, 
-                              int sec1Reps, int sec2Reps, int fillStart) {
-        // If no sections (splitPoint >= trackLength), use simple wrapping logic
-        if (splitPoint >= trackLength) {
-            if (direction == 0) {
-                // Forward
-                gateCurrentStep[track]++;
-                if (gateCurrentStep[track] >= trackLength) {
-                    gateCurrentStep[track] = 0;
-                }
-            } else if (direction == 1) {
-                // Backward
-                gateCurrentStep[track]--;
-                if (gateCurrentStep[track] < 0) {
-                    gateCurrentStep[track] = trackLength - 1;
-                }
-            } else if (direction == 2) {
-                // Pingpong
-                if (gatePingpongForward[track]) {
-                    gateCurrentStep[track]++;
-                    if (gateCurrentStep[track] >= trackLength) {
-                        gateCurrentStep[track] = trackLength - 2;
-                        if (gateCurrentStep[track] < 0) gateCurrentStep[track] = 0;
-                        gatePingpongForward[track] = false;
-                    }
-                } else {
-                    gateCurrentStep[track]--;
-                    if (gateCurrentStep[track] < 0) {
-                        gateCurrentStep[track] = 1;
-                        if (gateCurrentStep[track] >= trackLength) gateCurrentStep[track] = trackLength - 1;
-                        gatePingpongForward[track] = true;
-                    }
-                }
-            }
+    // Move the target of a slot's glide at the start of a block, keeping the time it has left.
+    // A slot that is not gliding changes to 'target' at once.
+    void retarget(int slot, float target) {
+        if (rampLeft[slot] == 0) {
+            set(slot, 0, target);
             return;
         }
-        
-        // Section-based logic
-        // Determine section boundaries
-        int section1End = (splitPoint > 0 && splitPoint < trackLength) ? splitPoint : trackLength;
-        
-        if (direction == 0) {  // Forward
-            gateCurrentStep[track]++;
-            
-            // Check for fill trigger on last repetition of section 1
-            // Only if sections are enabled (splitPoint < trackLength) AND fill is enabled (fillStart > 0)
-            // AND we're actually repeating section 1 (sec1Reps > 1)
-            if (!gateInSection2[track] && 
-                splitPoint > 0 && 
-                splitPoint < trackLength &&
-                fillStart > 0 &&
-                fillStart < splitPoint &&
-                sec1Reps > 1 &&
-                gateSection1Counter[track] == sec1Reps - 1 &&
-                gateCurrentStep[track] >= fillStart) {
-                // Fill triggered! Jump to section 2
-                gateSection1Counter[track] = 0;
-                gateInSection2[track] = true;
-                gateCurrentStep[track] = splitPoint;
-            }
-            // Check if we've crossed a section boundary
-            else if (!gateInSection2[track] && gateCurrentStep[track] >= section1End) {
-                // Completed section 1
-                gateSection1Counter[track]++;
-                if (gateSection1Counter[track] >= sec1Reps) {
-                    // Move to section 2
-                    gateSection1Counter[track] = 0;
-                    gateInSection2[track] = true;
-                    if (splitPoint > 0) {
-                        gateCurrentStep[track] = splitPoint;
-                    } else {
-                        gateCurrentStep[track] = 0;
-                    }
-                } else {
-                    // Repeat section 1
-                    gateCurrentStep[track] = 0;
-                }
-            } else if (gateInSection2[track] && gateCurrentStep[track] >= trackLength) {
-                // Completed section 2
-                gateSection2Counter[track]++;
-                if (gateSection2Counter[track] >= sec2Reps) {
-                    // Back to section 1
-                    gateSection2Counter[track] = 0;
-                    gateInSection2[track] = false;
-                }
-                gateCurrentStep[track] = (splitPoint > 0) ? splitPoint : 0;
-                if (!gateInSection2[track]) {
-                    gateCurrentStep[track] = 0;
-                }
-            }
-        } else if (direction == 1) {  // Backward
-            gateCurrentStep[track]--;
-            
-            if (gateInSection2[track] && gateCurrentStep[track] < splitPoint) {
-                gateSection2Counter[track]++;
-                if (gateSection2Counter[track] >= sec2Reps) {
-                    gateSection2Counter[track] = 0;
-                    gateInSection2[track] = false;
-                    gateCurrentStep[track] = section1End - 1;
-                } else {
-                    gateCurrentStep[track] = trackLength - 1;
-                }
-            } else if (!gateInSection2[track] && gateCurrentStep[track] < 0) {
-                gateSection1Counter[track]++;
-                if (gateSection1Counter[track] >= sec1Reps) {
-                    gateSection1Counter[track] = 0;
-                    gateInSection2[track] = true;
-                    gateCurrentStep[track] = trackLength - 1;
-                } else {
-                    gateCurrentStep[track] = section1End - 1;
-                }
-            }
-        } else if (direction == 2) {  // Pingpong
-            if (gatePingpongForward[track]) {
-                gateCurrentStep[track]++;
-                if (gateCurrentStep[track] >= trackLength) {
-                    gateCurrentStep[track] = trackLength - 2;
-                    if (gateCurrentStep[track] < 0) gateCurrentStep[track] = 0;
-                    gatePingpongForward[track] = false;
-                }
+        if (target == rampTarget[slot]) return;
+        rampTarget[slot] = target;
+        if (rampShape[slot] == kRampLinear) {
+            rampStep[slot] = (target - value[slot]) / (float)rampLeft[slot];
+        }
+    }
+    
+    // Fill the remaining spans. Every slot with a bus writes all of its frames each block, as
+    // other algorithms may have written to the same bus since the last one.
+    void endBlock() {
+        for (int slot = 0; slot < numSlots; slot++) {
+            // A glide still moves on while the slot has no bus
+            if (bus[slot] > 0 || rampLeft[slot] > 0) fillTo(slot, numFrames);
+        }
+    }
+};
+
+// Most MIDI messages one block can send; the rest of a burst is dropped
+static const int kMaxMidiPerBlock = 128;
+
+// No note sounding on a CV output
+static const uint8_t kNoNote = 0xFF;
+
+struct MidiMessage {
+    uint16_t frame;     // Frame within the block the message belongs to
+    uint8_t status;
+    uint8_t data1;
+    uint8_t data2;
+};
+
+// MIDI sent during a block, collected with frame offsets and sent together in frame order by
+// flush() at the end of the block. Messages on the same frame keep the order they were added in.
+struct MidiStage {
+    MidiMessage messages[kMaxMidiPerBlock];
+    int count;
+    
+    void add(int frame, uint8_t status, uint8_t data1, uint8_t data2) {
+        if (count >= kMaxMidiPerBlock) return;
+        int i = count;
+        while (i > 0 && messages[i - 1].frame > frame) {
+            messages[i] = messages[i - 1];
+            i--;
+        }
+        messages[i].frame = (uint16_t)frame;
+        messages[i].status = status;
+        messages[i].data1 = data1;
+        messages[i].data2 = data2;
+        count++;
+    }
+    
+    // Add a control change, unless the batch already sends the same value on that controller on
+    // the same frame, as tracks sharing a CC number do when they fire together
+    void addControl(int frame, uint8_t status, uint8_t controller, uint8_t value) {
+        for (int i = 0; i < count; i++) {
+            const MidiMessage& m = messages[i];
+            if (m.frame == frame && m.status == status && m.data1 == controller && m.data2 == value) return;
+        }
+        add(frame, status, controller, value);
+    }
+    
+    void flush() {
+        for (int i = 0; i < count; i++) {
+            NT_sendMidi3ByteMessage(kNT_destinationInternal, messages[i].status, messages[i].data1, messages[i].data2);
+        }
+        count = 0;
+    }
+};
+
+// MIDI clocks (24 per quarter note) per clock edge: the engine steps on 16th notes
+static const int kMidiClocksPerStep = 6;
+
+// Most MIDI clock messages kept between two blocks
+static const int kMaxMidiClockMessages = 32;
+
+// Stands for a song position pointer among the realtime bytes waiting for step()
+static const uint8_t kMidiSongPosition = 0xF2;
+
+// Follows MIDI clock and transport. The MIDI callbacks run between blocks and only queue the
+// messages; step() applies them in order at the start of the next block.
+struct MidiClockFollower {
+    uint8_t pending[kMaxMidiClockMessages]; // Realtime status bytes, or kMidiSongPosition
+    int numPending;
+    uint16_t songPosition;      // 16th notes, from the latest song position pointer
+    
+    bool running;               // Between Start or Continue and Stop
+    int clockCount;             // MIDI clocks since the last clock edge
+    bool haveLastClock;         // Whether lastClockTime is valid
+    uint32_t lastClockTime;     // Block start the last MIDI clock arrived at
+    float clockPeriod;          // Smoothed samples per MIDI clock (0 = not yet known)
+    
+    void init() {
+        numPending = 0;
+        songPosition = 0;
+        running = false;
+        clockCount = 0;
+        haveLastClock = false;
+        clockPeriod = 0.0f;
+    }
+    
+    void receive(uint8_t byte) {
+        if (numPending < kMaxMidiClockMessages) pending[numPending++] = byte;
+    }
+    
+    // Fold in the time since the previous clock. The one-pole average smooths out the block
+    // granularity of the arrival times; a jump of more than half the period is a new tempo.
+    // Clocks that arrived before the same block all carry its start time, so only the first of
+    // them is timed: the 0 sample gap between them says nothing about the tempo.
+    void measure(uint32_t time) {
+        if (haveLastClock && time == lastClockTime) return;
+        if (haveLastClock) {
+            float interval = (float)(time - lastClockTime);
+            if (clockPeriod <= 0.0f || fabsf(interval - clockPeriod) > 0.5f * clockPeriod) {
+                clockPeriod = interval;
             } else {
-                gateCurrentStep[track]--;
-                if (gateCurrentStep[track] < 0) {
-                    gateCurrentStep[track] = 1;
-                    if (gateCurrentStep[track] >= trackLength) gateCurrentStep[track] = trackLength - 1;
-                    gatePingpongForward[track] = true;
-                }
+                clockPeriod += (interval - clockPeriod) * 0.125f;
             }
         }
+        lastClockTime = time;
+        haveLastClock = true;
     }
 };
 
-// Helper function to set a pixel in NT_screen
-// Screen is 256x64, stored as 128x64 bytes (2 pixels per byte, 4-bit grayscale)
-inline void setPixel(int x, int y, int brightness) {
-    if (x < 0 || x >= 256 || y < 0 || y >= 64) return;
+// Clock shared between the instances of the plugin, in its static memory. Each block the lead
+// instance publishes the clock edges and resets it played, its tempo and its song position;
+// followers play those instead of scanning their own inputs. All instances run on the audio
+// thread one after another, so a follower placed after the lead in the algorithm list plays the
+// same block's edges, and one placed before it plays them one block later.
+struct SharedClock {
+    uint32_t block;             // Blocks published by the lead (0 = none yet)
+    uint16_t numEdges;
+    uint16_t numResets;
+    uint16_t edges[kMaxEdgesPerBlock];  // Frame offsets of the block's clock edges
+    uint16_t resets[kMaxEdgesPerBlock]; // Frame offsets of the block's resets
+    uint32_t clockPeriod;       // Lead's samples between clock edges (0 = not yet known)
+    uint32_t position;          // Lead's clock edges since its last reset, at the start of the block
+                                // (or where a song position pointer moved it)
+    uint32_t seeks;             // Song position jumps made by the lead, so followers jump too
     
-    int byteIndex = (y * 128) + (x / 2);
-    int pixelShift = (x & 1) ? 0 : 4;  // Even pixels in high nibble, odd in low
+    void init() {
+        block = 0;
+        numEdges = 0;
+        numResets = 0;
+        clockPeriod = 0;
+        position = 0;
+        seeks = 0;
+    }
+};
+
+static SharedClock* sharedClock = NULL;
+
+// Step edits queued by the UI and applied by step() at the start of the next block
+enum {
+    kEditCvValue = 0,       // Set one output of a CV step
+    kEditGateCycle,         // Advance a gate step to its next state (off → normal → accent)
+    kEditSectionReset,      // Move a sequencer's split point and reset its repeats after a length change
+    kEditSelectBank,        // Queue a switch to another pattern bank
+    kEditGateRatchet,       // Set a gate step's ratchet count (value 1-8)
+    kEditGateChance,        // Set how far a gate step's chance is below 100% (value 0-7 eighths)
+    kEditCvGlide,           // Toggle whether a CV step glides into its values
+    kEditScale,             // Rebuild a CV sequencer's quantiser table after its scale changed
+    kEditBake,              // Write a gate track's generated pattern into its steps and turn the generator off
+    kEditGateSet            // Set a gate step's state, keeping its ratchets and chance (value 0-2)
+};
+
+struct StepEdit {
+    uint8_t type;
+    uint8_t bank;           // Pattern bank the step edit was made in
+    uint8_t lane;           // CV sequencer or gate track
+    uint8_t step;
+    uint8_t out;
+    int16_t value;          // CV value, the new split point, or the bank to switch to
+};
+
+static const int kEditQueueSize = 64;   // Power of two
+
+// Single-producer/single-consumer ring of step edits. The UI thread (customUi and
+// parameterChanged) stages edits and publishes them together with commit(), so all the edits of
+// one call land in the same block. Recording uses a second ring that step() both fills and
+// drains, so step data keeps applyEdits as its only writer.
+struct EditQueue {
+    StepEdit edits[kEditQueueSize];
+    volatile uint32_t head;     // Published edits (written by the UI only)
+    volatile uint32_t tail;     // Applied edits (written by step() only)
+    uint32_t staged;            // Edits written but not yet published (UI only)
     
-    // Clear the nibble and set new value
-    NT_screen[byteIndex] = (NT_screen[byteIndex] & (0x0F << (4 - pixelShift))) | ((brightness & 0x0F) << pixelShift);
+    void init() {
+        head = 0;
+        tail = 0;
+        staged = 0;
+    }
+    
+    bool push(const StepEdit& e) {
+        if (staged - tail >= (uint32_t)kEditQueueSize) return false;  // Full; the edit is dropped
+        edits[staged & (kEditQueueSize - 1)] = e;
+        staged++;
+        return true;
+    }
+    
+    void commit() {
+        __sync_synchronize();   // Edits are written before they are published
+        head = staged;
+    }
+    
+    bool pop(StepEdit& e) {
+        uint32_t t = tail;
+        if (t == head) return false;
+        __sync_synchronize();
+        e = edits[t & (kEditQueueSize - 1)];
+        __sync_synchronize();   // The slot is read before it is handed back
+        tail = t + 1;
+        return true;
+    }
+};
+
+// A gate step is one byte: its state (0 = off, 1 = normal, 2 = accent), ratchet count - 1 and
+// how far its chance is below 100% in eighths. A byte of 0-2 is a plain step that always plays once.
+enum {
+    kGateStateMask = 0x03,
+    kGateRatchetShift = 2,
+    kGateRatchetMask = 0x1C,
+    kGateChanceShift = 5,
+    kGateChanceMask = 0xE0
+};
+
+static const int kMaxRatchets = 8;
+static const int kChanceLevels = 8;
+
+static inline int gateState(uint8_t step) {
+    return step & kGateStateMask;
 }
 
-// Parameter indices
+// Triggers in the step, 1-8
+static inline int gateRatchets(uint8_t step) {
+    return ((step & kGateRatchetMask) >> kGateRatchetShift) + 1;
+}
+
+// Chance of the step playing, in eighths (8 = always)
+static inline int gateChance(uint8_t step) {
+    return kChanceLevels - ((step & kGateChanceMask) >> kGateChanceShift);
+}
+
+// Gate output level while a trigger is high
+static const float kGateHighVolts = 5.0f;
+
+// The CV range in semitones at 1V/oct: 0-10V, with 0V as MIDI note 0
+static const int kScaleSemitones = 120;
+static const int kScaleNotes = kScaleSemitones + 1;
+
+static inline int clampInt(int value, int min, int max) {
+    return (value < min) ? min : (value > max ? max : value);
+}
+
+// Nearest semitone of a step value, by integer rounding from the full int16 range
+static inline int stepSemitone(int16_t value) {
+    return (((int32_t)value + 32768) * kScaleSemitones + 32767) / 65535;
+}
+
+// CV inputs that modulate a clock track, read once per block
+static const int kNumModInputs = 4;
+
+// What a modulation input moves: length, split and fill start in steps (10V spans the most
+// steps), transposition in semitones at 1V/oct
 enum {
-    kParamClockIn = 0,
-    kParamResetIn,
-    // Sequencer 1 outputs
-    kParamSeq1Out1,
-    kParamSeq1Out2,
-    kParamSeq1Out3,
-    // Sequencer 2 outputs
-    kParamSeq2Out1,
-    kParamSeq2Out2,
-    kParamSeq2Out3,
-    // Sequencer 3 outputs
-    kParamSeq3Out1,
-    kParamSeq3Out2,
-    kParamSeq3Out3,
-    // MIDI channels for CV sequencer outputs (9 total)
-    kParamSeq1Midi1,
-    kParamSeq1Midi2,
-    kParamSeq1Midi3,
-    kParamSeq2Midi1,
-    kParamSeq2Midi2,
-    kParamSeq2Midi3,
-    kParamSeq3Midi1,
-    kParamSeq3Midi2,
-    kParamSeq3Midi3,
-    // MIDI velocity source parameters (one per CV sequencer)
-    kParamSeq1MidiVelocity,
-    kParamSeq2MidiVelocity,
-    kParamSeq3MidiVelocity,
-    // MIDI channel for trigger sequencer (shared by all 6 tracks)
-    kParamTriggerMidiChannel,
-    // Trigger sequencer velocity parameters
-    kParamTriggerMasterVelocity,
-    kParamTriggerMasterAccent,
-    // Per-sequencer parameters
-    kParamSeq1ClockDiv,
-    kParamSeq1Direction,
-    kParamSeq1StepCount,
-    kParamSeq1SplitPoint,
-    kParamSeq1Section1Reps,
-    kParamSeq1Section2Reps,
-    kParamSeq2ClockDiv,
-    kParamSeq2Direction,
-    kParamSeq2StepCount,
-    kParamSeq2SplitPoint,
-    kParamSeq2Section1Reps,
-    kParamSeq2Section2Reps,
-    kParamSeq3ClockDiv,
-    kParamSeq3Direction,
-    kParamSeq3StepCount,
-    kParamSeq3SplitPoint,
-    kParamSeq3Section1Reps,
-    kParamSeq3Section2Reps,
-    // Gate outputs and MIDI CCs (6 tracks)
-    kParamGate1Out,
-    kParamGate1CC,
-    kParamGate2Out,
-    kParamGate2CC,
-    kParamGate3Out,
-    kParamGate3CC,
-    kParamGate4Out,
-    kParamGate4CC,
-    kParamGate5Out,
-    kParamGate5CC,
-    kParamGate6Out,
-    kParamGate6CC,
-    // Gate Track 1 parameters (no longer includes Out param)
-    kParamGate1Run,
-    kParamGate1Length,
-    kParamGate1Direction,
-    kParamGate1ClockDiv,
-    kParamGate1Swing,
-    kParamGate1SplitPoint,
-    kParamGate1Section1Reps,
-    kParamGate1Section2Reps,
-    kParamGate1FillStart,
-    // Gate Track 2 parameters (no longer includes Out param)
-    kParamGate2Run,
-    kParamGate2Length,
-    kParamGate2Direction,
-    kParamGate2ClockDiv,
-    kParamGate2Swing,
-    kParamGate2SplitPoint,
-    kParamGate2Section1Reps,
-    kParamGate2Section2Reps,
-    kParamGate2FillStart,
-    // Gate Track 3 parameters (no longer includes Out param)
-    kParamGate3Run,
-    kParamGate3Length,
-    kParamGate3Direction,
-    kParamGate3ClockDiv,
-    kParamGate3Swing,
-    kParamGate3SplitPoint,
-    kParamGate3Section1Reps,
-    kParamGate3Section2Reps,
-    kParamGate3FillStart,
-    // Gate Track 4 parameters (no longer includes Out param)
-    kParamGate4Run,
-    kParamGate4Length,
-    kParamGate4Direction,
-    kParamGate4ClockDiv,
-    kParamGate4Swing,
-    kParamGate4SplitPoint,
-    kParamGate4Section1Reps,
-    kParamGate4Section2Reps,
-    kParamGate4FillStart,
-    // Gate Track 5 parameters (no longer includes Out param)
-    kParamGate5Run,
-    kParamGate5Length,
-    kParamGate5Direction,
-    kParamGate5ClockDiv,
-    kParamGate5Swing,
-    kParamGate5SplitPoint,
-    kParamGate5Section1Reps,
-    kParamGate5Section2Reps,
-    kParamGate5FillStart,
-    // Gate Track 6 parameters (no longer includes Out param)
-    kParamGate6Run,
-    kParamGate6Length,
-    kParamGate6Direction,
-    kParamGate6ClockDiv,
-    kParamGate6Swing,
-    kParamGate6SplitPoint,
-    kParamGate6Section1Reps,
-    kParamGate6Section2Reps,
-    kParamGate6FillStart,
-    kNumParameters
+    kModLength = 0,
+    kModSplit,
+    kModTranspose,
+    kModFill,
+    kNumModTargets
 };
 
-// String arrays for enum parameters
-static const char* const divisionStrings[] = {
-    "/16", "/8", "/4", "/2", "x1", "x2", "x4", "x8", "x16", NULL
+// How far past a rounding point an input must move before its value changes, in steps or
+// semitones, so a noisy or slow CV does not flicker between two values
+static const float kModHysteresis = 0.25f;
+
+struct ModInput {
+    uint8_t bus;                // 0 = none, 1-28 = bus 0-27
+    uint8_t target;
+    uint8_t track;              // Clock track modulated
+    int8_t value;               // Offset after hysteresis
 };
 
-static const char* const directionStrings[] = {
-    "Forward", "Backward", "Pingpong", NULL
+// Gate track generators: the track plays a pattern computed from a few parameters instead of
+// its stored steps, keeping the stored ratchets and chance
+enum {
+    kGeneratorOff = 0,
+    kGeneratorEuclidean,
+    kGeneratorRandom
 };
 
-static const char* const velocitySourceStrings[] = {
-    "Off", "Out 1", "Out 2", "Out 3", NULL
+// Values derived from one CV step, rebuilt only when the step is edited
+struct StepOutputs {
+    float volts[kMaxOuts];      // Output level per output
+    uint8_t note[kMaxOuts];     // MIDI note per output
+    uint8_t velocity[kMaxOuts]; // MIDI velocity when the output is the velocity source
 };
 
-// Parameter name strings (must be static to persist)
-static char seq1DivName[] = "Seq 1 Clock Div";
-static char seq1DirName[] = "Seq 1 Direction";
-static char seq1StepName[] = "Seq 1 Steps";
-static char seq1SplitName[] = "Seq 1 Split Point";
-static char seq1Sec1Name[] = "Seq 1 Sec1 Reps";
-static char seq1Sec2Name[] = "Seq 1 Sec2 Reps";
-static char seq2DivName[] = "Seq 2 Clock Div";
-static char seq2DirName[] = "Seq 2 Direction";
-static char seq2StepName[] = "Seq 2 Steps";
-static char seq2SplitName[] = "Seq 2 Split Point";
-static char seq2Sec1Name[] = "Seq 2 Sec1 Reps";
-static char seq2Sec2Name[] = "Seq 2 Sec2 Reps";
-static char seq3DivName[] = "Seq 3 Clock Div";
-static char seq3DirName[] = "Seq 3 Direction";
-static char seq3StepName[] = "Seq 3 Steps";
-static char seq3SplitName[] = "Seq 3 Split Point";
-static char seq3Sec1Name[] = "Seq 3 Sec1 Reps";
-static char seq3Sec2Name[] = "Seq 3 Sec2 Reps";
-
-// MIDI channel parameter names
-static char seq1Midi1Name[] = "Seq 1 MIDI 1";
-static char seq1Midi2Name[] = "Seq 1 MIDI 2";
-static char seq1Midi3Name[] = "Seq 1 MIDI 3";
-static char seq2Midi1Name[] = "Seq 2 MIDI 1";
-static char seq2Midi2Name[] = "Seq 2 MIDI 2";
-static char seq2Midi3Name[] = "Seq 2 MIDI 3";
-static char seq3Midi1Name[] = "Seq 3 MIDI 1";
-static char seq3Midi2Name[] = "Seq 3 MIDI 2";
-static char seq3Midi3Name[] = "Seq 3 MIDI 3";
-
-// MIDI velocity source parameter names
-static char seq1MidiVelocityName[] = "Seq 1 MIDI Vel";
-static char seq2MidiVelocityName[] = "Seq 2 MIDI Vel";
-static char seq3MidiVelocityName[] = "Seq 3 MIDI Vel";
-
-// Trigger sequencer MIDI channel
-static char triggerMidiChannelName[] = "Trigger MIDI Ch";
-static char triggerMasterVelocityName[] = "Trig Master Vel";
-static char triggerMasterAccentName[] = "Trig Accent Vel";
-
-// Gate track parameter names
-static char gate1OutName[] = "Gate 1 Out";
-static char gate1CCName[] = "Gate 1 CC";
-static char gate2OutName[] = "Gate 2 Out";
-static char gate2CCName[] = "Gate 2 CC";
-static char gate3OutName[] = "Gate 3 Out";
-static char gate3CCName[] = "Gate 3 CC";
-static char gate4OutName[] = "Gate 4 Out";
-static char gate4CCName[] = "Gate 4 CC";
-static char gate5OutName[] = "Gate 5 Out";
-static char gate5CCName[] = "Gate 5 CC";
-static char gate6OutName[] = "Gate 6 Out";
-static char gate6CCName[] = "Gate 6 CC";
-
-static char gate1RunName[] = "Gate 1 Run";
-static char gate1LenName[] = "Gate 1 Length";
-static char gate1DirName[] = "Gate 1 Direction";
-static char gate1DivName[] = "Gate 1 ClockDiv";
-static char gate1SwingName[] = "Gate 1 Swing";
-static char gate1SplitName[] = "Gate 1 Split";
-static char gate1Sec1Name[] = "Gate 1 Sec1 Reps";
-static char gate1Sec2Name[] = "Gate 1 Sec2 Reps";
-static char gate1FillName[] = "Gate 1 Fill Start";
-
-static char gate2RunName[] = "Gate 2 Run";
-static char gate2LenName[] = "Gate 2 Length";
-static char gate2DirName[] = "Gate 2 Direction";
-static char gate2DivName[] = "Gate 2 ClockDiv";
-static char gate2SwingName[] = "Gate 2 Swing";
-static char gate2SplitName[] = "Gate 2 Split";
-static char gate2Sec1Name[] = "Gate 2 Sec1 Reps";
-static char gate2Sec2Name[] = "Gate 2 Sec2 Reps";
-static char gate2FillName[] = "Gate 2 Fill Start";
-
-static char gate3RunName[] = "Gate 3 Run";
-static char gate3LenName[] = "Gate 3 Length";
-static char gate3DirName[] = "Gate 3 Direction";
-static char gate3DivName[] = "Gate 3 ClockDiv";
-static char gate3SwingName[] = "Gate 3 Swing";
-static char gate3SplitName[] = "Gate 3 Split";
-static char gate3Sec1Name[] = "Gate 3 Sec1 Reps";
-static char gate3Sec2Name[] = "Gate 3 Sec2 Reps";
-static char gate3FillName[] = "Gate 3 Fill Start";
-
-static char gate4RunName[] = "Gate 4 Run";
-static char gate4LenName[] = "Gate 4 Length";
-static char gate4DirName[] = "Gate 4 Direction";
-static char gate4DivName[] = "Gate 4 ClockDiv";
-static char gate4SwingName[] = "Gate 4 Swing";
-static char gate4SplitName[] = "Gate 4 Split";
-static char gate4Sec1Name[] = "Gate 4 Sec1 Reps";
-static char gate4Sec2Name[] = "Gate 4 Sec2 Reps";
-static char gate4FillName[] = "Gate 4 Fill Start";
-
-static char gate5RunName[] = "Gate 5 Run";
-static char gate5LenName[] = "Gate 5 Length";
-static char gate5DirName[] = "Gate 5 Direction";
-static char gate5DivName[] = "Gate 5 ClockDiv";
-static char gate5SwingName[] = "Gate 5 Swing";
-static char gate5SplitName[] = "Gate 5 Split";
-static char gate5Sec1Name[] = "Gate 5 Sec1 Reps";
-static char gate5Sec2Name[] = "Gate 5 Sec2 Reps";
-static char gate5FillName[] = "Gate 5 Fill Start";
-
-static char gate6RunName[] = "Gate 6 Run";
-static char gate6LenName[] = "Gate 6 Length";
-static char gate6DirName[] = "Gate 6 Direction";
-static char gate6DivName[] = "Gate 6 ClockDiv";
-static char gate6SwingName[] = "Gate 6 Swing";
-static char gate6SplitName[] = "Gate 6 Split";
-static char gate6Sec1Name[] = "Gate 6 Sec1 Reps";
-static char gate6Sec2Name[] = "Gate 6 Sec2 Reps";
-static char gate6FillName[] = "Gate 6 Fill Start";
-
-// Global parameter array
-static _NT_parameter parameters[kNumParameters];
-
-// Initialize parameter definitions
-static void initParameters() {
-    // Clock and Reset inputs
-    parameters[kParamClockIn].name = "Clock in";
-    parameters[kParamClockIn].min = 0;
-    parameters[kParamClockIn].max = 28;
-    parameters[kParamClockIn].def = 1;
-    parameters[kParamClockIn].unit = kNT_unitCvInput;
-    parameters[kParamClockIn].scaling = kNT_scalingNone;
-    
-    parameters[kParamResetIn].name = "Reset in";
-    parameters[kParamResetIn].min = 0;
-    parameters[kParamResetIn].max = 28;
-    parameters[kParamResetIn].def = 2;
-    parameters[kParamResetIn].unit = kNT_unitCvInput;
-    parameters[kParamResetIn].scaling = kNT_scalingNone;
-    
-    // CV Outputs (12 total)
-    const char* outNames[] = {
-        "Seq 1 Out 1", "Seq 1 Out 2", "Seq 1 Out 3",
-        "Seq 2 Out 1", "Seq 2 Out 2", "Seq 2 Out 3",
-        "Seq 3 Out 1", "Seq 3 Out 2", "Seq 3 Out 3",
-        "Seq 4 Out 1", "Seq 4 Out 2", "Seq 4 Out 3"
-    };
-    
-    for (int i = 0; i < 12; i++) {
-        int paramIdx = kParamSeq1Out1 + i;
-        parameters[paramIdx].name = outNames[i];
-        parameters[paramIdx].min = 0;
-        parameters[paramIdx].max = 28;
-        parameters[paramIdx].def = 0;
-        parameters[paramIdx].unit = kNT_unitCvOutput;
-        parameters[paramIdx].scaling = kNT_scalingNone;
-    }
-    
-    // MIDI channel parameters (9 total: 3 sequencers × 3 outputs each)
-    const char* midiNames[] = {
-        seq1Midi1Name, seq1Midi2Name, seq1Midi3Name,
-        seq2Midi1Name, seq2Midi2Name, seq2Midi3Name,
-        seq3Midi1Name, seq3Midi2Name, seq3Midi3Name
-    };
+// One pattern: its step data and the output data derived from it, all in DRAM. Each bank keeps
+// its own cache, so switching banks only moves a pointer.
+struct PatternBank {
+    int16_t* values;            // CV values [seq][step][out]
+    uint8_t* gates;             // Gate states [track][step]
+    uint32_t* glides;           // Bit per step that glides into its values, [seq]
+    StepOutputs* cache;         // [seq][step]
+    uint32_t* dirty;            // Bit per step whose cache entry needs rebuilding, [seq]
     
-    for (int i = 0; i < 9; i++) {
-        int paramIdx = kParamSeq1Midi1 + i;
-        parameters[paramIdx].name = midiNames[i];
-        parameters[paramIdx].min = 0;  // 0 = Off
-        parameters[paramIdx].max = 16; // 1-16 = MIDI channels
-        parameters[paramIdx].def = 0;  // Off by default
-        parameters[paramIdx].unit = kNT_unitNone;
-        parameters[paramIdx].scaling = kNT_scalingNone;
-    }
-    
-    // MIDI velocity source parameters (3 sequencers)
-    const char* velocityNames[] = {seq1MidiVelocityName, seq2MidiVelocityName, seq3MidiVelocityName};
-    
-    for (int seq = 0; seq < 3; seq++) {
-        int paramIdx = kParamSeq1MidiVelocity + seq;
-        parameters[paramIdx].name = velocityNames[seq];
-        parameters[paramIdx].min = 0;  // 0 = Off, 1 = Out 1, 2 = Out 2, 3 = Out 3
-        parameters[paramIdx].max = 3;
-        parameters[paramIdx].def = 0;  // Off by default
-        parameters[paramIdx].unit = kNT_unitEnum;
-        parameters[paramIdx].scaling = kNT_scalingNone;
-        parameters[paramIdx].enumStrings = velocitySourceStrings;
-    }
-    
-    // Trigger sequencer MIDI channel
-    parameters[kParamTriggerMidiChannel].name = triggerMidiChannelName;
-    parameters[kParamTriggerMidiChannel].min = 0;  // 0 = Off
-    parameters[kParamTriggerMidiChannel].max = 16; // 1-16 = MIDI channels
-    parameters[kParamTriggerMidiChannel].def = 0;  // Off by default
-    parameters[kParamTriggerMidiChannel].unit = kNT_unitNone;
-    parameters[kParamTriggerMidiChannel].scaling = kNT_scalingNone;
-    
-    // Trigger sequencer velocity parameters
-    parameters[kParamTriggerMasterVelocity].name = triggerMasterVelocityName;
-    parameters[kParamTriggerMasterVelocity].min = 0;
-    parameters[kParamTriggerMasterVelocity].max = 127;
-    parameters[kParamTriggerMasterVelocity].def = 100;
-    parameters[kParamTriggerMasterVelocity].unit = kNT_unitNone;
-    parameters[kParamTriggerMasterVelocity].scaling = kNT_scalingNone;
-    
-    parameters[kParamTriggerMasterAccent].name = triggerMasterAccentName;
-    parameters[kParamTriggerMasterAccent].min = 0;
-    parameters[kParamTriggerMasterAccent].max = 127;
-    parameters[kParamTriggerMasterAccent].def = 127;
-    parameters[kParamTriggerMasterAccent].unit = kNT_unitNone;
-    parameters[kParamTriggerMasterAccent].scaling = kNT_scalingNone;
-    
-    // Sequencer configuration parameters (seq 1-3 only now)
-    const char* divNames[] = {seq1DivName, seq2DivName, seq3DivName};
-    const char* dirNames[] = {seq1DirName, seq2DirName, seq3DirName};
-    const char* stepNames[] = {seq1StepName, seq2StepName, seq3StepName};
-    const char* splitNames[] = {seq1SplitName, seq2SplitName, seq3SplitName};
-    const char* sec1Names[] = {seq1Sec1Name, seq2Sec1Name, seq3Sec1Name};
-    const char* sec2Names[] = {seq1Sec2Name, seq2Sec2Name, seq3Sec2Name};
-    
-    for (int seq = 0; seq < 3; seq++) {
-        int divParam = kParamSeq1ClockDiv + (seq * 6);
-        int dirParam = kParamSeq1Direction + (seq * 6);
-        int stepParam = kParamSeq1StepCount + (seq * 6);
-        int splitParam = kParamSeq1SplitPoint + (seq * 6);
-        int sec1Param = kParamSeq1Section1Reps + (seq * 6);
-        int sec2Param = kParamSeq1Section2Reps + (seq * 6);
-        
-        // Clock Division parameter
-        parameters[divParam].name = divNames[seq];
-        parameters[divParam].min = 0;
-        parameters[divParam].max = 8;  // /16, /8, /4, /2, x1, x2, x4, x8, x16
-        parameters[divParam].def = 0;  // Default to /16 (lowest)
-        parameters[divParam].unit = kNT_unitEnum;
-        parameters[divParam].scaling = kNT_scalingNone;
-        parameters[divParam].enumStrings = divisionStrings;
-        
-        // Direction parameter
-        parameters[dirParam].name = dirNames[seq];
-        parameters[dirParam].min = 0;
-        parameters[dirParam].max = 2;  // Forward, Backward, Pingpong
-        parameters[dirParam].def = 0;  // Forward
-        parameters[dirParam].unit = kNT_unitEnum;
-        parameters[dirParam].scaling = kNT_scalingNone;
-        parameters[dirParam].enumStrings = directionStrings;
-        
-        // Step Count parameter
-        parameters[stepParam].name = stepNames[seq];
-        parameters[stepParam].min = 1;
-        parameters[stepParam].max = 32;
-        parameters[stepParam].def = 16;  // Default to 16 steps
-        parameters[stepParam].unit = kNT_unitNone;
-        parameters[stepParam].scaling = kNT_scalingNone;
-        
-        // Split Point parameter
-        parameters[splitParam].name = splitNames[seq];
-        parameters[splitParam].min = 1;
-        parameters[splitParam].max = 31;
-        parameters[splitParam].def = 8;  // Default to middle of 16 steps
-        parameters[splitParam].unit = kNT_unitNone;
-        parameters[splitParam].scaling = kNT_scalingNone;
-        
-        // Section 1 Repeats parameter
-        parameters[sec1Param].name = sec1Names[seq];
-        parameters[sec1Param].min = 1;
-        parameters[sec1Param].max = 99;
-        parameters[sec1Param].def = 1;
-        parameters[sec1Param].unit = kNT_unitNone;
-        parameters[sec1Param].scaling = kNT_scalingNone;
-        
-        // Section 2 Repeats parameter
-        parameters[sec2Param].name = sec2Names[seq];
-        parameters[sec2Param].min = 1;
-        parameters[sec2Param].max = 99;
-        parameters[sec2Param].def = 1;
-        parameters[sec2Param].unit = kNT_unitNone;
-        parameters[sec2Param].scaling = kNT_scalingNone;
-    }
-    
-    // Gate outputs and MIDI CC parameters (6 tracks, 2 parameters each)
-    const char* gateOutNames[] = {gate1OutName, gate2OutName, gate3OutName, gate4OutName, gate5OutName, gate6OutName};
-    const char* gateCCNames[] = {gate1CCName, gate2CCName, gate3CCName, gate4CCName, gate5CCName, gate6CCName};
-    
-    for (int track = 0; track < 6; track++) {
-        int outParam = kParamGate1Out + (track * 2);
-        int ccParam = kParamGate1CC + (track * 2);
-        
-        parameters[outParam].name = gateOutNames[track];
-        parameters[outParam].min = 0;
-        parameters[outParam].max = 28;
-        parameters[outParam].def = 0;
-        parameters[outParam].unit = kNT_unitCvOutput;
-        parameters[outParam].scaling = kNT_scalingNone;
-        
-        parameters[ccParam].name = gateCCNames[track];
-        parameters[ccParam].min = 0;  // 0-127
-        parameters[ccParam].max = 127;
-        parameters[ccParam].def = 0;  // Default to CC 0 for all
-        parameters[ccParam].unit = kNT_unitNone;
-        parameters[ccParam].scaling = kNT_scalingNone;
-    }
-    
-    // Gate Track parameters (6 tracks, 10 parameters each - minus the Out param which is now separate)
-    const char* gateRunNames[] = {gate1RunName, gate2RunName, gate3RunName, gate4RunName, gate5RunName, gate6RunName};
-    const char* gateLenNames[] = {gate1LenName, gate2LenName, gate3LenName, gate4LenName, gate5LenName, gate6LenName};
-    const char* gateDirNames[] = {gate1DirName, gate2DirName, gate3DirName, gate4DirName, gate5DirName, gate6DirName};
-    const char* gateDivNames[] = {gate1DivName, gate2DivName, gate3DivName, gate4DivName, gate5DivName, gate6DivName};
-    const char* gateSwingNames[] = {gate1SwingName, gate2SwingName, gate3SwingName, gate4SwingName, gate5SwingName, gate6SwingName};
-    const char* gateSplitNames[] = {gate1SplitName, gate2SplitName, gate3SplitName, gate4SplitName, gate5SplitName, gate6SplitName};
-    const char* gateSec1Names[] = {gate1Sec1Name, gate2Sec1Name, gate3Sec1Name, gate4Sec1Name, gate5Sec1Name, gate6Sec1Name};
-    const char* gateSec2Names[] = {gate1Sec2Name, gate2Sec2Name, gate3Sec2Name, gate4Sec2Name, gate5Sec2Name, gate6Sec2Name};
-    const char* gateFillNames[] = {gate1FillName, gate2FillName, gate3FillName, gate4FillName, gate5FillName, gate6FillName};
-    
-    for (int track = 0; track < 6; track++) {
-        int runParam = kParamGate1Run + (track * 9);   // Now 9 params per track instead of 10
-        int lenParam = kParamGate1Length + (track * 9);
-        int dirParam = kParamGate1Direction + (track * 9);
-        int divParam = kParamGate1ClockDiv + (track * 9);
-        int swingParam = kParamGate1Swing + (track * 9);
-        int splitParam = kParamGate1SplitPoint + (track * 9);
-        int sec1Param = kParamGate1Section1Reps + (track * 9);
-        int sec2Param = kParamGate1Section2Reps + (track * 9);
-        int fillParam = kParamGate1FillStart + (track * 9);
-        
-        parameters[runParam].name = gateRunNames[track];
-        parameters[runParam].min = 0;
-        parameters[runParam].max = 1;
-        parameters[runParam].def = 0;  // Default to stopped
-        parameters[runParam].unit = kNT_unitNone;
-        parameters[runParam].scaling = kNT_scalingNone;
-        
-        parameters[lenParam].name = gateLenNames[track];
-        parameters[lenParam].min = 1;
-        parameters[lenParam].max = 32;
-        parameters[lenParam].def = 16;  // Default to 16 steps
-        parameters[lenParam].unit = kNT_unitNone;
-        parameters[lenParam].scaling = kNT_scalingNone;
-        
-        parameters[dirParam].name = gateDirNames[track];
-        parameters[dirParam].min = 0;
-        parameters[dirParam].max = 2;
-        parameters[dirParam].def = 0;
-        parameters[dirParam].unit = kNT_unitEnum;
-        parameters[dirParam].scaling = kNT_scalingNone;
-        parameters[dirParam].enumStrings = directionStrings;
-        
-        parameters[divParam].name = gateDivNames[track];
-        parameters[divParam].min = 0;
-        parameters[divParam].max = 8;
-        parameters[divParam].def = 0;  // Default to /16
-        parameters[divParam].unit = kNT_unitEnum;
-        parameters[divParam].scaling = kNT_scalingNone;
-        parameters[divParam].enumStrings = divisionStrings;
-        
-        parameters[swingParam].name = gateSwingNames[track];
-        parameters[swingParam].min = 0;
-        parameters[swingParam].max = 100;
-        parameters[swingParam].def = 0;
-        parameters[swingParam].unit = kNT_unitNone;
-        parameters[swingParam].scaling = kNT_scalingNone;
-        
-        parameters[splitParam].name = gateSplitNames[track];
-        parameters[splitParam].min = 0;
-        parameters[splitParam].max = 31;
-        parameters[splitParam].def = 0;
-        parameters[splitParam].unit = kNT_unitNone;
-        parameters[splitParam].scaling = kNT_scalingNone;
-        
-        parameters[sec1Param].name = gateSec1Names[track];
-        parameters[sec1Param].min = 1;
-        parameters[sec1Param].max = 99;
-        parameters[sec1Param].def = 1;
-        parameters[sec1Param].unit = kNT_unitNone;
-        parameters[sec1Param].scaling = kNT_scalingNone;
-        
-        parameters[sec2Param].name = gateSec2Names[track];
-        parameters[sec2Param].min = 1;
-        parameters[sec2Param].max = 99;
-        parameters[sec2Param].def = 1;
-        parameters[sec2Param].unit = kNT_unitNone;
-        parameters[sec2Param].scaling = kNT_scalingNone;
+    void invalidateStep(int seq, int step) {
+        dirty[seq] |= (1u << step);
+    }
+};
+
+// Transition flags
+enum {
+    kTransBoundary = 1,     // Last step of a section: repeat it or move on
+    kTransSection2 = 2,     // The boundary belongs to section 2
+    kTransFill = 4,         // Fill jumps to section 2 here on the last section 1 repeat
+    kTransBounce = 8,       // Pingpong turns around here
+    kTransWrap = 16         // The whole pattern starts again after this step
+};
+
+// Boundaries a track crossed on one step, as returned by StepTable::advance
+enum {
+    kCrossSection = 1,      // Left the last step of a section, or turned around in pingpong
+    kCrossLoop = 2,         // Came back to the start of the whole pattern
+    kCrossFill = 4          // Left section 1 early on a fill
+};
+
+// Position of a track in its step order
+struct StepCursor {
+    int step;                   // Current step (0-31)
+    bool forward;               // Direction state for pingpong mode
+    bool inSection2;            // Which section is currently playing
+    int sec1Counter;            // Section 1 repeat count
+    int sec2Counter;            // Section 2 repeat count
+};
+
+// Where one step goes on the next clock
+struct StepTransition {
+    uint8_t next;           // Following step, or the section start when the section repeats
+    uint8_t exit;           // Step reached when the section's repeats are used up or a fill fires
+    uint8_t flags;
+};
+
+// Precomputed step order for one track, rebuilt only when its direction/length/section params change
+struct StepTable {
+    StepTransition* entry;  // [phase * maxSteps + step], phase 0 = moving forward, 1 = pingpong moving back
+    uint8_t maxSteps;
+    uint8_t reps[2];        // Section 1 and 2 repeats
+    uint8_t section2Start;  // First step of section 2 (maxSteps when sections are off)
+
+    void init(StepTransition* storage, int steps) {
+        entry = storage;
+        maxSteps = (uint8_t)steps;
+    }
+
+    void build(int direction, int length, int split, int sec1Reps, int sec2Reps, int fillStart) {
+        if (length > maxSteps) length = maxSteps;
+        bool sections = direction != 2 && split > 0 && split < length;
+        reps[0] = (uint8_t)sec1Reps;
+        reps[1] = (uint8_t)sec2Reps;
+        section2Start = (uint8_t)(sections ? split : maxSteps);
+        StepTransition* forwardRow = entry;
+        StepTransition* backRow = entry + maxSteps;
+
+        for (int step = 0; step < length; step++) {
+            StepTransition& fwd = forwardRow[step];
+            StepTransition& back = backRow[step];
+            fwd.flags = 0;
+            back.flags = 0;
+
+            if (direction == 2) {
+                // Pingpong turns on the end steps without playing them twice
+                fwd.next = (uint8_t)(step + 1);
+                if (step == length - 1) {
+                    fwd.next = (uint8_t)(length > 1 ? length - 2 : 0);
+                    fwd.flags = kTransBounce;
+                }
+                back.next = (uint8_t)(step - 1);
+                if (step == 0) {
+                    back.next = (uint8_t)(length > 1 ? 1 : 0);
+                    back.flags = kTransBounce | kTransWrap;
+                }
+            } else if (!sections) {
+                fwd.next = (uint8_t)(direction == 0 ? (step + 1) % length : (step + length - 1) % length);
+                if (step == (direction == 0 ? length - 1 : 0)) fwd.flags = kTransWrap;
+            } else if (direction == 0) {
+                fwd.next = (uint8_t)(step + 1);
+                if (step == split - 1) {
+                    fwd.next = 0;
+                    fwd.exit = (uint8_t)split;
+                    fwd.flags = kTransBoundary;
+                } else if (step == length - 1) {
+                    fwd.next = (uint8_t)split;
+                    fwd.exit = 0;
+                    fwd.flags = kTransBoundary | kTransSection2;
+                }
+            } else {
+                fwd.next = (uint8_t)(step - 1);
+                if (step == 0) {
+                    fwd.next = (uint8_t)(split - 1);
+                    fwd.exit = (uint8_t)(length - 1);
+                    fwd.flags = kTransBoundary;
+                } else if (step == split) {
+                    fwd.next = (uint8_t)(length - 1);
+                    fwd.exit = (uint8_t)(split - 1);
+                    fwd.flags = kTransBoundary | kTransSection2;
+                }
+            }
+            if (direction != 2) back = fwd;
+        }
+
+        // Fill replaces the rest of section 1 on its last repeat (forward only)
+        if (sections && direction == 0 && fillStart > 0 && fillStart < split && sec1Reps > 1) {
+            StepTransition& fill = forwardRow[fillStart - 1];
+            fill.exit = (uint8_t)split;
+            fill.flags = kTransFill;
+        }
+
+        // Steps past the end (after the length shrinks) move on as if from the last step
+        for (int step = length; step < maxSteps; step++) {
+            forwardRow[step] = forwardRow[length - 1];
+            backRow[step] = backRow[length - 1];
+        }
+    }
+
+    // Move a track cursor one step along the table. Returns the kCross flags of the boundaries it crossed.
+    int advance(StepCursor& track) const {
+        const StepTransition& t = entry[(track.forward ? 0 : maxSteps) + track.step];
+        int next = t.next;
+        int crossed = 0;
+
+        if (t.flags & kTransFill) {
+            if (track.sec1Counter == reps[0] - 1) {
+                track.sec1Counter = 0;
+                next = t.exit;
+                crossed = kCrossSection | kCrossFill;
+            }
+        } else if (t.flags & kTransBoundary) {
+            int section = (t.flags & kTransSection2) ? 1 : 0;
+            int& counter = section ? track.sec2Counter : track.sec1Counter;
+            crossed = kCrossSection;
+            if (++counter >= reps[section]) {
+                counter = 0;
+                next = t.exit;
+                if (section) crossed |= kCrossLoop;  // Section 2 hands back to section 1
+            }
+        }
+
+        if (t.flags & kTransBounce) {
+            track.forward = !track.forward;
+            crossed |= kCrossSection;
+        }
+        if (t.flags & kTransWrap) crossed |= kCrossSection | kCrossLoop;
+        track.step = next;
+        track.inSection2 = next >= section2Start;
+        return crossed;
+    }
+};
+
+
+// Ticks each track plans ahead of its cursor (a power of two)
+static const int kPlanSteps = 8;
+
+// Flags of a planned step, next to the kCross flags of the move into it
+enum {
+    kPlanForward = 8,       // Pingpong is moving forward
+    kPlanSection2 = 16      // The step is in section 2
+};
+
+// One step of a track's plan: the cursor after a tick
+struct PlannedStep {
+    uint8_t step;
+    uint8_t flags;
+    uint8_t sec1Counter;
+    uint8_t sec2Counter;
+};
+
+// The steps a track's next kPlanSteps ticks move to. Each tick drops the step it reached and
+// plans one more past the end, so the boundaries and fills ahead are known without walking the
+// step table again.
+struct TrackPlan {
+    PlannedStep steps[kPlanSteps];  // Ring; steps[head] is the step of the next tick
+    uint8_t head;
+    uint16_t generation;            // Step table generation the plan was made from
+    
+    // The step 'ticks' ticks ahead, 1 = the next tick
+    const PlannedStep& ahead(int ticks) const {
+        return steps[(head + ticks - 1) & (kPlanSteps - 1)];
+    }
+    
+    // Ticks until the first planned move that crosses one of 'cross', or 0 beyond the plan
+    int ticksUntil(int cross) const {
+        for (int ticks = 1; ticks <= kPlanSteps; ticks++) {
+            if (ahead(ticks).flags & cross) return ticks;
+        }
+        return 0;
+    }
+    
+    static PlannedStep planned(const StepCursor& c, int crossed) {
+        PlannedStep p;
+        p.step = (uint8_t)c.step;
+        p.flags = (uint8_t)(crossed | (c.forward ? kPlanForward : 0) | (c.inSection2 ? kPlanSection2 : 0));
+        p.sec1Counter = (uint8_t)c.sec1Counter;
+        p.sec2Counter = (uint8_t)c.sec2Counter;
+        return p;
+    }
+    
+    static bool matches(const PlannedStep& p, const StepCursor& c) {
+        return p.step == c.step && ((p.flags & kPlanForward) != 0) == c.forward &&
+               p.sec1Counter == c.sec1Counter && p.sec2Counter == c.sec2Counter;
+    }
+    
+    // Plan the steps after 'from'
+    void build(const StepTable& table, const StepCursor& from, uint16_t tableGeneration) {
+        StepCursor c = from;
+        for (int i = 0; i < kPlanSteps; i++) {
+            int crossed = table.advance(c);
+            steps[i] = planned(c, crossed);
+        }
+        head = 0;
+        generation = tableGeneration;
+    }
+    
+    // After a tick moved the cursor to 'now': drop the planned step and plan one more, or plan
+    // again if the tick went somewhere else
+    void follow(const StepTable& table, const StepCursor& now, uint16_t tableGeneration) {
+        if (generation != tableGeneration || !matches(steps[head], now)) {
+            build(table, now, tableGeneration);
+            return;
+        }
+        const PlannedStep& last = steps[(head + kPlanSteps - 1) & (kPlanSteps - 1)];
+        StepCursor c;
+        c.step = last.step;
+        c.forward = (last.flags & kPlanForward) != 0;
+        c.inSection2 = (last.flags & kPlanSection2) != 0;
+        c.sec1Counter = last.sec1Counter;
+        c.sec2Counter = last.sec2Counter;
+        int crossed = table.advance(c);
+        steps[head] = planned(c, crossed);
+        head = (uint8_t)((head + 1) & (kPlanSteps - 1));
+    }
+};
+
+// Playback state and resolved parameters of one clock track. parameterChanged snapshots the
+// parameters here so the audio path never indexes self->v.
+struct TrackState : StepCursor {
+    // Steps the next ticks move to, and the step table generation they were planned from
+    TrackPlan plan;
+    uint16_t tableGeneration;   // Bumped on every step table rebuild
+    
+    // Clock
+    int divCounter;             // Phase counter for clock divisions
+    int subTickIndex;           // Index of the next multiplier sub-tick after the edge
+    int subTickCount;           // Ticks per edge for the multiplier in use
+    uint32_t subTickBase;       // Edge time the multiplier sub-ticks are spaced from
+    int swingCounter;           // Tick parity for swing timing (0 after an even tick)
+    
+    // Trigger (gate tracks)
+    bool gateHigh;              // Whether the trigger pulse is currently high
+    uint32_t pulseSamples;      // Trigger pulse length in samples, from the Gate Len parameter
+    
+    // Ratchet (gate tracks): sub-triggers spread evenly over the step that started them
+    uint8_t ratchetIndex;       // Next sub-trigger, 1 to ratchetCount - 1
+    uint8_t ratchetCount;
+    uint8_t ratchetState;       // Step state the sub-triggers play as
+    uint32_t ratchetBase;       // Time of the step's first trigger
+    uint32_t ratchetPeriod;     // Step period the triggers are spread over
+    uint32_t ratchetPulse;      // Pulse length, kept shorter than the trigger spacing
+    
+    // Resolved parameters
+    bool running;               // Gate tracks follow their Run parameter; CV sequencers always run
+    uint8_t division;           // Clock division index (0-8: /16 ... x1 ... x16)
+    uint8_t swing;              // 0-99%
+    uint8_t outBus[kMaxOuts];   // 0 = none, 1-28 = bus 0-27; gate tracks use outBus[0]
+    uint8_t midiChannel[kMaxOuts]; // CV outputs: 0 = off, 1-16
+    uint8_t velocitySource;     // CV: 0 = fixed, 1-3 = output used as velocity
+    uint32_t noteSamples;       // CV: MIDI note length in samples, from the Note Len parameter
+    uint32_t slewSamples[kMaxOuts]; // CV: glide time per output, from the Slew parameters (0 = none)
+    float slewRatio[kMaxOuts];  // CV: per frame gap ratio of an exponential glide over slewSamples
+    uint8_t glideShape;         // CV: kRampLinear or kRampExponential
+    uint8_t scale;              // CV: quantiser scale (kScaleOff = unquantised)
+    uint8_t root;               // CV: scale root, 0 = C
+    uint16_t scaleMask;         // CV: notes of the Custom scale, bit n = n semitones above the root
+    
+    // Step table parameters, and the length, split and fill start in play after modulation
+    uint8_t direction;
+    uint8_t baseLength;
+    uint8_t baseSplit;
+    uint8_t baseFill;           // Gate tracks only; 0 on CV sequencers
+    uint8_t reps[2];
+    uint8_t length;
+    uint8_t split;
+    uint8_t fillStart;
+    int8_t mod[kNumModTargets]; // Offsets from the modulation inputs
+    
+    // Generator (gate tracks) and the steps it plays over the track length, bit per step
+    uint8_t generator;
+    uint8_t hits;               // Euclidean: hits spread over the length
+    uint8_t rotate;             // Euclidean: steps the hits are moved later by
+    uint8_t density;            // Random: chance of each step playing, 0-100%
+    uint16_t seed;              // Random: pattern choice
+    uint32_t generatedMask;
+    uint8_t cc;                 // Gate tracks: MIDI CC number
+    
+    // MIDI notes sounding per CV output, and the status byte (channel) each was sent with
+    uint8_t heldNote[kMaxOuts];
+    uint8_t heldStatus[kMaxOuts];
+    
+    void resetCursor() {
+        step = 0;
+        forward = true;
+        inSection2 = false;
+        sec1Counter = 0;
+        sec2Counter = 0;
+        swingCounter = 0;
+    }
+};
+
+// Parameters of each CV sequencer, in page order
+enum {
+    kSeqClockDiv = 0,
+    kSeqDirection,
+    kSeqStepCount,
+    kSeqSplitPoint,
+    kSeqSection1Reps,
+    kSeqSection2Reps,
+    kNumSeqParams
+};
+
+// Parameters of each gate track, in page order (Out, CC and Gate Len live in their own blocks)
+enum {
+    kGateRun = 0,
+    kGateLength,
+    kGateDirection,
+    kGateClockDiv,
+    kGateSwing,
+    kGateSplitPoint,
+    kGateSection1Reps,
+    kGateSection2Reps,
+    kGateFillStart,
+    kNumGateParams
+};
+
+// Page entries are 8-bit parameter indices
+static const int kMaxParameters = 255;
+
+// Parameter indices for an instance's dimensions. The blocks keep the order of the original
+// hand-written table, so presets made with the default specifications load unchanged.
+struct ParamLayout {
+    int clockIn;
+    int resetIn;
+    int cvOut;              // [seq * outs + out]
+    int cvMidi;             // MIDI channel, [seq * outs + out]
+    int cvVelocity;         // MIDI velocity source, [seq]
+    int triggerMidiChannel; // Shared by all gate tracks
+    int triggerVelocity;
+    int triggerAccent;
+    int cvTrack;            // kNumSeqParams per sequencer
+    int gateOutCC;          // Out then CC, per gate track
+    int gateTrack;          // kNumGateParams per gate track
+    int gatePulseLen;       // [track]
+    int playheadRate;       // Display page
+    int bank;               // Patterns page: the bank to play, and where a switch takes effect
+    int bankSwitch;
+    int cvNoteLen;          // MIDI note length, [seq]
+    int clockSource;        // Inputs page
+    int tempo;              // Internal clock, tenths of a BPM
+    int clockOut;
+    int cvSlew;             // Glide time, [seq * outs + out]
+    int cvGlideShape;       // [seq]
+    int cvScale;            // Quantiser, [seq]
+    int cvRoot;             // [seq]
+    int cvScaleMask;        // Custom scale notes, [seq]
+    int modIn;              // Modulation page: input, target and track per modulation input
+    int modTarget;
+    int modTrack;
+    int gateGenerator;      // Generator per gate track: mode, hits, rotation, density, seed, bake
+    int gateHits;
+    int gateRotate;
+    int gateDensity;
+    int gateSeed;
+    int gateBake;
+    int record;             // Record page: on/off, then the CV input and its target, the gate input and its track
+    int recCvIn;
+    int recSeq;
+    int recOut;
+    int recGateIn;
+    int recTrack;
+    int clockLink;          // Inputs page
+    int numParameters;
+    int numPages;           // Inputs, Outs and Params per sequencer, Gate Outs, one page per gate track, Patterns,
+                            // Modulation, Record, Display
+    
+    void build(const VSeqDims& dims) {
+        clockIn = 0;
+        resetIn = 1;
+        cvOut = 2;
+        cvMidi = cvOut + dims.cvSlots();
+        cvVelocity = cvMidi + dims.cvSlots();
+        triggerMidiChannel = cvVelocity + dims.cvSeqs;
+        triggerVelocity = triggerMidiChannel + 1;
+        triggerAccent = triggerMidiChannel + 2;
+        cvTrack = triggerMidiChannel + 3;
+        gateOutCC = cvTrack + (dims.cvSeqs * kNumSeqParams);
+        gateTrack = gateOutCC + (dims.gateTracks * 2);
+        gatePulseLen = gateTrack + (dims.gateTracks * kNumGateParams);
+        playheadRate = gatePulseLen + dims.gateTracks;
+        bank = playheadRate + 1;
+        bankSwitch = bank + 1;
+        cvNoteLen = bankSwitch + 1;
+        clockSource = cvNoteLen + dims.cvSeqs;
+        tempo = clockSource + 1;
+        clockOut = tempo + 1;
+        cvSlew = clockOut + 1;
+        cvGlideShape = cvSlew + dims.cvSlots();
+        cvScale = cvGlideShape + dims.cvSeqs;
+        cvRoot = cvScale + dims.cvSeqs;
+        cvScaleMask = cvRoot + dims.cvSeqs;
+        modIn = cvScaleMask + dims.cvSeqs;
+        modTarget = modIn + kNumModInputs;
+        modTrack = modTarget + kNumModInputs;
+        gateGenerator = modTrack + kNumModInputs;
+        gateHits = gateGenerator + dims.gateTracks;
+        gateRotate = gateHits + dims.gateTracks;
+        gateDensity = gateRotate + dims.gateTracks;
+        gateSeed = gateDensity + dims.gateTracks;
+        gateBake = gateSeed + dims.gateTracks;
+        record = gateBake + dims.gateTracks;
+        recCvIn = record + 1;
+        recSeq = record + 2;
+        recOut = record + 3;
+        recGateIn = record + 4;
+        recTrack = record + 5;
+        clockLink = record + 6;
+        numParameters = clockLink + 1;
+        numPages = 6 + (2 * dims.cvSeqs) + dims.gateTracks;
+    }
+    
+    int seqParam(int seq, int param) const { return cvTrack + (seq * kNumSeqParams) + param; }
+    int gateParam(int track, int param) const { return gateTrack + (track * kNumGateParams) + param; }
+    int gateOut(int track) const { return gateOutCC + (track * 2); }
+    int gateCC(int track) const { return gateOutCC + (track * 2) + 1; }
+};
+
+// String arrays for enum parameters
+static const char* const divisionStrings[] = {
+    "/16", "/8", "/4", "/2", "x1", "x2", "x4", "x8", "x16", NULL
+};
+
+// Clock edges per tick, and ticks per clock edge, for each division setting
+static const uint8_t clockDivisors[] = { 16, 8, 4, 2, 1, 1, 1, 1, 1 };
+static const uint8_t clockMultipliers[] = { 1, 1, 1, 1, 1, 2, 4, 8, 16 };
+static const int kClockDivX1 = 4;
+
+static const char* const directionStrings[] = {
+    "Forward", "Backward", "Pingpong", NULL
+};
+
+// What drives the clock edges
+enum {
+    kClockSourceCv = 0,
+    kClockSourceMidi,
+    kClockSourceInternal
+};
+
+static const char* const clockSourceStrings[] = {
+    "CV", "MIDI", "Internal", NULL
+};
+
+// Clock sharing between instances: a lead publishes its clock, followers play it
+enum {
+    kClockLinkOff = 0,
+    kClockLinkLead,
+    kClockLinkFollow
+};
+
+static const char* const clockLinkStrings[] = {
+    "Off", "Lead", "Follow", NULL
+};
+
+// Clock output pulse length
+static const int kClockOutMs = 5;
+
+static const char* const glideShapeStrings[] = {
+    "Linear", "Exponential", NULL
+};
+
+// Longest glide, in ms
+static const int kMaxSlewMs = 5000;
+
+// Quantiser scales. Off leaves the outputs unquantised, although MIDI notes still round to
+// the nearest semitone.
+enum {
+    kScaleOff = 0,
+    kScaleChromatic,
+    kScaleMajor,
+    kScaleCustom = 14
+};
+
+static const char* const scaleStrings[] = {
+    "Off", "Chromatic", "Major", "Minor", "Dorian", "Phrygian", "Lydian", "Mixolydian",
+    "Locrian", "Harm Minor", "Major Pent", "Minor Pent", "Blues", "Whole Tone", "Custom", NULL
+};
+
+// Notes of each scale as a bit per semitone above the root (Off and Custom are not used)
+static const uint16_t scaleMasks[] = {
+    0xFFF, 0xFFF, 0xAB5, 0x5AD, 0x6AD, 0x5AB, 0xAD5, 0x6B5,
+    0x56B, 0x9AD, 0x295, 0x4A9, 0x4E9, 0x555, 0xFFF
+};
+
+static const char* const generatorStrings[] = {
+    "Off", "Euclidean", "Random", NULL
+};
+
+static const char* const offOnStrings[] = {
+    "Off", "On", NULL
+};
+
+static const char* const bakeStrings[] = {
+    "-", "Bake", NULL
+};
+
+static const char* const modTargetStrings[] = {
+    "Length", "Split", "Transpose", "Fill Start", NULL
+};
+
+static const char* const rootStrings[] = {
+    "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B", NULL
+};
+
+static const char* const velocitySourceStrings[] = {
+    "Off", "Out 1", "Out 2", "Out 3", NULL
+};
+
+// Most playhead redraws per second, for each Playhead Rate setting (0 = every change)
+static const char* const playheadRateStrings[] = {
+    "Unlimited", "30 Hz", "15 Hz", "5 Hz", NULL
+};
+static const uint8_t playheadRates[] = { 0, 30, 15, 5 };
+
+// Boundary of the lead track a pattern bank switch waits for
+enum {
+    kBankSwitchSection = 0,
+    kBankSwitchLoop
+};
+
+static const char* const bankSwitchStrings[] = {
+    "Section End", "Loop End", NULL
+};
+
+// Parameter definitions, names and pages of one instance, generated by build(). They live in
+// the instance's DRAM, since their number depends on its specifications. The names are sized
+// for any int in their numbers, so none can be cut short.
+struct ParamTables {
+    typedef char ParamName[32];
+    typedef char PageName[24];
+    typedef char TrackName[20];
+    
+    _NT_parameter* parameters;
+    ParamName* names;
+    uint8_t* pageParams;        // Every parameter sits on exactly one page
+    PageName* pageNames;
+    _NT_parameterPage* pageArray;
+    _NT_parameterPages pages;
+    TrackName* trackNames;      // Enum strings of the Mod Track parameters
+    const char** trackStrings;
+    const char** seqStrings;    // Rec Seq: the CV sequencers, or "None" without any
+    const char** gateStrings;   // Rec Track: the gate tracks, or "None" without any
+    
+    int numPages;
+    int numPageParams;
+    
+    void carve(MemoryCarver& mem, const VSeqDims& dims, const ParamLayout& P) {
+        parameters = mem.take<_NT_parameter>(P.numParameters);
+        names = mem.take<ParamName>(P.numParameters);
+        pageParams = mem.take<uint8_t>(P.numParameters);
+        pageNames = mem.take<PageName>(P.numPages);
+        pageArray = mem.take<_NT_parameterPage>(P.numPages);
+        trackNames = mem.take<TrackName>(dims.tracks());
+        trackStrings = mem.take<const char*>(dims.tracks() + 1);
+        seqStrings = mem.take<const char*>((dims.cvSeqs > 0 ? dims.cvSeqs : 1) + 1);
+        gateStrings = mem.take<const char*>((dims.gateTracks > 0 ? dims.gateTracks : 1) + 1);
+    }
+    
+    void define(int index, int min, int max, int def, int unit, const char* const* enumStrings = NULL) {
+        _NT_parameter& p = parameters[index];
+        p.name = names[index];
+        p.min = (int16_t)min;
+        p.max = (int16_t)max;
+        p.def = (int16_t)def;
+        p.unit = (uint8_t)unit;
+        p.scaling = kNT_scalingNone;
+        p.enumStrings = enumStrings;
+    }
+    
+    // Start a page; the parameters added until the next page belong to it
+    void beginPage(const char* name) {
+        _NT_parameterPage& page = pageArray[numPages];
+        snprintf(pageNames[numPages], sizeof(pageNames[0]), "%s", name);
+        page.name = pageNames[numPages];
+        page.numParams = 0;
+        page.params = pageParams + numPageParams;
+        numPages++;
+    }
+    
+    void addToPage(int index) {
+        pageParams[numPageParams++] = (uint8_t)index;
+        pageArray[numPages - 1].numParams++;
+    }
+    
+    // Enum strings for 'count' clock tracks from 'first', or a lone "None" when there are none
+    void fillRangeStrings(const char** strings, int first, int count) {
+        for (int i = 0; i < count; i++) {
+            strings[i] = trackNames[first + i];
+        }
+        if (count == 0) strings[count++] = "None";
+        strings[count] = NULL;
+    }
+    
+    void build(const VSeqDims& dims, const ParamLayout& P) {
+        int defaultSteps = (dims.maxSteps < 16) ? dims.maxSteps : 16;
+        char title[sizeof(PageName)];
+        numPages = 0;
+        numPageParams = 0;
+        
+        // Clock and Reset inputs
+        beginPage("Inputs");
+        snprintf(names[P.clockIn], sizeof(names[0]), "Clock in");
+        define(P.clockIn, 0, 28, 1, kNT_unitCvInput);
+        addToPage(P.clockIn);
+        snprintf(names[P.resetIn], sizeof(names[0]), "Reset in");
+        define(P.resetIn, 0, 28, 2, kNT_unitCvInput);
+        addToPage(P.resetIn);
+        snprintf(names[P.clockSource], sizeof(names[0]), "Clock Source");
+        define(P.clockSource, 0, 2, kClockSourceCv, kNT_unitEnum, clockSourceStrings);
+        addToPage(P.clockSource);
+        snprintf(names[P.tempo], sizeof(names[0]), "Tempo");
+        define(P.tempo, 200, 3000, 1200, kNT_unitBPM);  // 20.0-300.0 BPM
+        parameters[P.tempo].scaling = kNT_scaling10;
+        addToPage(P.tempo);
+        snprintf(names[P.clockOut], sizeof(names[0]), "Clock Out");
+        define(P.clockOut, 0, 28, 0, kNT_unitCvOutput);
+        addToPage(P.clockOut);
+        snprintf(names[P.clockLink], sizeof(names[0]), "Clock Link");
+        define(P.clockLink, 0, 2, kClockLinkOff, kNT_unitEnum, clockLinkStrings);
+        addToPage(P.clockLink);
+        
+        // CV outputs, their MIDI channels (0 = off, 1-16) and the MIDI velocity source
+        for (int seq = 0; seq < dims.cvSeqs; seq++) {
+            snprintf(title, sizeof(title), "Seq %d Outs", seq + 1);
+            beginPage(title);
+            for (int out = 0; out < dims.outs; out++) {
+                int outParam = P.cvOut + (seq * dims.outs) + out;
+                int midiParam = P.cvMidi + (seq * dims.outs) + out;
+                snprintf(names[outParam], sizeof(names[0]), "Seq %d Out %d", seq + 1, out + 1);
+                define(outParam, 0, 28, 0, kNT_unitCvOutput);
+                addToPage(outParam);
+                snprintf(names[midiParam], sizeof(names[0]), "Seq %d MIDI %d", seq + 1, out + 1);
+                define(midiParam, 0, 16, 0, kNT_unitNone);
+                addToPage(midiParam);
+            }
+            int velParam = P.cvVelocity + seq;
+            snprintf(names[velParam], sizeof(names[0]), "Seq %d MIDI Vel", seq + 1);
+            define(velParam, 0, dims.outs, 0, kNT_unitEnum, velocitySourceStrings);
+            addToPage(velParam);
+            int noteLenParam = P.cvNoteLen + seq;
+            snprintf(names[noteLenParam], sizeof(names[0]), "Seq %d Note Len", seq + 1);
+            define(noteLenParam, 1, 1000, 100, kNT_unitMs);
+            addToPage(noteLenParam);
+            for (int out = 0; out < dims.outs; out++) {
+                int slewParam = P.cvSlew + (seq * dims.outs) + out;
+                snprintf(names[slewParam], sizeof(names[0]), "Seq %d Slew %d", seq + 1, out + 1);
+                define(slewParam, 0, kMaxSlewMs, 0, kNT_unitMs);
+                addToPage(slewParam);
+            }
+            int shapeParam = P.cvGlideShape + seq;
+            snprintf(names[shapeParam], sizeof(names[0]), "Seq %d Glide Shape", seq + 1);
+            define(shapeParam, 0, 1, kRampLinear, kNT_unitEnum, glideShapeStrings);
+            addToPage(shapeParam);
+        }
+        
+        // Sequencer configuration
+        for (int seq = 0; seq < dims.cvSeqs; seq++) {
+            snprintf(title, sizeof(title), "Seq %d Params", seq + 1);
+            beginPage(title);
+            static const char* const suffixes[kNumSeqParams] = {
+                "Clock Div", "Direction", "Steps", "Split Point", "Sec1 Reps", "Sec2 Reps"
+            };
+            for (int i = 0; i < kNumSeqParams; i++) {
+                snprintf(names[P.seqParam(seq, i)], sizeof(names[0]), "Seq %d %s", seq + 1, suffixes[i]);
+            }
+            define(P.seqParam(seq, kSeqClockDiv), 0, 8, kClockDivX1, kNT_unitEnum, divisionStrings);
+            define(P.seqParam(seq, kSeqDirection), 0, 2, 0, kNT_unitEnum, directionStrings);
+            define(P.seqParam(seq, kSeqStepCount), 1, dims.maxSteps, defaultSteps, kNT_unitNone);
+            define(P.seqParam(seq, kSeqSplitPoint), 1, dims.maxSteps - 1, defaultSteps / 2, kNT_unitNone);
+            define(P.seqParam(seq, kSeqSection1Reps), 1, 99, 1, kNT_unitNone);
+            define(P.seqParam(seq, kSeqSection2Reps), 1, 99, 1, kNT_unitNone);
+            for (int i = 0; i < kNumSeqParams; i++) {
+                addToPage(P.seqParam(seq, i));
+            }
+            
+            // Quantiser; the Custom scale's notes are a bit mask with bit 0 on the root
+            snprintf(names[P.cvScale + seq], sizeof(names[0]), "Seq %d Scale", seq + 1);
+            define(P.cvScale + seq, 0, kScaleCustom, kScaleOff, kNT_unitEnum, scaleStrings);
+            addToPage(P.cvScale + seq);
+            snprintf(names[P.cvRoot + seq], sizeof(names[0]), "Seq %d Root", seq + 1);
+            define(P.cvRoot + seq, 0, 11, 0, kNT_unitEnum, rootStrings);
+            addToPage(P.cvRoot + seq);
+            snprintf(names[P.cvScaleMask + seq], sizeof(names[0]), "Seq %d Custom", seq + 1);
+            define(P.cvScaleMask + seq, 1, 0xFFF, scaleMasks[kScaleMajor], kNT_unitNone);
+            addToPage(P.cvScaleMask + seq);
+        }
+        
+        // Trigger MIDI channel and velocities, then the gate outputs and MIDI CCs
+        beginPage("Gate Outs");
+        snprintf(names[P.triggerMidiChannel], sizeof(names[0]), "Trigger MIDI Ch");
+        define(P.triggerMidiChannel, 0, 16, 0, kNT_unitNone);
+        addToPage(P.triggerMidiChannel);
+        snprintf(names[P.triggerVelocity], sizeof(names[0]), "Trig Master Vel");
+        define(P.triggerVelocity, 0, 127, 100, kNT_unitNone);
+        addToPage(P.triggerVelocity);
+        snprintf(names[P.triggerAccent], sizeof(names[0]), "Trig Accent Vel");
+        define(P.triggerAccent, 0, 127, 127, kNT_unitNone);
+        addToPage(P.triggerAccent);
+        for (int track = 0; track < dims.gateTracks; track++) {
+            snprintf(names[P.gateOut(track)], sizeof(names[0]), "Gate %d Out", track + 1);
+            define(P.gateOut(track), 0, 28, 0, kNT_unitCvOutput);
+            addToPage(P.gateOut(track));
+            snprintf(names[P.gateCC(track)], sizeof(names[0]), "Gate %d CC", track + 1);
+            define(P.gateCC(track), 0, 127, 0, kNT_unitNone);
+            addToPage(P.gateCC(track));
+        }
+        
+        // Gate track configuration and trigger pulse length
+        for (int track = 0; track < dims.gateTracks; track++) {
+            snprintf(title, sizeof(title), "Trig Track %d", track + 1);
+            beginPage(title);
+            static const char* const suffixes[kNumGateParams] = {
+                "Run", "Length", "Direction", "ClockDiv", "Swing", "Split", "Sec1 Reps", "Sec2 Reps", "Fill Start"
+            };
+            for (int i = 0; i < kNumGateParams; i++) {
+                snprintf(names[P.gateParam(track, i)], sizeof(names[0]), "Gate %d %s", track + 1, suffixes[i]);
+            }
+            define(P.gateParam(track, kGateRun), 0, 1, 0, kNT_unitNone);  // Default to stopped
+            define(P.gateParam(track, kGateLength), 1, dims.maxSteps, defaultSteps, kNT_unitNone);
+            define(P.gateParam(track, kGateDirection), 0, 2, 0, kNT_unitEnum, directionStrings);
+            define(P.gateParam(track, kGateClockDiv), 0, 8, kClockDivX1, kNT_unitEnum, divisionStrings);
+            define(P.gateParam(track, kGateSwing), 0, 99, 0, kNT_unitPercent);
+            define(P.gateParam(track, kGateSplitPoint), 0, dims.maxSteps - 1, 0, kNT_unitNone);
+            define(P.gateParam(track, kGateSection1Reps), 1, 99, 1, kNT_unitNone);
+            define(P.gateParam(track, kGateSection2Reps), 1, 99, 1, kNT_unitNone);
+            define(P.gateParam(track, kGateFillStart), 1, dims.maxSteps, 1, kNT_unitNone);
+            for (int i = 0; i < kNumGateParams; i++) {
+                addToPage(P.gateParam(track, i));
+            }
+            
+            int pulseParam = P.gatePulseLen + track;
+            snprintf(names[pulseParam], sizeof(names[0]), "Gate %d Gate Len", track + 1);
+            define(pulseParam, 1, 99, 5, kNT_unitMs);  // 5ms trigger
+            addToPage(pulseParam);
+            
+            // Pattern generator; Bake writes the generated pattern into the steps
+            snprintf(names[P.gateGenerator + track], sizeof(names[0]), "Gate %d Generator", track + 1);
+            define(P.gateGenerator + track, 0, 2, kGeneratorOff, kNT_unitEnum, generatorStrings);
+            addToPage(P.gateGenerator + track);
+            snprintf(names[P.gateHits + track], sizeof(names[0]), "Gate %d Hits", track + 1);
+            define(P.gateHits + track, 0, dims.maxSteps, 4, kNT_unitNone);
+            addToPage(P.gateHits + track);
+            snprintf(names[P.gateRotate + track], sizeof(names[0]), "Gate %d Rotate", track + 1);
+            define(P.gateRotate + track, 0, dims.maxSteps - 1, 0, kNT_unitNone);
+            addToPage(P.gateRotate + track);
+            snprintf(names[P.gateDensity + track], sizeof(names[0]), "Gate %d Density", track + 1);
+            define(P.gateDensity + track, 0, 100, 50, kNT_unitPercent);
+            addToPage(P.gateDensity + track);
+            snprintf(names[P.gateSeed + track], sizeof(names[0]), "Gate %d Seed", track + 1);
+            define(P.gateSeed + track, 1, 999, 1, kNT_unitNone);
+            addToPage(P.gateSeed + track);
+            snprintf(names[P.gateBake + track], sizeof(names[0]), "Gate %d Bake", track + 1);
+            define(P.gateBake + track, 0, 1, 0, kNT_unitEnum, bakeStrings);
+            addToPage(P.gateBake + track);
+        }
+        
+        // Pattern bank selection
+        beginPage("Patterns");
+        snprintf(names[P.bank], sizeof(names[0]), "Pattern");
+        define(P.bank, 1, dims.banks, 1, kNT_unitNone);
+        addToPage(P.bank);
+        snprintf(names[P.bankSwitch], sizeof(names[0]), "Pattern Switch");
+        define(P.bankSwitch, 0, 1, kBankSwitchSection, kNT_unitEnum, bankSwitchStrings);
+        addToPage(P.bankSwitch);
+        
+        // Modulation inputs, each moving one target of one clock track
+        beginPage("Modulation");
+        for (int track = 0; track < dims.tracks(); track++) {
+            if (track < dims.cvSeqs) {
+                snprintf(trackNames[track], sizeof(trackNames[0]), "Seq %d", track + 1);
+            } else {
+                snprintf(trackNames[track], sizeof(trackNames[0]), "Gate %d", track - dims.cvSeqs + 1);
+            }
+            trackStrings[track] = trackNames[track];
+        }
+        trackStrings[dims.tracks()] = NULL;
+        fillRangeStrings(seqStrings, 0, dims.cvSeqs);
+        fillRangeStrings(gateStrings, dims.cvSeqs, dims.gateTracks);
+        for (int i = 0; i < kNumModInputs; i++) {
+            snprintf(names[P.modIn + i], sizeof(names[0]), "Mod %d In", i + 1);
+            define(P.modIn + i, 0, 28, 0, kNT_unitCvInput);
+            addToPage(P.modIn + i);
+            snprintf(names[P.modTarget + i], sizeof(names[0]), "Mod %d Target", i + 1);
+            define(P.modTarget + i, 0, kNumModTargets - 1, kModLength, kNT_unitEnum, modTargetStrings);
+            addToPage(P.modTarget + i);
+            snprintf(names[P.modTrack + i], sizeof(names[0]), "Mod %d Track", i + 1);
+            define(P.modTrack + i, 0, dims.tracks() - 1, 0, kNT_unitEnum, trackStrings);
+            addToPage(P.modTrack + i);
+        }
+        
+        // Recording into the playing bank
+        beginPage("Record");
+        snprintf(names[P.record], sizeof(names[0]), "Record");
+        define(P.record, 0, 1, 0, kNT_unitEnum, offOnStrings);
+        addToPage(P.record);
+        snprintf(names[P.recCvIn], sizeof(names[0]), "Rec CV In");
+        define(P.recCvIn, 0, 28, 0, kNT_unitCvInput);
+        addToPage(P.recCvIn);
+        snprintf(names[P.recSeq], sizeof(names[0]), "Rec Seq");
+        define(P.recSeq, 0, dims.cvSeqs > 0 ? dims.cvSeqs - 1 : 0, 0, kNT_unitEnum, seqStrings);
+        addToPage(P.recSeq);
+        snprintf(names[P.recOut], sizeof(names[0]), "Rec Out");
+        define(P.recOut, 1, dims.outs, 1, kNT_unitNone);
+        addToPage(P.recOut);
+        snprintf(names[P.recGateIn], sizeof(names[0]), "Rec Gate In");
+        define(P.recGateIn, 0, 28, 0, kNT_unitCvInput);
+        addToPage(P.recGateIn);
+        snprintf(names[P.recTrack], sizeof(names[0]), "Rec Track");
+        define(P.recTrack, 0, dims.gateTracks > 0 ? dims.gateTracks - 1 : 0, 0, kNT_unitEnum, gateStrings);
+        addToPage(P.recTrack);
+        
+        // Screen
+        beginPage("Display");
+        snprintf(names[P.playheadRate], sizeof(names[0]), "Playhead Rate");
+        define(P.playheadRate, 0, 3, 0, kNT_unitEnum, playheadRateStrings);
+        addToPage(P.playheadRate);
+        
+        pages.numPages = (uint8_t)numPages;
+        pages.pages = pageArray;
+    }
+};
+
+// Cycle counts of step() and draw(), built in with VSEQ_PROFILE (make PROFILE=1). Each stage keeps
+// its last kProfileRing counts from the Cortex-M7 DWT cycle counter; the diagnostics page past the
+// last sequencer page shows their min/avg/max. Host builds count 0 cycles.
+enum {
+    kProfileStep,       // All of step()
+    kProfileEdits,      // Edits and step cache refresh
+    kProfileScan,       // Clock and reset edge scan
+    kProfileAdvance,    // Edges, events, sequencer advances and bank switches
+    kProfileOutput,     // Output bus fills
+    kProfileMidi,       // MIDI output
+    kProfileDraw,       // All of draw()
+    kNumProfileStages
+};
+
+#ifdef VSEQ_PROFILE
+static const int kProfileRing = 64;
+static const int kDiagnosticsPages = 1;
+
+struct ProfileRing {
+    uint32_t cycles[kProfileRing];
+    uint32_t count;             // Counts recorded, the newest at (count - 1) % kProfileRing
+    
+    void add(uint32_t c) {
+        cycles[count % kProfileRing] = c;
+        count++;
+    }
+    
+    void summarise(uint32_t& min, uint32_t& avg, uint32_t& max) const {
+        int n = (count < (uint32_t)kProfileRing) ? (int)count : kProfileRing;
+        uint64_t sum = 0;
+        min = n ? 0xFFFFFFFFu : 0;
+        max = 0;
+        for (int i = 0; i < n; i++) {
+            uint32_t c = cycles[i];
+            sum += c;
+            if (c < min) min = c;
+            if (c > max) max = c;
+        }
+        avg = n ? (uint32_t)(sum / n) : 0;
+    }
+};
+
+static inline uint32_t readCycles() {
+#ifdef __arm__
+    return *(volatile uint32_t*)0xE0001004;     // DWT_CYCCNT
+#else
+    return 0;
+#endif
+}
+
+// Start the cycle counter, in case the firmware has not
+static void enableCycleCounter() {
+#ifdef __arm__
+    *(volatile uint32_t*)0xE000EDFC |= 1u << 24;    // DEMCR.TRCENA
+    *(volatile uint32_t*)0xE0001000 |= 1u;          // DWT_CTRL.CYCCNTENA
+#endif
+}
+#else
+static const int kDiagnosticsPages = 0;
+
+static inline uint32_t readCycles() {
+    return 0;
+}
+#endif
+
+struct VSeq : public _NT_algorithm {
+    // Size of this instance, and where its parameters sit
+    VSeqDims dims;
+    ParamLayout layout;
+    ParamTables tables;
+    
+    // Pattern banks. step() plays and the editor edits the bank 'active' points to; a queued
+    // switch waits in pendingBank until the lead track (clock track 0) reaches the chosen boundary.
+    PatternBank* banks;
+    PatternBank* active;
+    int pendingBank;            // -1 = no switch waiting
+    uint8_t bankSwitchMode;     // kBankSwitchSection or kBankSwitchLoop
+    
+    // Playback state and resolved parameters per clock track (CV sequencers, then gate tracks)
+    TrackState* tracks;
+    
+    // Step order per clock track
+    StepTable* stepTables;
+    
+    // Quantised note of every semitone of the CV range, per CV sequencer [seq * kScaleNotes]
+    uint8_t* scaleNotes;
+    
+    // Resolved global parameters
+    uint8_t clockInBus;         // 1-28 = bus 0-27
+    uint8_t resetInBus;
+    uint8_t triggerMidiChannel; // 0 = off, 1-16
+    uint8_t triggerVelocity;    // CC value for normal steps
+    uint8_t triggerAccent;      // CC value for accented steps
+    
+    // Edge detection
+    float lastClockIn;
+    float lastResetIn;
+    uint16_t clockEdges[kMaxEdgesPerBlock];  // Frame offsets of clock rising edges in the current block
+    uint16_t resetEdges[kMaxEdgesPerBlock];  // Frame offsets of reset rising edges in the current block
+    
+    // Clock engine
+    uint32_t sampleTime;        // Absolute sample count at the start of the current block
+    uint32_t lastEdgeTime;      // Sample of the most recent clock edge
+    uint32_t clockPeriod;       // Measured samples between clock edges (0 = not yet known)
+    bool haveLastEdge;          // Whether lastEdgeTime is valid
+    uint8_t clockSource;        // kClockSourceCv, kClockSourceMidi or kClockSourceInternal
+    MidiClockFollower midiClock;
+    
+    // Clock link: a lead publishes to sharedClock, a follower plays what it published
+    uint8_t clockLink;          // kClockLinkOff, kClockLinkLead or kClockLinkFollow
+    uint32_t clockPosition;     // Clock edges since the last reset
+    uint32_t linkBlock;         // Follower: the last shared block played
+    uint32_t linkSeeks;         // Follower: the lead's song position jumps already followed
+    bool linkSynced;            // Follower: whether the tracks have joined the lead's position
+    
+    // Internal clock: the phase gains tempoIncrement every sample and an edge is due each time
+    // it reaches internalClockThreshold(). Both are integers, so the edges never drift.
+    uint32_t internalPhase;
+    uint32_t tempoIncrement;    // 16th notes per minute, in tenths
+    bool internalRunning;       // Whether internalPhase is running (false = start on the next block)
+    uint8_t clockOutBus;        // 0 = none, 1-28 = bus 0-27
+    uint32_t clockOutSamples;   // Clock output pulse length
+    ModInput mods[kNumModInputs];
+    
+    // Recording: input buses sampled on each tick of their target track
+    bool recording;
+    uint8_t recCvBus;           // 0 = none, 1-28 = bus 0-27
+    uint8_t recSeq;
+    uint8_t recOut;
+    uint8_t recGateBus;
+    uint8_t recTrack;           // Gate track
+    ClockEventQueue events;
+    EditQueue edits;            // Step edits from the UI
+    EditQueue recorded;         // Step edits from recording, applied at the start of the next block
+    OutputWriter writer;
+    MidiStage midi;
+    uint32_t randomState;       // Step chance rolls (xorshift32, never 0)
+    
+    // UI state
+    int selectedStep;           // 0 to maxSteps-1
+    int selectedSeq;            // CV sequencer index, or cvSeqs for the gate sequencer
+    int selectedTrack;          // Gate track being edited
+    int lastSelectedStep;       // Track when step changes to update pots
+    uint16_t lastButton4State;  // For debouncing button 4
+    uint16_t lastEncoderRButton; // For debouncing right encoder button
+    float lastPotLValue;        // Track left pot position for relative movement
+    bool potCaught[kMaxOuts];   // Track if each pot has caught the step value
+    bool trackPotCaught;        // Track if left pot has caught track position (for gate seq)
+    const PatternBank* editedBank; // Bank the pots last caught values in
+    
+    // Retained rendering: the static grid of the page on screen, the frame built on top of it,
+    // and what each step cell of the frame last showed
+    uint8_t* background;
+    uint8_t* frame;
+    uint32_t* shownCells;       // [track * maxSteps + step] on the gate page, [step] on a CV page
+    bool gridDirty;             // Parameters changed since the grid was drawn
+    
+    // Change detection: step() bumps playheadGeneration when a playhead moves, the editor and
+    // parameter changes bump editGeneration. draw() only looks at the cells when one moved.
+    uint32_t editGeneration;
+    uint32_t playheadGeneration;
+    uint32_t drawnEditGeneration;
+    uint32_t drawnPlayheadGeneration;
+    uint32_t appliedGeneration; // Bumped by step() after applying queued edits or switching banks
+    uint32_t drawnAppliedGeneration;
+    uint32_t playheadDrawTime;  // sampleTime of the last playhead redraw
+    uint32_t playheadInterval;  // Least samples between playhead redraws (0 = no limit)
+    int drawnSeq;               // Page the grid was drawn for
+    int drawnTrack;             // Selected gate track the grid was drawn for
+    
+    // Base64 text of the packed patterns, written by serialise()
+    char* presetText;
+    
+#ifdef VSEQ_PROFILE
+    ProfileRing profile[kNumProfileStages];
+#endif
+    
+    VSeq() {
+        lastClockIn = 0.0f;
+        lastResetIn = 0.0f;
+        selectedStep = 0;
+        selectedSeq = 0;
+        selectedTrack = 0;
+        lastSelectedStep = 0;
+        lastButton4State = 0;
+        lastEncoderRButton = 0;
+        lastPotLValue = 0.5f;
+        for (int i = 0; i < kMaxOuts; i++) {
+            potCaught[i] = false;
+        }
+        trackPotCaught = false;
+        editedBank = NULL;
+        pendingBank = -1;
+        gridDirty = true;
+        editGeneration = 1;
+        playheadGeneration = 0;
+        drawnEditGeneration = 0;
+        drawnPlayheadGeneration = 0;
+        appliedGeneration = 0;
+        drawnAppliedGeneration = 0;
+        playheadDrawTime = 0;
+        drawnSeq = -1;
+        drawnTrack = -1;
+        
+        sampleTime = 0;
+        lastEdgeTime = 0;
+        clockPeriod = 0;
+        haveLastEdge = false;
+        clockSource = kClockSourceCv;
+        midiClock.init();
+        clockLink = kClockLinkOff;
+        clockPosition = 0;
+        linkBlock = 0;
+        linkSeeks = 0;
+        linkSynced = false;
+        internalPhase = 0;
+        internalRunning = false;
+        events.count = 0;
+        edits.init();
+        recorded.init();
+        midi.count = 0;
+        randomState = 0x9E3779B9u;
+        triggerMidiChannel = 0;
+        // The arrays are carved and initialised by construct()
+    }
+    
+    // Fill the carved arrays once they have memory
+    void initArrays() {
+        // Initialize step values to test patterns (visible voltages)
+        // Each sequencer gets different voltage levels for testing
+        for (int bank = 0; bank < dims.banks; bank++) {
+            for (int seq = 0; seq < dims.cvSeqs; seq++) {
+                for (int step = 0; step < dims.maxSteps; step++) {
+                    for (int out = 0; out < dims.outs; out++) {
+                        // Create test patterns: different voltages for each output
+                        // seq 0: 2V, 4V, 6V
+                        // seq 1: 1V, 3V, 5V
+                        // seq 2: 3V, 5V, 7V
+                        float voltage = 2.0f + (seq * 1.0f) + (out * 2.0f);
+                        if (seq == 1) voltage -= 1.0f;
+                        
+                        // Convert voltage (0-10V range) to int16_t (-32768 to 32767)
+                        // 0V = -32768, 10V = 32767
+                        float normalized = voltage / 10.0f;  // 0.0-1.0
+                        bankValues(banks[bank], seq, step)[out] = (int16_t)((normalized * 65535.0f) - 32768.0f);
+                    }
+                }
+            }
+            
+            // Initialize gate sequencer
+            for (int i = 0; i < dims.gateTracks * dims.maxSteps; i++) {
+                banks[bank].gates[i] = 0;
+            }
+            for (int seq = 0; seq < dims.cvSeqs; seq++) {
+                banks[bank].glides[seq] = 0;
+            }
+        }
+        active = banks;
+        invalidateAllSteps();
+        
+        for (int track = 0; track < dims.tracks(); track++) {
+            TrackState& t = tracks[track];
+            t.resetCursor();
+            t.tableGeneration = 0;
+            t.divCounter = 0;
+            t.subTickIndex = 0;
+            t.subTickCount = 1;
+            t.subTickBase = 0;
+            t.gateHigh = false;
+            for (int out = 0; out < kMaxOuts; out++) {
+                t.heldNote[out] = kNoNote;
+            }
+            for (int target = 0; target < kNumModTargets; target++) {
+                t.mod[target] = 0;
+            }
+        }
+        for (int i = 0; i < kNumModInputs; i++) {
+            mods[i].value = 0;
+        }
+        // Resolved parameters are filled in by construct()
+        writer.init();
+    }
+    
+    // CV values of one step in a bank, one per output
+    int16_t* bankValues(const PatternBank& bank, int seq, int step) {
+        return bank.values + (((seq * dims.maxSteps) + step) * dims.outs);
+    }
+    
+    // Gate states of one track in a bank: 0 = off, 1 = normal velocity, 2 = accent velocity
+    uint8_t* bankGates(const PatternBank& bank, int track) {
+        return bank.gates + (track * dims.maxSteps);
+    }
+    
+    // The same for the active bank
+    int16_t* stepValues(int seq, int step) {
+        return bankValues(*active, seq, step);
+    }
+    
+    uint8_t* gateSteps(int track) {
+        return bankGates(*active, track);
+    }
+    
+    // Gate byte a track plays at a step of the active bank: the stored one, or with a generator
+    // the generated state over the stored ratchets and chance
+    uint8_t gateStep(int track, int step) {
+        uint8_t stored = gateSteps(track)[step];
+        const TrackState& t = tracks[dims.cvSeqs + track];
+        if (t.generator == kGeneratorOff) return stored;
+        return (uint8_t)((stored & ~kGateStateMask) | ((t.generatedMask >> step) & 1));
+    }
+    
+    StepOutputs& stepCache(int seq, int step) {
+        return active->cache[(seq * dims.maxSteps) + step];
+    }
+    
+    int activeBank() const {
+        return (int)(active - banks);
+    }
+    
+    // Mark every step of every bank stale after the patterns are replaced
+    void invalidateAllSteps() {
+        for (int bank = 0; bank < dims.banks; bank++) {
+            for (int seq = 0; seq < dims.cvSeqs; seq++) {
+                banks[bank].dirty[seq] = 0xFFFFFFFFu;
+            }
+        }
+    }
+    
+    // Rebuild the derived data of every stale step in the active bank, and in the bank a switch
+    // is waiting for, so the switch finds its cache ready
+    void refreshStepCache() {
+        refreshBank(*active);
+        if (pendingBank >= 0) refreshBank(banks[pendingBank]);
+    }
+    
+    void refreshBank(PatternBank& bank) {
+        for (int seq = 0; seq < dims.cvSeqs; seq++) {
+            uint32_t dirty = bank.dirty[seq];
+            if (dirty == 0) continue;
+            bank.dirty[seq] = 0;
+            const uint8_t* notes = scaleNotes + (seq * kScaleNotes);
+            bool quantise = tracks[seq].scale != kScaleOff;
+            
+            for (int step = 0; step < dims.maxSteps; step++) {
+                if (!(dirty & (1u << step))) continue;
+                
+                StepOutputs& cache = bank.cache[(seq * dims.maxSteps) + step];
+                const int16_t* values = bankValues(bank, seq, step);
+                for (int out = 0; out < dims.outs; out++) {
+                    float normalized = (values[out] + 32768) / 65535.0f;  // 0.0-1.0
+                    
+                    // The note is 1V/oct from 0V; the quantiser snaps the output to it
+                    uint8_t note = notes[stepSemitone(values[out])];
+                    cache.volts[out] = quantise ? note * (1.0f / 12.0f) : normalized;
+                    cache.note[out] = note;
+                    
+                    // Velocity spans 0-127 across the output range
+                    uint8_t level = (uint8_t)(normalized * 127.0f);
+                    if (level > 127) level = 127;
+                    cache.velocity[out] = level;
+                }
+            }
+        }
+    }
+    
+    // Rebuild a CV sequencer's quantiser table from its scale parameters and mark its steps stale
+    // in every bank. Each semitone goes to the nearest note of the scale, the lower one on a tie.
+    void buildScaleTable(int seq) {
+        const TrackState& t = tracks[seq];
+        uint16_t mask = (t.scale == kScaleCustom) ? t.scaleMask : scaleMasks[t.scale];
+        if ((mask & 0xFFF) == 0) mask = 0xFFF;
+        uint8_t* notes = scaleNotes + (seq * kScaleNotes);
+        for (int semitone = 0; semitone < kScaleNotes; semitone++) {
+            int note = semitone;
+            for (int d = 0; d <= 6; d++) {
+                int below = semitone - d;
+                int above = semitone + d;
+                if (below >= 0 && (mask & (1u << ((below + 12 - t.root) % 12)))) {
+                    note = below;
+                    break;
+                }
+                if (above <= kScaleSemitones && (mask & (1u << ((above + 12 - t.root) % 12)))) {
+                    note = above;
+                    break;
+                }
+            }
+            notes[semitone] = (uint8_t)note;
+        }
+        for (int bank = 0; bank < dims.banks; bank++) {
+            banks[bank].dirty[seq] = 0xFFFFFFFFu;
+        }
+    }
+    
+    // Number of UI pages: one per CV sequencer, then the gate sequencer if there are gate tracks
+    int numUiPages() const {
+        return dims.cvSeqs + (dims.gateTracks > 0 ? 1 : 0);
+    }
+    
+    // The diagnostics page sits past the last UI page and only exists with VSEQ_PROFILE
+    bool onDiagnosticsPage() const {
+        return selectedSeq >= numUiPages();
+    }
+};
+
+// Cycles since 'mark', restarting 'mark' for the next stage
+static inline uint32_t profileLap(uint32_t& mark) {
+    uint32_t now = readCycles();
+    uint32_t cycles = now - mark;
+    mark = now;
+    return cycles;
+}
+
+static inline void profileAdd(VSeq* a, int stage, uint32_t cycles) {
+#ifdef VSEQ_PROFILE
+    a->profile[stage].add(cycles);
+#else
+    (void)a;
+    (void)stage;
+    (void)cycles;
+#endif
+}
+
+// Screen is 256x64, stored as 128x64 bytes (2 pixels per byte, 4-bit grayscale)
+static const int kScreenWidth = 256;
+static const int kScreenHeight = 64;
+static const int kScreenBytes = (kScreenWidth / 2) * kScreenHeight;
+
+// Helper function to set a pixel in a framebuffer laid out like NT_screen
+inline void setPixel(uint8_t* fb, int x, int y, int brightness) {
+    if (x < 0 || x >= kScreenWidth || y < 0 || y >= kScreenHeight) return;
+    
+    int byteIndex = (y * 128) + (x / 2);
+    int pixelShift = (x & 1) ? 0 : 4;  // Even pixels in high nibble, odd in low
+    
+    // Clear the nibble and set new value
+    fb[byteIndex] = (fb[byteIndex] & (0x0F << (4 - pixelShift))) | ((brightness & 0x0F) << pixelShift);
+}
+
+// Blitting into packed framebuffers. A row of pixels maps to a partial first byte, whole
+// middle bytes and a partial last byte, so fills and copies touch each byte once.
+struct RowSpan {
+    int first;              // Byte offsets within the row
+    int last;
+    uint8_t firstMask;      // Nibbles of the first and last bytes inside the span
+    uint8_t lastMask;
+    
+    RowSpan(int x0, int x1) {
+        first = x0 / 2;
+        last = x1 / 2;
+        firstMask = (x0 & 1) ? 0x0F : 0xFF;
+        lastMask = (x1 & 1) ? 0xFF : 0xF0;
+        if (first == last) firstMask &= lastMask;
+    }
+};
+
+static inline void storeMasked(uint8_t* p, uint8_t mask, uint8_t value) {
+    *p = (*p & ~mask) | (value & mask);
+}
+
+// Clip a rectangle, corners inclusive, to the screen; false when nothing is left
+static bool clipRect(int& x0, int& y0, int& x1, int& y1) {
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= kScreenWidth) x1 = kScreenWidth - 1;
+    if (y1 >= kScreenHeight) y1 = kScreenHeight - 1;
+    return x0 <= x1 && y0 <= y1;
+}
+
+// Filled rectangle, corners inclusive; also draws the horizontal and vertical lines. Colours are
+// 0-255 like the NT_drawShapeI calls this replaces; the framebuffer keeps their top 4 bits.
+static void fillRect(uint8_t* fb, int x0, int y0, int x1, int y1, int colour) {
+    if (!clipRect(x0, y0, x1, y1)) return;
+    RowSpan span(x0, x1);
+    uint8_t value = (uint8_t)((colour >> 4) * 0x11);
+    int middle = span.last - span.first - 1;
+    for (uint8_t* row = fb + (y0 * 128); row <= fb + (y1 * 128); row += 128) {
+        storeMasked(row + span.first, span.firstMask, value);
+        if (middle > 0) memset(row + span.first + 1, value, middle);
+        if (span.last > span.first) storeMasked(row + span.last, span.lastMask, value);
+    }
+}
+
+// Copy a rectangle of pixels, corners inclusive, between framebuffers
+static void copyRect(uint8_t* dst, const uint8_t* src, int x0, int y0, int x1, int y1) {
+    if (!clipRect(x0, y0, x1, y1)) return;
+    RowSpan span(x0, x1);
+    int middle = span.last - span.first - 1;
+    for (int offset = y0 * 128; offset <= y1 * 128; offset += 128) {
+        uint8_t* row = dst + offset;
+        const uint8_t* from = src + offset;
+        storeMasked(row + span.first, span.firstMask, from[span.first]);
+        if (middle > 0) memcpy(row + span.first + 1, from + span.first + 1, middle);
+        if (span.last > span.first) storeMasked(row + span.last, span.lastMask, from[span.last]);
+    }
+}
+
+// Gate cell sprites on a 7x7 canvas centred on the cell, one bit per pixel (bit 0 = left column)
+static const int kSpriteSize = 7;
+
+enum {
+    kSpriteOff = 0,
+    kSpriteNormal,
+    kSpriteAccent,
+    kSpritePlayhead,
+    kSpriteSelection,
+    kNumSprites
+};
+
+struct SpriteShape {
+    uint8_t rows[kSpriteSize];
+    uint8_t shade;          // 0-15
+};
+
+static const SpriteShape spriteShapes[kNumSprites] = {
+    { { 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00 }, 15 },  // Off: just the center pixel
+    { { 0x00, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x00 }, 15 },  // Normal: filled 5x5 square
+    { { 0x08, 0x1C, 0x3E, 0x7F, 0x3E, 0x1C, 0x08 }, 15 },  // Accent: filled 7x7 diamond
+    { { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18 }, 15 },  // Playhead: small box below the step
+    { { 0x7F, 0x41, 0x41, 0x41, 0x41, 0x41, 0x7F }, 12 },  // Selection: 7x7 frame
+};
+
+// Sprites pre-rasterised into packed bytes, for a canvas starting on an even or odd pixel.
+// A 7 pixel row spans at most 4 bytes.
+struct PackedSprite {
+    uint8_t mask[2][kSpriteSize][4];
+    uint8_t value[2][kSpriteSize][4];
+};
+
+static PackedSprite packedSprites[kNumSprites];
+
+static void packSprites() {
+    for (int s = 0; s < kNumSprites; s++) {
+        const SpriteShape& shape = spriteShapes[s];
+        PackedSprite& packed = packedSprites[s];
+        memset(&packed, 0, sizeof(packed));
+        for (int parity = 0; parity < 2; parity++) {
+            for (int row = 0; row < kSpriteSize; row++) {
+                for (int col = 0; col < kSpriteSize; col++) {
+                    if (!(shape.rows[row] & (1 << col))) continue;
+                    int pos = parity + col;
+                    uint8_t nibble = (pos & 1) ? 0x0F : 0xF0;
+                    packed.mask[parity][row][pos / 2] |= nibble;
+                    packed.value[parity][row][pos / 2] |= (uint8_t)(shape.shade * 0x11) & nibble;
+                }
+            }
+        }
+    }
+}
+
+// Draw a sprite with its canvas at (x, y): four masked stores per row
+static void blitSprite(uint8_t* fb, int sprite, int x, int y) {
+    if (x < 0 || y < 0 || x + kSpriteSize > kScreenWidth || y + kSpriteSize > kScreenHeight) return;
+    const PackedSprite& packed = packedSprites[sprite];
+    int parity = x & 1;
+    uint8_t* row = fb + (y * 128) + (x / 2);
+    for (int r = 0; r < kSpriteSize; r++, row += 128) {
+        const uint8_t* mask = packed.mask[parity][r];
+        const uint8_t* value = packed.value[parity][r];
+        for (int b = 0; b < 4; b++) {
+            storeMasked(row + b, mask[b], value[b]);
+        }
+    }
+}
+
+// Convert a Gate Len parameter (ms) to samples at the current sample rate
+static uint32_t pulseLengthSamples(int ms) {
+    return (uint32_t)(((uint64_t)ms * NT_globals.sampleRate) / 1000);
+}
+
+// A step's random draw for a seed, the same whatever the track length
+static inline uint32_t hashStep(uint32_t seed, uint32_t step) {
+    uint32_t x = (seed * 0x9E3779B9u) ^ ((step + 1) * 0x85EBCA6Bu);
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+}
+
+// Steps a gate track's generator plays over its length, bit per step. Euclidean spreads the
+// hits as evenly as the length allows, starting on the first step before the rotation.
+static uint32_t generateGateMask(const TrackState& t) {
+    uint32_t mask = 0;
+    int length = t.length;
+    if (t.generator == kGeneratorEuclidean) {
+        int hits = (t.hits > length) ? length : t.hits;
+        for (int step = 0; step < length; step++) {
+            int pos = (step + length - (t.rotate % length)) % length;
+            if (((pos * hits) % length) < hits) mask |= 1u << step;
+        }
+    } else if (t.generator == kGeneratorRandom) {
+        for (int step = 0; step < length; step++) {
+            if ((int)(hashStep(t.seed, step) % 100) < t.density) mask |= 1u << step;
+        }
+    }
+    return mask;
+}
+
+// Build a clock track's step table from its parameters moved by its modulation offsets
+static void buildTrackTable(VSeq* a, int track) {
+    TrackState& t = a->tracks[track];
+    int maxSteps = a->dims.maxSteps;
+    bool gate = track >= a->dims.cvSeqs;
+    t.length = (uint8_t)clampInt(t.baseLength + t.mod[kModLength], 1, maxSteps);
+    t.split = (uint8_t)clampInt(t.baseSplit + t.mod[kModSplit], gate ? 0 : 1, maxSteps - 1);
+    t.fillStart = gate ? (uint8_t)clampInt(t.baseFill + t.mod[kModFill], 1, maxSteps) : 0;
+    a->stepTables[track].build(t.direction, t.length, t.split, t.reps[0], t.reps[1], t.fillStart);
+    if (gate) t.generatedMask = generateGateMask(t);
+    t.tableGeneration++;
+}
+
+// Plan a track's next steps again, after its cursor moved other than by a tick or its step table
+// was rebuilt. Audio side only, like the cursor.
+static void replanTrack(VSeq* a, int track) {
+    TrackState& t = a->tracks[track];
+    t.plan.build(a->stepTables[track], t, t.tableGeneration);
+}
+
+// Resolve a clock track's parameters (CV sequencers first, then gate tracks) into its state and step table
+static void snapshotTrack(VSeq* a, const int16_t* v, int track) {
+    const ParamLayout& P = a->layout;
+    TrackState& t = a->tracks[track];
+    if (track < a->dims.cvSeqs) {
+        int base = P.seqParam(track, 0);
+        t.division = (uint8_t)v[base + kSeqClockDiv];
+        for (int out = 0; out < a->dims.outs; out++) {
+            t.outBus[out] = (uint8_t)v[P.cvOut + (track * a->dims.outs) + out];
+            t.midiChannel[out] = (uint8_t)v[P.cvMidi + (track * a->dims.outs) + out];
+        }
+        t.velocitySource = (uint8_t)v[P.cvVelocity + track];
+        t.noteSamples = pulseLengthSamples(v[P.cvNoteLen + track]);
+        for (int out = 0; out < a->dims.outs; out++) {
+            // An exponential glide is within 1% of its target after the slew time
+            uint32_t samples = pulseLengthSamples(v[P.cvSlew + (track * a->dims.outs) + out]);
+            t.slewSamples[out] = samples;
+            t.slewRatio[out] = samples ? expf(-4.6f / (float)samples) : 0.0f;
+        }
+        t.glideShape = (uint8_t)v[P.cvGlideShape + track];
+        t.scale = (uint8_t)v[P.cvScale + track];
+        t.root = (uint8_t)v[P.cvRoot + track];
+        t.scaleMask = (uint16_t)v[P.cvScaleMask + track];
+        t.direction = (uint8_t)v[base + kSeqDirection];
+        t.baseLength = (uint8_t)v[base + kSeqStepCount];
+        t.baseSplit = (uint8_t)v[base + kSeqSplitPoint];
+        t.baseFill = 0;
+        t.reps[0] = (uint8_t)v[base + kSeqSection1Reps];
+        t.reps[1] = (uint8_t)v[base + kSeqSection2Reps];
+    } else {
+        int gateTrack = track - a->dims.cvSeqs;
+        int base = P.gateParam(gateTrack, 0);
+        t.running = v[base + kGateRun] != 0;
+        t.division = (uint8_t)v[base + kGateClockDiv];
+        t.swing = (uint8_t)v[base + kGateSwing];
+        t.outBus[0] = (uint8_t)v[P.gateOut(gateTrack)];
+        t.cc = (uint8_t)v[P.gateCC(gateTrack)];
+        t.pulseSamples = pulseLengthSamples(v[P.gatePulseLen + gateTrack]);
+        t.direction = (uint8_t)v[base + kGateDirection];
+        t.baseLength = (uint8_t)v[base + kGateLength];
+        t.baseSplit = (uint8_t)v[base + kGateSplitPoint];
+        t.baseFill = (uint8_t)v[base + kGateFillStart];
+        t.reps[0] = (uint8_t)v[base + kGateSection1Reps];
+        t.reps[1] = (uint8_t)v[base + kGateSection2Reps];
+        t.generator = (uint8_t)v[P.gateGenerator + gateTrack];
+        t.hits = (uint8_t)v[P.gateHits + gateTrack];
+        t.rotate = (uint8_t)v[P.gateRotate + gateTrack];
+        t.density = (uint8_t)v[P.gateDensity + gateTrack];
+        t.seed = (uint16_t)v[P.gateSeed + gateTrack];
+    }
+    buildTrackTable(a, track);
+}
+
+// Resolve the parameters shared by all tracks
+static void snapshotGlobals(VSeq* a, const int16_t* v) {
+    const ParamLayout& P = a->layout;
+    a->clockInBus = (uint8_t)v[P.clockIn];
+    a->resetInBus = (uint8_t)v[P.resetIn];
+    a->triggerMidiChannel = (uint8_t)v[P.triggerMidiChannel];
+    a->triggerVelocity = (uint8_t)v[P.triggerVelocity];
+    a->triggerAccent = (uint8_t)v[P.triggerAccent];
+    int rate = playheadRates[v[P.playheadRate]];
+    a->playheadInterval = rate ? NT_globals.sampleRate / rate : 0;
+    a->bankSwitchMode = (uint8_t)v[P.bankSwitch];
+    a->clockSource = (uint8_t)v[P.clockSource];
+    if (a->clockLink != (uint8_t)v[P.clockLink]) a->linkSynced = false;
+    a->clockLink = (uint8_t)v[P.clockLink];
+    a->tempoIncrement = (uint32_t)v[P.tempo] * 4;  // Four 16ths per beat
+    a->clockOutBus = (uint8_t)v[P.clockOut];
+    a->clockOutSamples = pulseLengthSamples(kClockOutMs);
+    a->recording = v[P.record] != 0;
+    a->recCvBus = (uint8_t)v[P.recCvIn];
+    a->recSeq = (uint8_t)v[P.recSeq];
+    a->recOut = (uint8_t)(v[P.recOut] - 1);
+    a->recGateBus = (uint8_t)v[P.recGateIn];
+    a->recTrack = (uint8_t)v[P.recTrack];
+    for (int i = 0; i < kNumModInputs; i++) {
+        ModInput& m = a->mods[i];
+        m.bus = (uint8_t)v[P.modIn + i];
+        m.target = (uint8_t)v[P.modTarget + i];
+        m.track = (uint8_t)v[P.modTrack + i];
+    }
+}
+
+// Clock track a parameter belongs to, or -1 for a global parameter
+static int trackForParam(VSeq* a, int p) {
+    const ParamLayout& P = a->layout;
+    int cvSeqs = a->dims.cvSeqs;
+    if (p >= P.cvOut && p < P.cvMidi) return (p - P.cvOut) / a->dims.outs;
+    if (p >= P.cvMidi && p < P.cvVelocity) return (p - P.cvMidi) / a->dims.outs;
+    if (p >= P.cvVelocity && p < P.triggerMidiChannel) return p - P.cvVelocity;
+    if (p >= P.cvTrack && p < P.gateOutCC) return (p - P.cvTrack) / kNumSeqParams;
+    if (p >= P.gateOutCC && p < P.gateTrack) return cvSeqs + (p - P.gateOutCC) / 2;
+    if (p >= P.gateTrack && p < P.gatePulseLen) return cvSeqs + (p - P.gateTrack) / kNumGateParams;
+    if (p >= P.gatePulseLen && p < P.playheadRate) return cvSeqs + (p - P.gatePulseLen);
+    if (p >= P.cvNoteLen && p < P.clockSource) return p - P.cvNoteLen;
+    if (p >= P.cvSlew && p < P.cvGlideShape) return (p - P.cvSlew) / a->dims.outs;
+    if (p >= P.cvGlideShape && p < P.cvScale) return p - P.cvGlideShape;
+    if (p >= P.cvScale && p < P.cvScaleMask + cvSeqs) return (p - P.cvScale) % cvSeqs;
+    if (p >= P.gateGenerator && p < P.gateBake) return cvSeqs + (p - P.gateGenerator) % a->dims.gateTracks;
+    return -1;
+}
+
+// Packed preset format: a header, then per bank the gate states at 2 bits per step, the steps
+// with ratchets or chance (a varint count, then per step a varint gap from the last one and the
+// byte's upper 6 bits), the CV values as zigzag varint deltas in [seq][out][step] order and each
+// sequencer's glide steps as a varint bit mask. A zero delta is followed by a byte counting the
+// further zero deltas after it. serialise() stores it as one base64 string; the header keeps the
+// saved dimensions so presets load into instances of any size.
+static const uint8_t kPresetMagic[2] = { 'V', 'S' };
+static const uint8_t kPresetVersion = 3;   // Version 1 had no ratchet or chance list, 2 no glides
+static const int kPresetHeaderBytes = 8;    // Magic, version, then cvSeqs, outs, gateTracks, maxSteps, banks
+
+static const char base64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Largest packed preset for a set of dimensions: every gate step ratcheted, every value a
+// 3 byte delta and every glide mask 5 bytes
+static int packedPresetBytes(const VSeqDims& dims) {
+    int numGates = dims.gateTracks * dims.maxSteps;
+    int gateBytes = ((numGates + 3) / 4) + 3 + (3 * numGates);
+    int valueBytes = (3 * dims.cvSlots() * dims.maxSteps) + (5 * dims.cvSeqs);
+    return kPresetHeaderBytes + (dims.banks * (gateBytes + valueBytes));
+}
+
+// Base64 text of a packed preset, including the terminating NUL
+static int presetTextLength(const VSeqDims& dims) {
+    return (4 * ((packedPresetBytes(dims) + 2) / 3)) + 1;
+}
+
+// Writes bytes straight out as base64 text
+struct Base64Writer {
+    char* start;
+    char* out;
+    uint32_t bits;
+    int numBits;
+    
+    explicit Base64Writer(char* buffer) : start(buffer), out(buffer), bits(0), numBits(0) {}
+    
+    void put(uint8_t b) {
+        bits = (bits << 8) | b;
+        numBits += 8;
+        while (numBits >= 6) {
+            numBits -= 6;
+            *out++ = base64Chars[(bits >> numBits) & 63];
+        }
+    }
+    
+    void putVarint(uint32_t v) {
+        while (v >= 0x80) {
+            put((uint8_t)(v | 0x80));
+            v >>= 7;
+        }
+        put((uint8_t)v);
+    }
+    
+    // Flush the last bits, pad to a multiple of 4 characters and terminate the text
+    void finish() {
+        if (numBits > 0) *out++ = base64Chars[(bits << (6 - numBits)) & 63];
+        while ((out - start) % 4) *out++ = '=';
+        *out = 0;
+    }
+};
+
+// Reads bytes straight from base64 text; any character outside the alphabet (padding or the
+// end of the text) ends the data
+struct Base64Reader {
+    const char* in;
+    uint32_t bits;
+    int numBits;
+    
+    explicit Base64Reader(const char* text) : in(text), bits(0), numBits(0) {}
+    
+    static int decode(char c) {
+        if (c >= 'A' && c <= 'Z') return c - 'A';
+        if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+        if (c >= '0' && c <= '9') return c - '0' + 52;
+        if (c == '+') return 62;
+        if (c == '/') return 63;
+        return -1;
+    }
+    
+    bool get(uint8_t& b) {
+        while (numBits < 8) {
+            int c = decode(*in);
+            if (c < 0) return false;
+            in++;
+            bits = (bits << 6) | (uint32_t)c;
+            numBits += 6;
+        }
+        numBits -= 8;
+        b = (uint8_t)(bits >> numBits);
+        return true;
+    }
+    
+    bool getVarint(uint32_t& v) {
+        v = 0;
+        for (int shift = 0; shift < 32; shift += 7) {
+            uint8_t b;
+            if (!get(b)) return false;
+            v |= (uint32_t)(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+};
+
+// Factory specifications, in the same order for every factory
+enum {
+    kSpecCvSeqs = 0,
+    kSpecGateTracks,
+    kSpecMaxSteps,
+    kSpecBanks,
+    kNumSpecifications
+};
+
+static const _NT_specification specifications[kNumSpecifications] = {
+    { .name = "CV Sequencers", .min = 0, .max = 3, .def = 3, .type = kNT_typeGeneric },
+    { .name = "Trigger Tracks", .min = 0, .max = 6, .def = 6, .type = kNT_typeGeneric },
+    { .name = "Max Steps", .min = 8, .max = 32, .def = 32, .type = kNT_typeGeneric },
+    { .name = "Pattern Banks", .min = 1, .max = 16, .def = 1, .type = kNT_typeGeneric },
+};
+
+static const _NT_specification liteSpecifications[kNumSpecifications] = {
+    { .name = "CV Sequencers", .min = 0, .max = 1, .def = 1, .type = kNT_typeGeneric },
+    { .name = "Trigger Tracks", .min = 0, .max = 4, .def = 4, .type = kNT_typeGeneric },
+    { .name = "Max Steps", .min = 8, .max = 16, .def = 16, .type = kNT_typeGeneric },
+    { .name = "Pattern Banks", .min = 1, .max = 4, .def = 1, .type = kNT_typeGeneric },
+};
+
+static int clampSpec(int value, int min, int max) {
+    return (value < min) ? min : (value > max ? max : value);
+}
+
+// Instance dimensions for a set of specification values
+static VSeqDims dimsFromSpecifications(const int32_t* specs) {
+    VSeqDims dims;
+    dims.cvSeqs = clampSpec(specs[kSpecCvSeqs], 0, 3);
+    dims.outs = kMaxOuts;
+    dims.gateTracks = clampSpec(specs[kSpecGateTracks], 0, 6);
+    dims.maxSteps = clampSpec(specs[kSpecMaxSteps], 8, 32);
+    dims.banks = clampSpec(specs[kSpecBanks], 1, 16);
+    
+    // A sequencer with nothing to play still needs a track to show
+    if (dims.tracks() == 0) dims.gateTracks = 1;
+    return dims;
+}
+
+// Lay out every array an instance needs behind its header (SRAM) or in its DRAM. The header's
+// dims and layout must be set. With NULL carver bases this only measures the memory.
+static void carveInstance(VSeq* a, MemoryCarver& sram, MemoryCarver& dram) {
+    const VSeqDims& dims = a->dims;
+    int patternSteps = dims.cvSeqs * dims.maxSteps;
+    
+    sram.take<VSeq>(1);
+    a->tracks = sram.take<TrackState>(dims.tracks());
+    a->stepTables = sram.take<StepTable>(dims.tracks());
+    a->scaleNotes = sram.take<uint8_t>(dims.cvSeqs * kScaleNotes);
+    StepTransition* transitions = sram.take<StepTransition>(dims.tracks() * 2 * dims.maxSteps);
+    a->writer.carve(sram, dims.outputSlots());
+    a->banks = sram.take<PatternBank>(dims.banks);
+    
+    for (int bank = 0; bank < dims.banks; bank++) {
+        PatternBank pattern;
+        pattern.values = dram.take<int16_t>(patternSteps * dims.outs);
+        pattern.gates = dram.take<uint8_t>(dims.gateTracks * dims.maxSteps);
+        pattern.glides = dram.take<uint32_t>(dims.cvSeqs);
+        pattern.cache = dram.take<StepOutputs>(patternSteps);
+        pattern.dirty = dram.take<uint32_t>(dims.cvSeqs);
+        if (sram.base) a->banks[bank] = pattern;
+    }
+    a->tables.carve(dram, dims, a->layout);
+    a->presetText = dram.take<char>(presetTextLength(dims));
+    a->background = dram.take<uint8_t>(kScreenBytes);
+    a->frame = dram.take<uint8_t>(kScreenBytes);
+    a->shownCells = dram.take<uint32_t>((dims.gateTracks > 1 ? dims.gateTracks : 1) * dims.maxSteps);
+    
+    if (sram.base) {
+        for (int track = 0; track < dims.tracks(); track++) {
+            a->stepTables[track].init(transitions + (track * 2 * dims.maxSteps), dims.maxSteps);
+        }
+    }
+}
+
+void calculateRequirements(_NT_algorithmRequirements& req, const int32_t* specs) {
+    VSeq shell;
+    shell.dims = dimsFromSpecifications(specs);
+    shell.layout.build(shell.dims);
+    
+    MemoryCarver sram(NULL);
+    MemoryCarver dram(NULL);
+    carveInstance(&shell, sram, dram);
+    
+    req.numParameters = shell.layout.numParameters;
+    req.sram = sram.used;
+    req.dram = dram.used;
+    req.dtc = 0;
+    req.itc = 0;
+}
+
+_NT_algorithm* construct(const _NT_algorithmMemoryPtrs& ptrs, const _NT_algorithmRequirements&, const int32_t* specs) {
+    VSeq* alg = new (ptrs.sram) VSeq();
+    alg->dims = dimsFromSpecifications(specs);
+    alg->layout.build(alg->dims);
+    
+    MemoryCarver sram(ptrs.sram);
+    MemoryCarver dram(ptrs.dram);
+    carveInstance(alg, sram, dram);
+    alg->initArrays();
+    packSprites();
+#ifdef VSEQ_PROFILE
+    memset(alg->profile, 0, sizeof(alg->profile));
+    enableCycleCounter();
+#endif
+    
+    const ParamLayout& P = alg->layout;
+    ParamTables& T = alg->tables;
+    T.build(alg->dims, P);
+    alg->parameters = T.parameters;
+    alg->parameterPages = &T.pages;
+    
+    // Resolve the parameter defaults until parameterChanged delivers the real values
+    int16_t defaults[kMaxParameters];
+    for (int i = 0; i < P.numParameters; i++) {
+        defaults[i] = T.parameters[i].def;
+    }
+    snapshotGlobals(alg, defaults);
+    for (int track = 0; track < alg->dims.tracks(); track++) {
+        snapshotTrack(alg, defaults, track);
+        replanTrack(alg, track);
+    }
+    for (int seq = 0; seq < alg->dims.cvSeqs; seq++) {
+        alg->buildScaleTable(seq);
+    }
+    
+    return alg;
+}
+
+// Scan an input bus frame by frame and record the offset of every rising edge
+// Returns the number of edges found; 'last' carries the previous sample across blocks
+static int scanRisingEdges(const float* in, int numFrames, float& last, uint16_t* offsets) {
+    int count = 0;
+    float prev = last;
+    for (int frame = 0; frame < numFrames; frame++) {
+        float x = in[frame];
+        if (x > 0.5f && prev <= 0.5f && count < kMaxEdgesPerBlock) {
+            offsets[count++] = (uint16_t)frame;
+        }
+        prev = x;
+    }
+    last = prev;
+    return count;
+}
+
+// Sample the modulation inputs on the block's first frame and move the tracks they modulate.
+// Each input's value only changes once it is kModHysteresis past a rounding point, and a
+// track's step table is rebuilt only when its length, split or fill start actually moves.
+static void readModInputs(VSeq* a, const float* busFrames, int numFrames) {
+    for (int i = 0; i < kNumModInputs; i++) {
+        ModInput& m = a->mods[i];
+        if (m.bus < 1 || m.bus > 28) {
+            m.value = 0;
+            continue;
+        }
+        float volts = busFrames[(m.bus - 1) * numFrames];
+        float perVolt = (m.target == kModTranspose) ? 12.0f : a->dims.maxSteps / 10.0f;
+        float x = volts * perVolt;
+        if (x > m.value + 0.5f + kModHysteresis || x < m.value - 0.5f - kModHysteresis) {
+            m.value = (int8_t)clampInt((int)floorf(x + 0.5f), -kScaleSemitones, kScaleSemitones);
+        }
+    }
+    
+    for (int track = 0; track < a->dims.tracks(); track++) {
+        int8_t offsets[kNumModTargets] = { 0, 0, 0, 0 };
+        for (int i = 0; i < kNumModInputs; i++) {
+            const ModInput& m = a->mods[i];
+            if (m.track == track && m.target < kNumModTargets) {
+                offsets[m.target] = (int8_t)clampInt(offsets[m.target] + m.value, -kScaleSemitones, kScaleSemitones);
+            }
+        }
+        
+        TrackState& t = a->tracks[track];
+        t.mod[kModTranspose] = offsets[kModTranspose];
+        if (offsets[kModLength] != t.mod[kModLength] || offsets[kModSplit] != t.mod[kModSplit] ||
+            offsets[kModFill] != t.mod[kModFill]) {
+            t.mod[kModLength] = offsets[kModLength];
+            t.mod[kModSplit] = offsets[kModSplit];
+            t.mod[kModFill] = offsets[kModFill];
+            buildTrackTable(a, track);
+            a->gridDirty = true;
+            a->appliedGeneration++;
+        }
+    }
+}
+
+// Level of a CV step output after its sequencer's transposition. Quantised outputs move by
+// whole notes of the 0-10V range; unquantised ones by 1/12V per semitone.
+static float outputVolts(VSeq* a, int seq, const StepOutputs& cache, int out) {
+    const TrackState& t = a->tracks[seq];
+    int transpose = t.mod[kModTranspose];
+    if (transpose == 0) return cache.volts[out];
+    if (t.scale == kScaleOff) {
+        float volts = cache.volts[out] + (transpose * (1.0f / 12.0f));
+        return (volts < 0.0f) ? 0.0f : (volts > 10.0f ? 10.0f : volts);
+    }
+    return clampInt(cache.note[out] + transpose, 0, kScaleSemitones) * (1.0f / 12.0f);
+}
+
+// Assign this block's output buses and bring the CV slots up to date with the current steps,
+// which also picks up edits made to a playing step since the last block
+static void beginOutputs(VSeq* a, float* busFrames, int numFrames) {
+    a->writer.beginBlock(busFrames, numFrames);
+    
+    for (int seq = 0; seq < a->dims.cvSeqs; seq++) {
+        const TrackState& t = a->tracks[seq];
+        for (int out = 0; out < a->dims.outs; out++) {
+            int slot = seq * a->dims.outs + out;
+            a->writer.bus[slot] = t.outBus[out];  // 0 = none, 1-28 = bus 0-27
+            a->writer.retarget(slot, outputVolts(a, seq, a->stepCache(seq, t.step), out));
+        }
+    }
+    
+    for (int track = 0; track < a->dims.gateTracks; track++) {
+        // Stopped tracks leave their output bus untouched
+        const TrackState& t = a->tracks[a->dims.cvSeqs + track];
+        a->writer.bus[a->dims.cvSlots() + track] = t.running ? t.outBus[0] : 0;
+    }
+    a->writer.bus[a->dims.clockOutSlot()] = a->clockOutBus;
+}
+
+// Update a CV sequencer's output slots after its step changed at 'frame'. With 'glide', outputs
+// with a slew time ramp to a step that has glide set instead of jumping.
+static void setSequencerOutputs(VSeq* a, int seq, int frame, bool glide = false) {
+    const TrackState& t = a->tracks[seq];
+    const StepOutputs& cache = a->stepCache(seq, t.step);
+    glide = glide && (a->active->glides[seq] & (1u << t.step));
+    for (int out = 0; out < a->dims.outs; out++) {
+        int slot = seq * a->dims.outs + out;
+        if (glide && t.slewSamples[out] > 0) {
+            a->writer.glide(slot, frame, outputVolts(a, seq, cache, out), (int)t.slewSamples[out], t.glideShape,
+                            t.slewRatio[out]);
+        } else {
+            a->writer.set(slot, frame, outputVolts(a, seq, cache, out));
+        }
+    }
+}
+
+// Make the waiting bank the active one at 'frame'. Its cache is already built, so this only
+// moves the pointer and brings the CV outputs of the steps now playing up to date.
+static void switchBank(VSeq* a, int frame) {
+    a->active = &a->banks[a->pendingBank];
+    a->pendingBank = -1;
+    a->appliedGeneration++;
+    for (int seq = 0; seq < a->dims.cvSeqs; seq++) {
+        setSequencerOutputs(a, seq, frame);
+    }
+}
+
+// Apply a waiting bank switch when the lead track crosses the boundary Pattern Switch waits for
+static void checkBankSwitch(VSeq* a, int track, int crossed, int frame) {
+    if (track != 0 || a->pendingBank < 0) return;
+    int boundary = (a->bankSwitchMode == kBankSwitchLoop) ? kCrossLoop : kCrossSection;
+    if (crossed & boundary) switchBank(a, frame);
+}
+
+// The shared clock when this instance leads, otherwise NULL
+static inline SharedClock* ledClock(VSeq* a) {
+    return (a->clockLink == kClockLinkLead) ? sharedClock : NULL;
+}
+
+// Reset all sequencers and running gate tracks to their first step at 'frame'
+static void handleReset(VSeq* a, int frame) {
+    a->clockPosition = 0;
+    SharedClock* shared = ledClock(a);
+    if (shared && shared->numResets < kMaxEdgesPerBlock) shared->resets[shared->numResets++] = (uint16_t)frame;
+    
+    // A reset starts the pattern again, so a waiting bank switch happens here
+    if (a->pendingBank >= 0) switchBank(a, frame);
+    
+    // Restart clock divisions in phase and drop pending multiplier sub-ticks and swung ticks
+    for (int track = 0; track < a->dims.tracks(); track++) {
+        a->tracks[track].divCounter = 0;
+        a->events.cancel(kEventSubTick, (uint8_t)track);
+        a->events.cancel(kEventSwungTick, (uint8_t)track);
+        a->events.cancel(kEventRatchet, (uint8_t)track);
+    }
+    
+    for (int seq = 0; seq < a->dims.cvSeqs; seq++) {
+        a->tracks[seq].resetCursor();
+        setSequencerOutputs(a, seq, frame);
+    }
+    a->playheadGeneration++;
+    
+    for (int track = a->dims.cvSeqs; track < a->dims.tracks(); track++) {
+        if (a->tracks[track].running) {
+            a->tracks[track].resetCursor();
+        }
+    }
+    for (int track = 0; track < a->dims.tracks(); track++) {
+        replanTrack(a, track);
+    }
+}
+
+// Level of an input bus at a frame of the current block. The writer holds the block's buses.
+static inline float inputAt(VSeq* a, int bus, int frame) {
+    return a->writer.busFrames[((bus - 1) * a->writer.numFrames) + frame];
+}
+
+// Record the CV input into the step a sequencer just moved to, sampled on the tick's frame
+static void recordCvStep(VSeq* a, int seq, int frame) {
+    if (!a->recording || seq != a->recSeq || a->recCvBus < 1 || a->recCvBus > 28) return;
+    float volts = inputAt(a, a->recCvBus, frame);
+    volts = (volts < 0.0f) ? 0.0f : (volts > 10.0f ? 10.0f : volts);
+    int16_t value = (int16_t)(((volts / 10.0f) * 65535.0f) - 32768.0f);
+    StepEdit edit = { kEditCvValue, (uint8_t)a->activeBank(), (uint8_t)seq, (uint8_t)a->tracks[seq].step,
+                      a->recOut, value };
+    a->recorded.push(edit);
+}
+
+// Record the gate input as on or off into the step a gate track just moved to
+static void recordGateStep(VSeq* a, int track, int frame) {
+    if (!a->recording || track != a->recTrack || a->recGateBus < 1 || a->recGateBus > 28) return;
+    bool high = inputAt(a, a->recGateBus, frame) > 0.5f;
+    StepEdit edit = { kEditGateSet, (uint8_t)a->activeBank(), (uint8_t)track,
+                      (uint8_t)a->tracks[a->dims.cvSeqs + track].step, 0, (int16_t)(high ? 1 : 0) };
+    a->recorded.push(edit);
+}
+
+// Advance a CV sequencer by one step at 'frame' and send its MIDI notes
+static void tickSequencer(VSeq* a, int seq, int frame) {
+    TrackState& t = a->tracks[seq];
+    int crossed = a->stepTables[seq].advance(t);
+    t.plan.follow(a->stepTables[seq], t, t.tableGeneration);
+    a->playheadGeneration++;
+    checkBankSwitch(a, seq, crossed, frame);
+    recordCvStep(a, seq, frame);
+    
+    setSequencerOutputs(a, seq, frame, true);
+    
+    // Send MIDI notes for outputs with a channel configured
+    const StepOutputs& cache = a->stepCache(seq, t.step);
+    bool noteSent = false;
+    for (int out = 0; out < a->dims.outs; out++) {
+        int midiChannel = t.midiChannel[out];  // 0 = off, 1-16 = MIDI channels
+        
+        if (midiChannel > 0 && midiChannel <= 16) {
+            uint8_t midiNote = (uint8_t)clampInt(cache.note[out] + t.mod[kModTranspose], 0, 127);
+            
+            uint8_t velocity = 100;  // Default fixed velocity
+            if (t.velocitySource > 0 && t.velocitySource <= a->dims.outs) {
+                // Use the selected output value as velocity
+                velocity = cache.velocity[t.velocitySource - 1];
+            }
+            
+            uint8_t channel = (midiChannel - 1) & 0x0F;
+            
+            // A note still sounding from the last step ends first
+            if (t.heldNote[out] != kNoNote) {
+                a->midi.add(frame, t.heldStatus[out], t.heldNote[out], 0);
+            }
+            
+            // Send note on
+            a->midi.add(frame, 0x90 | channel, midiNote, velocity);
+            t.heldNote[out] = midiNote;
+            t.heldStatus[out] = 0x80 | channel;  // Note Off on the same channel
+            noteSent = true;
+        }
+    }
+    
+    // The notes end Note Len after this frame, or when the next step's notes start
+    if (noteSent) {
+        a->events.cancel(kEventNoteOff, (uint8_t)seq);
+        a->events.push(a->sampleTime + frame + t.noteSamples, kEventNoteOff, (uint8_t)seq);
+    }
+}
+
+// Send the note offs of a CV sequencer's sounding notes at 'frame'
+static void releaseNotes(VSeq* a, int seq, int frame) {
+    TrackState& t = a->tracks[seq];
+    for (int out = 0; out < a->dims.outs; out++) {
+        if (t.heldNote[out] != kNoNote) {
+            a->midi.add(frame, t.heldStatus[out], t.heldNote[out], 0);
+            t.heldNote[out] = kNoNote;
+        }
+    }
+}
+
+// Samples between ticks of a clock track at the measured clock period
+static uint32_t trackStepPeriod(VSeq* a, int track) {
+    int division = a->tracks[track].division;
+    return (a->clockPeriod * clockDivisors[division]) / clockMultipliers[division];
+}
+
+// Fire a gate track's trigger at 'frame' for a step in 'stepState'. The pulse ends 'pulse'
+// samples later.
+static void fireTrigger(VSeq* a, int track, int frame, int stepState, uint32_t pulse) {
+    TrackState& t = a->tracks[a->dims.cvSeqs + track];
+    uint8_t clockTrack = (uint8_t)(a->dims.cvSeqs + track);
+    t.gateHigh = true;
+    a->writer.set(a->dims.cvSlots() + track, frame, kGateHighVolts);
+    a->events.cancel(kEventGateOff, clockTrack);
+    a->events.push(a->sampleTime + frame + pulse, kEventGateOff, clockTrack);
+    
+    // Send MIDI CC if configured
+    if (a->triggerMidiChannel > 0 && a->triggerMidiChannel <= 16) {
+        // Velocity based on step state (1=normal, 2=accent)
+        uint8_t velocity = (stepState == 2) ? a->triggerAccent : a->triggerVelocity;
+        uint8_t channel = (a->triggerMidiChannel - 1) & 0x0F;
+        
+        // Send CC with velocity
+        a->midi.addControl(frame, 0xB0 | channel, t.cc, velocity);
+    }
+}
+
+// Schedule a clock track's next ratchet sub-trigger, spaced from the step's first trigger so
+// rounding never accumulates
+static void scheduleRatchet(VSeq* a, int track) {
+    const TrackState& t = a->tracks[track];
+    uint32_t offset = (uint32_t)(((uint64_t)t.ratchetPeriod * t.ratchetIndex) / t.ratchetCount);
+    a->events.push(t.ratchetBase + offset, kEventRatchet, (uint8_t)track);
+}
+
+// Roll a step's chance of playing
+static bool rollChance(VSeq* a, uint8_t step) {
+    int chance = gateChance(step);
+    if (chance >= kChanceLevels) return true;
+    
+    // xorshift32
+    uint32_t x = a->randomState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    a->randomState = x;
+    return (int)(x >> 29) < chance;
+}
+
+// Advance a gate track by one step and fire its trigger for a tick at 'frame' within the current block
+static void tickGateTrack(VSeq* a, int track, int frame) {
+    uint8_t clockTrack = (uint8_t)(a->dims.cvSeqs + track);
+    TrackState& t = a->tracks[clockTrack];
+    
+    // Skip sequencer advancement if not running
+    if (!t.running) return;
+    
+    int crossed = a->stepTables[clockTrack].advance(t);
+    t.plan.follow(a->stepTables[clockTrack], t, t.tableGeneration);
+    a->playheadGeneration++;
+    checkBankSwitch(a, clockTrack, crossed, frame);
+    recordGateStep(a, track, frame);
+    
+    // A new step ends the ratchets of the last one
+    a->events.cancel(kEventRatchet, clockTrack);
+    
+    // After advancing, mark if current step should trigger
+    uint8_t stepByte = a->gateStep(track, t.step);
+    int stepState = gateState(stepByte);
+    if (stepState == 0 || !rollChance(a, stepByte)) return;
+    
+    // Ratchets spread their triggers over the step period, once that is known
+    int ratchets = gateRatchets(stepByte);
+    uint32_t period = (ratchets > 1 && a->clockPeriod > 0) ? trackStepPeriod(a, clockTrack) : 0;
+    if (period >= (uint32_t)ratchets * 2) {
+        uint32_t spacing = period / ratchets;
+        t.ratchetIndex = 1;
+        t.ratchetCount = (uint8_t)ratchets;
+        t.ratchetState = (uint8_t)stepState;
+        t.ratchetBase = a->sampleTime + frame;
+        t.ratchetPeriod = period;
+        t.ratchetPulse = (t.pulseSamples < spacing / 2) ? t.pulseSamples : spacing / 2;
+        scheduleRatchet(a, clockTrack);
+        fireTrigger(a, track, frame, stepState, t.ratchetPulse);
+        return;
+    }
+    
+    // Gate is active on this step - trigger! The pulse ends Gate Len after this frame
+    fireTrigger(a, track, frame, stepState, t.pulseSamples);
+}
+
+// Phase an internal clock edge is due at: samples per minute, in the tenths of the tempo
+static uint32_t internalClockThreshold() {
+    return 600u * NT_globals.sampleRate;
+}
+
+// Record the frame offset of every internal clock edge in a block of numFrames, advancing
+// the phase to the end of the block. Returns the number of edges.
+static int scanInternalClock(VSeq* a, int numFrames, uint16_t* offsets) {
+    uint32_t threshold = internalClockThreshold();
+    uint32_t increment = a->tempoIncrement;
+    if (!a->internalRunning) {
+        a->internalPhase = threshold;   // The first edge falls on the first frame
+        a->internalRunning = true;
+    }
+    
+    uint32_t phase = a->internalPhase;
+    int frame = 0;
+    int count = 0;
+    for (;;) {
+        // Frames until the phase reaches the threshold; it can already be there when the last
+        // block ended just before an edge
+        uint32_t wait = (phase >= threshold) ? 0 : (threshold - phase + increment - 1) / increment;
+        if (frame + (int)wait >= numFrames || count >= kMaxEdgesPerBlock) {
+            phase += increment * (uint32_t)(numFrames - frame);
+            break;
+        }
+        frame += (int)wait;
+        offsets[count++] = (uint16_t)frame;
+        phase = phase + (increment * wait) - threshold;
+    }
+    a->internalPhase = phase;
+    return count;
+}
+
+// Advance one clock track for a tick at 'frame' within the current block
+static void tickTrack(VSeq* a, int track, int frame) {
+    if (track < a->dims.cvSeqs) {
+        tickSequencer(a, track, frame);
+        return;
+    }
+    
+    int gateTrack = track - a->dims.cvSeqs;
+    TrackState& t = a->tracks[track];
+    
+    // A swung tick still pending when the next tick arrives plays now, so steps never reorder
+    if (a->events.cancel(kEventSwungTick, (uint8_t)track) > 0) {
+        tickGateTrack(a, gateTrack, frame);
+    }
+    
+    // Swing delays every second tick by a share of the track's step period
+    t.swingCounter ^= 1;
+    if (t.swingCounter == 0 && t.swing > 0 && a->clockPeriod > 0) {
+        uint32_t delay = (uint32_t)(((uint64_t)trackStepPeriod(a, track) * t.swing) / 100);
+        if (delay > 0) {
+            a->events.push(a->sampleTime + frame + delay, kEventSwungTick, (uint8_t)track);
+            return;
+        }
+    }
+    
+    tickGateTrack(a, gateTrack, frame);
+}
+
+// Schedule the next multiplier sub-tick for a track. Sub-ticks are spaced from the
+// edge that started them, so rounding never accumulates across the edge period.
+static void scheduleSubTick(VSeq* a, int track) {
+    const TrackState& t = a->tracks[track];
+    uint32_t offset = (uint32_t)(((uint64_t)a->clockPeriod * t.subTickIndex) / t.subTickCount);
+    a->events.push(t.subTickBase + offset, kEventSubTick, (uint8_t)track);
+}
+
+// Clock edge at 'frame': measure the period, then tick every track whose division is due
+static void handleClockEdge(VSeq* a, int frame) {
+    uint32_t time = a->sampleTime + frame;
+    if (a->clockLink == kClockLinkFollow) {
+        // Followers take the tempo the lead measured from its own source
+        if (sharedClock && sharedClock->clockPeriod > 0) a->clockPeriod = sharedClock->clockPeriod;
+    } else if (a->clockSource == kClockSourceMidi) {
+        // Edges from MIDI clock take the smoothed tempo rather than their block-aligned spacing
+        if (a->midiClock.clockPeriod > 0.0f) {
+            a->clockPeriod = (uint32_t)(a->midiClock.clockPeriod * kMidiClocksPerStep + 0.5f);
+        }
+    } else if (a->clockSource == kClockSourceInternal) {
+        a->clockPeriod = internalClockThreshold() / a->tempoIncrement;
+    } else if (a->haveLastEdge) {
+        a->clockPeriod = time - a->lastEdgeTime;
+    }
+    a->lastEdgeTime = time;
+    a->haveLastEdge = true;
+    a->clockPosition++;
+    SharedClock* shared = ledClock(a);
+    if (shared && shared->numEdges < kMaxEdgesPerBlock) shared->edges[shared->numEdges++] = (uint16_t)frame;
+    
+    // Every edge, whatever its source, pulses the clock output
+    a->writer.set(a->dims.clockOutSlot(), frame, kGateHighVolts);
+    a->events.cancel(kEventClockOutOff, 0);
+    a->events.push(time + a->clockOutSamples, kEventClockOutOff, 0);
+    
+    for (int track = 0; track < a->dims.tracks(); track++) {
+        TrackState& t = a->tracks[track];
+        int divisor = clockDivisors[t.division];
+        int multiplier = clockMultipliers[t.division];
+        
+        // A new edge supersedes any sub-ticks still pending from the previous one
+        a->events.cancel(kEventSubTick, (uint8_t)track);
+        
+        // Divisions tick on the first of every 'divisor' edges
+        bool due = (t.divCounter == 0);
+        t.divCounter++;
+        if (t.divCounter >= divisor) {
+            t.divCounter = 0;
+        }
+        if (!due) continue;
+        
+        tickTrack(a, track, frame);
+        
+        // Multiplications spread the remaining ticks over the measured period
+        if (multiplier > 1 && a->clockPeriod > 0) {
+            t.subTickBase = time;
+            t.subTickIndex = 1;
+            t.subTickCount = multiplier;
+            scheduleSubTick(a, track);
+        }
+    }
+}
+
+// Queued event at 'frame' within the current block
+static void handleEvent(VSeq* a, const ClockEvent& e, int frame) {
+    if (e.type == kEventSubTick) {
+        int track = e.track;
+        tickTrack(a, track, frame);
+        
+        TrackState& t = a->tracks[track];
+        t.subTickIndex++;
+        if (t.subTickIndex < t.subTickCount) {
+            scheduleSubTick(a, track);
+        }
+    } else if (e.type == kEventSwungTick) {
+        tickGateTrack(a, e.track - a->dims.cvSeqs, frame);
+    } else if (e.type == kEventGateOff) {
+        a->tracks[e.track].gateHigh = false;
+        a->writer.set(a->dims.cvSlots() + e.track - a->dims.cvSeqs, frame, 0.0f);
+    } else if (e.type == kEventNoteOff) {
+        releaseNotes(a, e.track, frame);
+    } else if (e.type == kEventClockOutOff) {
+        a->writer.set(a->dims.clockOutSlot(), frame, 0.0f);
+    } else if (e.type == kEventRatchet) {
+        TrackState& t = a->tracks[e.track];
+        fireTrigger(a, e.track - a->dims.cvSeqs, frame, t.ratchetState, t.ratchetPulse);
+        t.ratchetIndex++;
+        if (t.ratchetIndex < t.ratchetCount) {
+            scheduleRatchet(a, e.track);
+        }
+    }
+}
+
+// Whether two cursors are at the same point of a track's order
+static bool sameCursor(const StepCursor& x, const StepCursor& y) {
+    return x.step == y.step && x.forward == y.forward && x.inSection2 == y.inSection2 &&
+           x.sec1Counter == y.sec1Counter && x.sec2Counter == y.sec2Counter;
+}
+
+// Move every track to where it would be 'position' 16th notes (clock edges) after a reset,
+// without playing the steps in between. A track's order repeats once its cursor is back where
+// the first tick put it. The reset state itself may not come round again: pingpong passes step 0
+// moving back. So at most two cycles of the pattern are walked.
+static void seekTracks(VSeq* a, uint32_t position) {
+    a->clockPosition = position;
+    if (SharedClock* shared = ledClock(a)) {
+        // Followers jump with the lead, to where it jumped at the start of the block
+        shared->position = position;
+        shared->seeks++;
+    }
+    for (int track = 0; track < a->dims.tracks(); track++) {
+        TrackState& t = a->tracks[track];
+        a->events.cancel(kEventSubTick, (uint8_t)track);
+        a->events.cancel(kEventSwungTick, (uint8_t)track);
+        a->events.cancel(kEventRatchet, (uint8_t)track);
+        if (track >= a->dims.cvSeqs && !t.running) continue;
+        
+        // Edges 0, divisor, 2 * divisor ... tick, each with all of its multiplier sub-ticks
+        int divisor = clockDivisors[t.division];
+        uint32_t ticks = ((position + divisor - 1) / divisor) * clockMultipliers[t.division];
+        t.resetCursor();
+        t.divCounter = (int)(position % divisor);
+        t.swingCounter = (int)(ticks & 1);
+        StepCursor first = t;
+        for (uint32_t done = 1; done <= ticks; done++) {
+            a->stepTables[track].advance(t);
+            if (done == 1) {
+                first = t;
+            } else if (sameCursor(t, first)) {
+                ticks = done + ((ticks - done) % (done - 1));
+            }
+        }
+        replanTrack(a, track);
+    }
+    
+    for (int seq = 0; seq < a->dims.cvSeqs; seq++) {
+        releaseNotes(a, seq, 0);
+        setSequencerOutputs(a, seq, 0);
+    }
+    a->playheadGeneration++;
+}
+
+// Apply the MIDI clock and transport messages received since the last block, in order, at frame 0
+static void followMidiClock(VSeq* a) {
+    MidiClockFollower& m = a->midiClock;
+    for (int i = 0; i < m.numPending; i++) {
+        uint8_t byte = m.pending[i];
+        if (byte == 0xF8) {
+            // Clock: time every one, step on every kMidiClocksPerStep-th while running
+            m.measure(a->sampleTime);
+            if (!m.running) continue;
+            if (m.clockCount == 0) handleClockEdge(a, 0);
+            if (++m.clockCount >= kMidiClocksPerStep) m.clockCount = 0;
+        } else if (byte == 0xFA) {
+            // Start: from the top, stepping on the first clock as a reset clock input would
+            handleReset(a, 0);
+            m.running = true;
+            m.clockCount = 0;
+        } else if (byte == 0xFB) {
+            // Continue: from the current position, or the one a song position pointer set
+            m.running = true;
+        } else if (byte == 0xFC) {
+            // Stop: hold the current steps and end the sounding notes
+            m.running = false;
+            for (int seq = 0; seq < a->dims.cvSeqs; seq++) {
+                releaseNotes(a, seq, 0);
+            }
+        } else if (byte == kMidiSongPosition) {
+            seekTracks(a, m.songPosition);
+            m.clockCount = 0;
+        }
+    }
+    m.numPending = 0;
+}
+
+// Take the block's clock edges and resets from the lead instead of scanning the inputs. Returns
+// whether the tracks must first move to the lead's position: on joining it, and after it jumped.
+static bool followSharedClock(VSeq* a, int numFrames, int& numClockEdges, int& numResetEdges) {
+    SharedClock* s = sharedClock;
+    a->internalRunning = false;
+    if (!s || s->block == a->linkBlock) return false;  // No lead, or nothing new from it
+    a->linkBlock = s->block;
+    if (s->seeks != a->linkSeeks) {
+        a->linkSeeks = s->seeks;
+        a->linkSynced = false;
+    }
+    
+    for (int i = 0; i < s->numEdges; i++) {
+        if (s->edges[i] < numFrames) a->clockEdges[numClockEdges++] = s->edges[i];
+    }
+    for (int i = 0; i < s->numResets; i++) {
+        if (s->resets[i] < numFrames) a->resetEdges[numResetEdges++] = s->resets[i];
+    }
+    
+    bool join = !a->linkSynced;
+    a->linkSynced = true;
+    return join;
+}
+
+// Apply the edits the UI published since the last block. Each one marks only its own step stale,
+// in the bank it was made in.
+static void applyEdits(VSeq* a) {
+    const ParamLayout& P = a->layout;
+    StepEdit e;
+    bool applied = false;
+    while (a->edits.pop(e) || a->recorded.pop(e)) {
+        if (e.type == kEditCvValue) {
+            if (e.bank >= a->dims.banks || e.lane >= a->dims.cvSeqs || e.step >= a->dims.maxSteps ||
+                e.out >= a->dims.outs) continue;
+            PatternBank& bank = a->banks[e.bank];
+            a->bankValues(bank, e.lane, e.step)[e.out] = e.value;
+            bank.invalidateStep(e.lane, e.step);
+        } else if (e.type == kEditGateCycle) {
+            if (e.bank >= a->dims.banks || e.lane >= a->dims.gateTracks || e.step >= a->dims.maxSteps) continue;
+            uint8_t& state = a->bankGates(a->banks[e.bank], e.lane)[e.step];
+            state = (uint8_t)((state & ~kGateStateMask) | ((gateState(state) + 1) % 3));
+        } else if (e.type == kEditGateRatchet || e.type == kEditGateChance) {
+            if (e.bank >= a->dims.banks || e.lane >= a->dims.gateTracks || e.step >= a->dims.maxSteps) continue;
+            uint8_t& state = a->bankGates(a->banks[e.bank], e.lane)[e.step];
+            if (e.type == kEditGateRatchet) {
+                if (e.value < 1 || e.value > kMaxRatchets) continue;
+                state = (uint8_t)((state & ~kGateRatchetMask) | ((e.value - 1) << kGateRatchetShift));
+            } else {
+                if (e.value < 0 || e.value >= kChanceLevels) continue;
+                state = (uint8_t)((state & ~kGateChanceMask) | (e.value << kGateChanceShift));
+            }
+        } else if (e.type == kEditCvGlide) {
+            if (e.bank >= a->dims.banks || e.lane >= a->dims.cvSeqs || e.step >= a->dims.maxSteps) continue;
+            a->banks[e.bank].glides[e.lane] ^= 1u << e.step;
+        } else if (e.type == kEditScale) {
+            if (e.lane >= a->dims.cvSeqs) continue;
+            a->buildScaleTable(e.lane);
+        } else if (e.type == kEditGateSet) {
+            if (e.bank >= a->dims.banks || e.lane >= a->dims.gateTracks || e.step >= a->dims.maxSteps) continue;
+            uint8_t& state = a->bankGates(a->banks[e.bank], e.lane)[e.step];
+            state = (uint8_t)((state & ~kGateStateMask) | (e.value & kGateStateMask));
+        } else if (e.type == kEditBake) {
+            if (e.lane >= a->dims.gateTracks) continue;
+            const TrackState& t = a->tracks[a->dims.cvSeqs + e.lane];
+            if (t.generator != kGeneratorOff) {
+                uint8_t* steps = a->gateSteps(e.lane);
+                for (int step = 0; step < t.length; step++) {
+                    steps[step] = a->gateStep(e.lane, step);
+                }
+            }
+            int32_t algoIdx = NT_algorithmIndex(a);
+            NT_setParameterFromAudio(algoIdx, P.gateGenerator + e.lane + NT_parameterOffset(), kGeneratorOff);
+            NT_setParameterFromAudio(algoIdx, P.gateBake + e.lane + NT_parameterOffset(), 0);
+        } else if (e.type == kEditSelectBank) {
+            if (e.value < 0 || e.value >= a->dims.banks) continue;
+            // Choosing the playing bank again cancels a waiting switch
+            a->pendingBank = (e.value == a->activeBank()) ? -1 : e.value;
+        } else if (e.type == kEditSectionReset) {
+            if (e.lane >= a->dims.cvSeqs) continue;
+            int32_t algoIdx = NT_algorithmIndex(a);
+            NT_setParameterFromAudio(algoIdx, P.seqParam(e.lane, kSeqSplitPoint) + NT_parameterOffset(), e.value);
+            NT_setParameterFromAudio(algoIdx, P.seqParam(e.lane, kSeqSection1Reps) + NT_parameterOffset(), 1);
+            NT_setParameterFromAudio(algoIdx, P.seqParam(e.lane, kSeqSection2Reps) + NT_parameterOffset(), 1);
+            
+            // Reset section counters
+            TrackState& t = a->tracks[e.lane];
+            t.sec1Counter = 0;
+            t.sec2Counter = 0;
+            t.inSection2 = false;
+            replanTrack(a, e.lane);
+        }
+        applied = true;
+    }
+    if (applied) a->appliedGeneration++;
+}
+
+void step(_NT_algorithm* self, float* busFrames, int numFramesBy4) {
+    VSeq* a = (VSeq*)self;
+    
+    // Input bus indices from the resolved parameters
+    int clockBus = a->clockInBus - 1;  // 0-27 (parameter is 1-28)
+    int resetBus = a->resetInBus - 1;
+    
+    // Calculate number of actual frames
+    int numFrames = numFramesBy4 * 4;
+    uint32_t start = readCycles();
+    uint32_t mark = start;
+    
+    // Apply step edits made since the last block, then rebuild the steps they touched
+    applyEdits(a);
+    a->refreshStepCache();
+    readModInputs(a, busFrames, numFrames);
+    
+    // Plans made before their step table was rebuilt are made again
+    for (int track = 0; track < a->dims.tracks(); track++) {
+        if (a->tracks[track].plan.generation != a->tracks[track].tableGeneration) replanTrack(a, track);
+    }
+    profileAdd(a, kProfileEdits, profileLap(mark));
+    
+    // Find the frame offset of every clock and reset edge in this block
+    int numClockEdges = 0;
+    int numResetEdges = 0;
+    bool joinLead = false;
+    SharedClock* shared = ledClock(a);
+    if (shared) {
+        shared->numEdges = 0;
+        shared->numResets = 0;
+        shared->position = a->clockPosition;
+    }
+    if (a->clockLink == kClockLinkFollow) {
+        joinLead = followSharedClock(a, numFrames, numClockEdges, numResetEdges);
+    } else if (a->clockSource == kClockSourceInternal) {
+        numClockEdges = scanInternalClock(a, numFrames, a->clockEdges);
+    } else {
+        a->internalRunning = false;
+        if (a->clockSource == kClockSourceCv && clockBus >= 0 && clockBus < 28) {
+            numClockEdges = scanRisingEdges(busFrames + (clockBus * numFrames), numFrames, a->lastClockIn, a->clockEdges);
+        }
+    }
+    if (a->clockLink != kClockLinkFollow && resetBus >= 0 && resetBus < 28) {
+        numResetEdges = scanRisingEdges(busFrames + (resetBus * numFrames), numFrames, a->lastResetIn, a->resetEdges);
+    }
+    profileAdd(a, kProfileScan, profileLap(mark));
+    
+    // Process edges and queued events in frame order; each one updates the outputs from its
+    // own frame. On the same frame a reset comes first, then a clock edge, then queued events.
+    beginOutputs(a, busFrames, numFrames);
+    uint32_t outputCycles = profileLap(mark);
+    
+    // Without a running lead track (before the first clock, or with Gate 1 stopped) no boundary
+    // will come, so a bank switch happens at once
+    if (a->pendingBank >= 0) {
+        bool leadRunning = a->dims.cvSeqs > 0 || a->tracks[0].running;
+        if (!a->haveLastEdge || !leadRunning) switchBank(a, 0);
+    }
+    
+    // MIDI clock and transport all land on frame 0, ahead of the CV reset edges and queued events.
+    // A follower moves to the lead's position there instead. While MIDI is not the clock, its
+    // bytes are dropped as they come, so choosing it later never replays them.
+    bool midiClockActive = a->clockSource == kClockSourceMidi && a->clockLink != kClockLinkFollow;
+    if (joinLead) {
+        seekTracks(a, sharedClock->position);
+    } else if (midiClockActive) {
+        followMidiClock(a);
+    }
+    if (!midiClockActive) {
+        a->midiClock.numPending = 0;
+        a->midiClock.haveLastClock = false;
+    }
+    
+    int clockIdx = 0;
+    int resetIdx = 0;
+    for (;;) {
+        int resetFrame = (resetIdx < numResetEdges) ? a->resetEdges[resetIdx] : numFrames;
+        int clockFrame = (clockIdx < numClockEdges) ? a->clockEdges[clockIdx] : numFrames;
+        int eventFrame = numFrames;
+        if (a->events.count > 0) {
+            int32_t offset = (int32_t)(a->events.events[0].time - a->sampleTime);
+            eventFrame = (offset < 0) ? 0 : (offset < numFrames ? offset : numFrames);
+        }
+        
+        int frame = resetFrame;
+        if (clockFrame < frame) frame = clockFrame;
+        if (eventFrame < frame) frame = eventFrame;
+        if (frame >= numFrames) break;
+        
+        if (resetFrame == frame) {
+            handleReset(a, frame);
+            resetIdx++;
+        } else if (clockFrame == frame) {
+            handleClockEdge(a, frame);
+            clockIdx++;
+        } else {
+            ClockEvent e = a->events.pop();
+            handleEvent(a, e, frame);
+        }
+    }
+    profileAdd(a, kProfileAdvance, profileLap(mark));
+    
+    if (shared) {
+        shared->clockPeriod = a->clockPeriod;
+        shared->block++;
+    }
+    
+    a->writer.endBlock();
+    a->recorded.commit();
+    profileAdd(a, kProfileOutput, outputCycles + profileLap(mark));
+    a->midi.flush();
+    profileAdd(a, kProfileMidi, profileLap(mark));
+    profileAdd(a, kProfileStep, profileLap(start));
+    a->sampleTime += numFrames;
+}
+
+// Step cell contents for the retained renderer. A cell repaints only when its state differs
+// from the one last drawn; kCellUnknown forces a repaint.
+static const uint32_t kCellUnknown = 0xFFFFFFFFu;
+
+// CV step view layout: one skinny bar per output, rows of 16 steps
+static const int kCvBarWidth = 3;       // Width of each bar
+static const int kCvBarSpacing = 1;     // Space between bars within a step
+static const int kCvStepGap = 4;        // Gap after each step (reduced to make room for dots)
+static const int kCvStartY = 10;        // Start below title
+static const int kCvRowHeight = 26;     // Height of each row
+static const int kCvMaxBarHeight = 22;  // Maximum bar height
+
+static int cvBarsWidth(const VSeq* a) {
+    return (a->dims.outs * kCvBarWidth) + ((a->dims.outs - 1) * kCvBarSpacing);  // 3 bars: 3*3 + 2*1 = 11
+}
+
+// CV cell state: 5 bits of bar height per output, then active, playing and selected flags
+enum {
+    kCvCellActive = 1 << 15,
+    kCvCellPlaying = 1 << 16,
+    kCvCellSelected = 1 << 17,
+    kCvCellGlide = 1 << 18
+};
+
+static uint32_t cvCellState(VSeq* a, int seq, int step, int stepCount) {
+    uint32_t state = 0;
+    const int16_t* values = a->stepValues(seq, step);
+    for (int out = 0; out < a->dims.outs; out++) {
+        // Convert int16_t (-32768 to 32767) to 0.0-1.0, then to bar height (1 to kCvMaxBarHeight pixels)
+        float normalized = (values[out] + 32768.0f) / 65535.0f;
+        int barHeight = (int)(normalized * kCvMaxBarHeight);
+        if (barHeight < 1) barHeight = 1;
+        state |= (uint32_t)barHeight << (5 * out);
+    }
+    if (step < stepCount) state |= kCvCellActive;
+    if (step == a->tracks[seq].step) state |= kCvCellPlaying;
+    if (step == a->selectedStep) state |= kCvCellSelected;
+    if (a->active->glides[seq] & (1u << step)) state |= kCvCellGlide;
+    return state;
+}
+
+// Static parts of a CV page: percentage dots, section marker, separators and page indicators
+static void drawCvGrid(VSeq* a, uint8_t* fb) {
+    int seq = a->selectedSeq;
+    int stepCount = a->tracks[seq].length;
+    int splitPoint = a->tracks[seq].split;
+    int barsWidth = cvBarsWidth(a);
+    int stepWidth = barsWidth + kCvStepGap;  // Total width per step: 11 + 4 = 15
+    
+    for (int step = 0; step < a->dims.maxSteps; step++) {
+        int col = step % 16;
+        int x = col * stepWidth;
+        int y = kCvStartY + ((step / 16) * kCvRowHeight);
+        
+        // Draw percentage dots in the gap between steps
+        if (col < 15) {  // Don't draw after the last step in each row
+            int dotX = x + barsWidth + 2;  // Start of gap area (moved 1px right)
+            // 4 dots at 25%, 50%, 75%, 100% of bar height
+            setPixel(fb, dotX, y + kCvMaxBarHeight - (kCvMaxBarHeight / 4), 8);
+            setPixel(fb, dotX, y + kCvMaxBarHeight - (kCvMaxBarHeight / 2), 8);
+            setPixel(fb, dotX, y + kCvMaxBarHeight - (3 * kCvMaxBarHeight / 4), 8);
+            setPixel(fb, dotX, y, 8);
+        }
         
-        parameters[fillParam].name = gateFillNames[track];
-        parameters[fillParam].min = 1;
-        parameters[fillParam].max = 32;
-        parameters[fillParam].def = 1;  // Default to lowest value
-        parameters[fillParam].unit = kNT_unitNone;
-        parameters[fillParam].scaling = kNT_scalingNone;
-    }
-}
-
-// Parameter pages
-static uint8_t paramPageInputs[] = { kParamClockIn, kParamResetIn, 0 };
-static uint8_t paramPageSeq1Out[] = { kParamSeq1Out1, kParamSeq1Midi1, kParamSeq1Out2, kParamSeq1Midi2, kParamSeq1Out3, kParamSeq1Midi3, kParamSeq1MidiVelocity, 0 };
-static uint8_t paramPageSeq2Out[] = { kParamSeq2Out1, kParamSeq2Midi1, kParamSeq2Out2, kParamSeq2Midi2, kParamSeq2Out3, kParamSeq2Midi3, kParamSeq2MidiVelocity, 0 };
-static uint8_t paramPageSeq3Out[] = { kParamSeq3Out1, kParamSeq3Midi1, kParamSeq3Out2, kParamSeq3Midi2, kParamSeq3Out3, kParamSeq3Midi3, kParamSeq3MidiVelocity, 0 };
-static uint8_t paramPageSeq1Params[] = { kParamSeq1ClockDiv, kParamSeq1Direction, kParamSeq1StepCount, kParamSeq1SplitPoint, kParamSeq1Section1Reps, kParamSeq1Section2Reps, 0 };
-static uint8_t paramPageSeq2Params[] = { kParamSeq2ClockDiv, kParamSeq2Direction, kParamSeq2StepCount, kParamSeq2SplitPoint, kParamSeq2Section1Reps, kParamSeq2Section2Reps, 0 };
-static uint8_t paramPageSeq3Params[] = { kParamSeq3ClockDiv, kParamSeq3Direction, kParamSeq3StepCount, kParamSeq3SplitPoint, kParamSeq3Section1Reps, kParamSeq3Section2Reps, 0 };
-static uint8_t paramPageGateOuts[] = { kParamTriggerMidiChannel, kParamTriggerMasterVelocity, kParamTriggerMasterAccent, kParamGate1Out, kParamGate1CC, kParamGate2Out, kParamGate2CC, kParamGate3Out, kParamGate3CC, kParamGate4Out, kParamGate4CC, kParamGate5Out, kParamGate5CC, kParamGate6Out, kParamGate6CC, 0 };
-static uint8_t paramPageGate1[] = { kParamGate1Run, kParamGate1Length, kParamGate1Direction, kParamGate1ClockDiv, kParamGate1Swing, kParamGate1SplitPoint, kParamGate1Section1Reps, kParamGate1Section2Reps, kParamGate1FillStart, 0 };
-static uint8_t paramPageGate2[] = { kParamGate2Run, kParamGate2Length, kParamGate2Direction, kParamGate2ClockDiv, kParamGate2Swing, kParamGate2SplitPoint, kParamGate2Section1Reps, kParamGate2Section2Reps, kParamGate2FillStart, 0 };
-static uint8_t paramPageGate3[] = { kParamGate3Run, kParamGate3Length, kParamGate3Direction, kParamGate3ClockDiv, kParamGate3Swing, kParamGate3SplitPoint, kParamGate3Section1Reps, kParamGate3Section2Reps, kParamGate3FillStart, 0 };
-static uint8_t paramPageGate4[] = { kParamGate4Run, kParamGate4Length, kParamGate4Direction, kParamGate4ClockDiv, kParamGate4Swing, kParamGate4SplitPoint, kParamGate4Section1Reps, kParamGate4Section2Reps, kParamGate4FillStart, 0 };
-static uint8_t paramPageGate5[] = { kParamGate5Run, kParamGate5Length, kParamGate5Direction, kParamGate5ClockDiv, kParamGate5Swing, kParamGate5SplitPoint, kParamGate5Section1Reps, kParamGate5Section2Reps, kParamGate5FillStart, 0 };
-static uint8_t paramPageGate6[] = { kParamGate6Run, kParamGate6Length, kParamGate6Direction, kParamGate6ClockDiv, kParamGate6Swing, kParamGate6SplitPoint, kParamGate6Section1Reps, kParamGate6Section2Reps, kParamGate6FillStart, 0 };
-
-static _NT_parameterPage pageArray[] = {
-    { .name = "Inputs", .numParams = 2, .params = paramPageInputs },
-    { .name = "Seq 1 Outs", .numParams = 7, .params = paramPageSeq1Out },
-    { .name = "Seq 2 Outs", .numParams = 7, .params = paramPageSeq2Out },
-    { .name = "Seq 3 Outs", .numParams = 7, .params = paramPageSeq3Out },
-    { .name = "Seq 1 Params", .numParams = 6, .params = paramPageSeq1Params },
-    { .name = "Seq 2 Params", .numParams = 6, .params = paramPageSeq2Params },
-    { .name = "Seq 3 Params", .numParams = 6, .params = paramPageSeq3Params },
-    { .name = "Gate Outs", .numParams = 15, .params = paramPageGateOuts },
-    { .name = "Trig Track 1", .numParams = 9, .params = paramPageGate1 },
-    { .name = "Trig Track 2", .numParams = 9, .params = paramPageGate2 },
-    { .name = "Trig Track 3", .numParams = 9, .params = paramPageGate3 },
-    { .name = "Trig Track 4", .numParams = 9, .params = paramPageGate4 },
-    { .name = "Trig Track 5", .numParams = 9, .params = paramPageGate5 },
-    { .name = "Trig Track 6", .numParams = 9, .params = paramPageGate6 }
-};
-
-static _NT_parameterPages pages = {
-    .numPages = 14,
-    .pages = pageArray
-};
-
-void calculateRequirements(_NT_algorithmRequirements& req, const int32_t*) {
-    req.numParameters = kNumParameters;
-    req.sram = sizeof(VSeq);
-}
-
-_NT_algorithm* construct(const _NT_algorithmMemoryPtrs& ptrs, const _NT_algorithmRequirements&, const int32_t*) {
-    VSeq* alg = new (ptrs.sram) VSeq();
-    initParameters();
-    alg->parameters = parameters;
-    alg->parameterPages = &pages;
+        // Draw a small 2x2 box between last step of first section and first step of second section
+        if (step == (splitPoint - 1) && splitPoint > 0 && splitPoint < stepCount) {
+            int boxX = x + barsWidth + 1;  // In the gap after this step
+            int boxY = y + kCvMaxBarHeight + 3;  // Below the bars
+            fillRect(fb, boxX, boxY, boxX + 1, boxY + 1, 255);
+        }
+    }
     
-    // Initialize debug output bus array from default parameter values
-    for (int i = 0; i < 12; i++) {
-        alg->debugOutputBus[i] = parameters[kParamSeq1Out1 + i].def;
+    // Draw short separator lines at top and bottom of screen between groups of 4 steps
+    // Between steps 4-5, 8-9, 12-13
+    for (int group = 1; group < 4; group++) {
+        int x = (group * 4 * stepWidth) - (kCvStepGap / 2);
+        fillRect(fb, x, 0, x, 3, 128);
+        fillRect(fb, x, 60, x, 63, 128);
     }
     
-    return alg;
+    // Draw page indicators at the very top (above step view)
+    // One bar per sequencer page, centered above groups of 4 steps
+    int pageBarY = 4;  // Just below the top separator lines
+    int groupWidth = 4 * stepWidth;  // Width of 4 steps including gaps
+    for (int i = 0; i < a->numUiPages(); i++) {
+        int barStartX = (i * groupWidth) + (kCvStepGap / 2);
+        int barEndX = ((i + 1) * groupWidth) - (kCvStepGap / 2) - kCvStepGap;
+        int brightness = (i == seq) ? 255 : 80;  // Bright if active, dim otherwise
+        fillRect(fb, barStartX, pageBarY, barEndX, pageBarY, brightness);
+    }
 }
 
-void step(_NT_algorithm* self, float* busFrames, int numFramesBy4) {
-    VSeq* a = (VSeq*)self;
+// Draw one CV step cell; the caller restores the grid under it first
+static void drawCvCell(VSeq* a, uint8_t* fb, int step, uint32_t state) {
+    int barsWidth = cvBarsWidth(a);
+    int x = (step % 16) * (barsWidth + kCvStepGap);
+    int y = kCvStartY + ((step / 16) * kCvRowHeight);
     
-    // Get input bus indices from parameters
-    int clockBus = self->v[kParamClockIn] - 1;  // 0-27 (parameter is 1-28)
-    int resetBus = self->v[kParamResetIn] - 1;
+    int brightness = (state & kCvCellActive) ? 255 : 40;  // Dim inactive steps
+    for (int out = 0; out < a->dims.outs; out++) {
+        int barHeight = (state >> (5 * out)) & 0x1F;
+        int barX = x + (out * (kCvBarWidth + kCvBarSpacing));
+        int barBottomY = y + kCvMaxBarHeight;
+        fillRect(fb, barX, barBottomY - barHeight, barX + kCvBarWidth - 1, barBottomY, brightness);
+    }
     
-    // Calculate number of actual frames
-    int numFrames = numFramesBy4 * 4;
+    // Glide steps have a line across the top of the cell
+    if (state & kCvCellGlide) {
+        fillRect(fb, x, y - 1, x + barsWidth - 1, y - 1, 128);
+    }
     
-    // Get first sample from each input bus (for edge detection)
-    float clockIn = (clockBus >= 0 && clockBus < 28) ? busFrames[clockBus * numFrames] : 0.0f;
-    float resetIn = (resetBus >= 0 && resetBus < 28) ? busFrames[resetBus * numFrames] : 0.0f;
+    // Draw step indicator above the middle bar if this is the current step
+    if (state & kCvCellPlaying) {
+        int dotX = x + (kCvBarWidth + kCvBarSpacing);
+        fillRect(fb, dotX, y - 3, dotX + kCvBarWidth - 1, y - 1, 255);
+    }
     
-    // Clock edge detection (rising edge)
-    bool clockTrig = (clockIn > 0.5f && a->lastClockIn <= 0.5f);
-    bool resetTrig = (resetIn > 0.5f && a->lastResetIn <= 0.5f);
+    // Draw selection underline if this is the selected step
+    if (state & kCvCellSelected) {
+        fillRect(fb, x, y + kCvMaxBarHeight + 2, x + barsWidth - 1, y + kCvMaxBarHeight + 2, 255);
+    }
+}
+
+// Gate page layout: tracks × steps below an 8px title
+// Step size: 256/32 = 8px per step with 32 steps
+// Track height: (64-8)/6 = ~9px per track with 6 tracks
+static const int kGateStartY = 8;
+
+// Gate cell state: 0 past the track length, otherwise active, 2 bits of gate state, then
+// playing and selected flags
+enum {
+    kGateCellActive = 1,
+    kGateCellPlaying = 1 << 3,
+    kGateCellSelected = 1 << 4
+};
+
+static uint32_t gateCellState(VSeq* a, int track, int step, int trackLength) {
+    if (step >= trackLength) return 0;  // Skip inactive steps entirely
+    uint32_t state = kGateCellActive | ((uint32_t)gateState(a->gateStep(track, step)) << 1);
+    if (step == a->tracks[a->dims.cvSeqs + track].step) state |= kGateCellPlaying;
+    if (step == a->selectedStep && track == a->selectedTrack) state |= kGateCellSelected;
+    return state;
+}
+
+// Static parts of the gate page: page indicators, selected track marker and split lines
+static void drawGateGrid(VSeq* a, uint8_t* fb) {
+    int stepWidth = kScreenWidth / a->dims.maxSteps;
+    int trackHeight = (kScreenHeight - kGateStartY) / a->dims.gateTracks;
     
-    a->lastClockIn = clockIn;
-    a->lastResetIn = resetIn;
+    // Draw page indicators at top - same as CV sequencers
+    // One line per sequencer page (each CV sequencer, then Gate)
+    int pageBarY = 4;
+    int pageBarWidth = kScreenWidth / a->numUiPages();
+    for (int i = 0; i < a->numUiPages(); i++) {
+        int barStartX = (i * pageBarWidth) + 4;
+        int barEndX = ((i + 1) * pageBarWidth) - 4;
+        int brightness = (i == a->selectedSeq) ? 255 : 80;  // Bright if current page, dim otherwise
+        fillRect(fb, barStartX, pageBarY, barEndX, pageBarY, brightness);
+    }
     
-    // Process each CV sequencer (3 total)
-    for (int seq = 0; seq < 3; seq++) {
-        int dirParam = kParamSeq1Direction + (seq * 6);
-        int stepParam = kParamSeq1StepCount + (seq * 6);
-        int splitParam = kParamSeq1SplitPoint + (seq * 6);
-        int sec1Param = kParamSeq1Section1Reps + (seq * 6);
-        int sec2Param = kParamSeq1Section2Reps + (seq * 6);
+    for (int track = 0; track < a->dims.gateTracks; track++) {
+        int y = kGateStartY + (track * trackHeight);
+        const TrackState& t = a->tracks[a->dims.cvSeqs + track];
+        int trackLength = t.length;
+        int splitPoint = t.split;
         
-        int direction = self->v[dirParam];  // 0=Forward, 1=Backward, 2=Pingpong
-        int stepCount = self->v[stepParam]; // 1-32
-        int splitPoint = self->v[splitParam]; // 1-31
-        int sec1Reps = self->v[sec1Param];  // 1-99
-        int sec2Reps = self->v[sec2Param];  // 1-99
-        
-        // Reset handling
-        if (resetTrig) {
-            a->resetSequencer(seq);
+        // Highlight selected track with a line on the left
+        if (track == a->selectedTrack) {
+            fillRect(fb, 0, y, 1, y + trackHeight - 1, 255);
         }
         
-        // Clock handling - advance one step per clock
-        if (clockTrig) {
-            a->advanceSequencer(seq, direction, stepCount, splitPoint, sec1Reps, sec2Reps);
+        // Draw split point line if active
+        if (splitPoint > 0 && splitPoint < trackLength) {
+            int splitX = splitPoint * stepWidth;
+            fillRect(fb, splitX, y, splitX, y + trackHeight - 1, 200);
         }
-        
-        // Clamp current step to step count (safety check)
-        if (a->currentStep[seq] >= stepCount) {
-            a->currentStep[seq] = stepCount - 1;
+    }
+}
+
+// Repaint one gate step cell over the grid
+static void drawGateCell(VSeq* a, uint8_t* fb, int track, int step, uint32_t state) {
+    int stepWidth = kScreenWidth / a->dims.maxSteps;
+    int trackHeight = (kScreenHeight - kGateStartY) / a->dims.gateTracks;
+    int centerX = (step * stepWidth) + (stepWidth / 2);
+    int centerY = kGateStartY + (track * trackHeight) + (trackHeight / 2);
+    int x = centerX - (kSpriteSize / 2);
+    int y = centerY - (kSpriteSize / 2);
+    copyRect(fb, a->background, x, y, x + kSpriteSize - 1, y + kSpriteSize - 1);
+    if (state == 0) return;
+    
+    // Gate state (0=off, 1=normal, 2=accent), then the playhead box and the selection frame
+    static const int gateSprites[3] = { kSpriteOff, kSpriteNormal, kSpriteAccent };
+    int gateState = (state >> 1) & 0x3;
+    blitSprite(fb, gateSprites[gateState < 3 ? gateState : 1], x, y);
+    if (state & kGateCellPlaying) blitSprite(fb, kSpritePlayhead, x, y);
+    if (state & kGateCellSelected) blitSprite(fb, kSpriteSelection, x, y);
+}
+
+// Bring the instance's retained frame up to date: the static grid is rebuilt only after a
+// parameter or page change, and otherwise just the step cells whose contents changed are repainted
+static void updateFrame(VSeq* a) {
+    int seq = a->selectedSeq;  // CV sequencer, or cvSeqs for gate
+    bool gatePage = (seq == a->dims.cvSeqs);
+    
+    if (a->gridDirty || seq != a->drawnSeq || (gatePage && a->selectedTrack != a->drawnTrack)) {
+        memset(a->background, 0, kScreenBytes);
+        if (gatePage) {
+            drawGateGrid(a, a->background);
+        } else {
+            drawCvGrid(a, a->background);
         }
-        
-        // Output current step values to all output buses
-        int step = a->currentStep[seq];
-        for (int out = 0; out < 3; out++) {
-            int paramIdx = kParamSeq1Out1 + (seq * 3) + out;
-            int outputBus = self->v[paramIdx];  // 0 = none, 1-28 = bus 0-27
-            
-            // Store actual bus assignment for debug
-            int debugIdx = seq * 3 + out;
-            a->debugOutputBus[debugIdx] = outputBus;  // Store as 0-28
-            
-            if (outputBus > 0 && outputBus <= 28) {
-                int16_t value = a->stepValues[seq][step][out];
-                // Convert from int16_t range to 0.0-1.0
-                float outputValue = (value + 32768) / 65535.0f;
-                
-                // Write to all frames in the output bus
-                float* outBus = busFrames + ((outputBus - 1) * numFrames);
-                for (int frame = 0; frame < numFrames; frame++) {
-                    outBus[frame] = outputValue;
-                }
-            }
-            
-            // Send MIDI note if channel is configured and clock just triggered
-            if (clockTrig) {
-                int midiParam = kParamSeq1Midi1 + (seq * 3) + out;
-                int midiChannel = self->v[midiParam];  // 0 = off, 1-16 = MIDI channels
-                
-                if (midiChannel > 0 && midiChannel <= 16) {
-                    // Convert CV value to MIDI note (0-127)
-                    int16_t value = a->stepValues[seq][step][out];
-                    float normalized = (value + 32768) / 65535.0f;  // 0.0-1.0
-                    uint8_t midiNote = (uint8_t)(normalized * 127.0f);
-                    if (midiNote > 127) midiNote = 127;
-                    
-                    // Get velocity source parameter
-                    int velocitySourceParam = kParamSeq1MidiVelocity + seq;
-                    int velocitySource = self->v[velocitySourceParam];  // 0=Off, 1=Out1, 2=Out2, 3=Out3
-                    
-                    uint8_t velocity = 100;  // Default fixed velocity
-                    if (velocitySource > 0 && velocitySource <= 3) {
-                        // Use the selected output value as velocity
-                        int velocityOutIdx = velocitySource - 1;  // 0-2
-                        int16_t velocityValue = a->stepValues[seq][step][velocityOutIdx];
-                        float velocityNorm = (velocityValue + 32768) / 65535.0f;  // 0.0-1.0
-                        velocity = (uint8_t)(velocityNorm * 127.0f);
-                        if (velocity > 127) velocity = 127;
-                    }
-                    
-                    uint8_t channel = (midiChannel - 1) & 0x0F;
-                    
-                    // Send note on
-                    NT_sendMidi3ByteMessage(
-                        kNT_destinationInternal,
-                        0x90 | channel,  // Note On
-                        midiNote,
-                        velocity
-                    );
-                }
-            }
+        memcpy(a->frame, a->background, kScreenBytes);
+        int numCells = (a->dims.gateTracks > 1 ? a->dims.gateTracks : 1) * a->dims.maxSteps;
+        for (int i = 0; i < numCells; i++) {
+            a->shownCells[i] = kCellUnknown;
         }
+        a->gridDirty = false;
+        a->drawnSeq = seq;
+        a->drawnTrack = a->selectedTrack;
     }
     
-    // Process gate sequencer (6 tracks)
-    for (int track = 0; track < 6; track++) {
-        int outParam = kParamGate1Out + (track * 2);   // Gate outputs are now paired with CC params
-        int runParam = kParamGate1Run + (track * 9);   // 9 params per track now
-        int lenParam = kParamGate1Length + (track * 9);
-        int dirParam = kParamGate1Direction + (track * 9);
-        int splitParam = kParamGate1SplitPoint + (track * 9);
-        int sec1Param = kParamGate1Section1Reps + (track * 9);
-        int sec2Param = kParamGate1Section2Reps + (track * 9);
-        int fillParam = kParamGate1FillStart + (track * 9);
-        
-        int outputBus = self->v[outParam];     // 0 = none, 1-28 = bus 0-27
-        int isRunning = self->v[runParam];     // 0 = stopped, 1 = running
-        int trackLength = self->v[lenParam];   // 1-32
-        int direction = self->v[dirParam];     // 0=Forward, 1=Backward, 2=Pingpong
-        int splitPoint = self->v[splitParam];  // 0-31 (0 = no split)
-        int sec1Reps = self->v[sec1Param];     // 1-99
-        int sec2Reps = self->v[sec2Param];     // 1-99
-        int fillStart = self->v[fillParam];    // 1-32 (step where fill replaces section 1 on last rep)
-        
-        // Skip sequencer advancement if not running
-        if (isRunning == 0) continue;
-        
-        // Reset handling
-        if (resetTrig) {
-            a->gateCurrentStep[track] = 0;
-            a->gatePingpongForward[track] = true;
-            a->gateSwingCounter[track] = 0;
-            a->gateSection1Counter[track] = 0;
-            a->gateSection2Counter[track] = 0;
-            a->gateInSection2[track] = false;
-            a->gateInFill[track] = false;
-        }
-        
-        // Clock handling - advance one step per clock
-        if (clockTrig) {
-            a->advanceGateSequencer(track, direction, trackLength, splitPoint, sec1Reps, sec2Reps, fillStart);
-            
-            // After advancing, mark if current step should trigger
-            int currentStep = a->gateCurrentStep[track];
-            uint8_t stepState = (currentStep >= 0 && currentStep < 32) ? a->gateSteps[track][currentStep] : 0;
-            
-            if (stepState > 0) {
-                // Gate is active on this step - trigger!
-                a->gateTriggerCounter[track] = 240;  // ~5ms at 48kHz
-                
-                // Send MIDI CC if configured
-                int triggerMidiChannel = self->v[kParamTriggerMidiChannel];  // 0 = off, 1-16 = MIDI channels
-                
-                if (triggerMidiChannel > 0 && triggerMidiChannel <= 16) {
-                    int ccParam = kParamGate1CC + (track * 2);
-                    int ccNumber = self->v[ccParam];  // 0-127
-                    
-                    // Get velocity based on step state (1=normal, 2=accent)
-                    uint8_t velocity;
-                    if (stepState == 2) {
-                        velocity = self->v[kParamTriggerMasterAccent];  // Accent velocity (0-127)
-                    } else {
-                        velocity = self->v[kParamTriggerMasterVelocity];  // Normal velocity (0-127)
-                    }
-                    
-                    uint8_t channel = (triggerMidiChannel - 1) & 0x0F;
-                    
-                    // Send CC with velocity
-                    NT_sendMidi3ByteMessage(
-                        kNT_destinationInternal,
-                        0xB0 | channel, // CC message on configured channel
-                        ccNumber,       // CC number
-                        velocity        // CC value based on step state
-                    );
+    if (gatePage) {
+        for (int track = 0; track < a->dims.gateTracks; track++) {
+            int trackLength = a->tracks[a->dims.cvSeqs + track].length;
+            for (int step = 0; step < a->dims.maxSteps; step++) {
+                uint32_t state = gateCellState(a, track, step, trackLength);
+                uint32_t& shown = a->shownCells[(track * a->dims.maxSteps) + step];
+                if (state != shown) {
+                    drawGateCell(a, a->frame, track, step, state);
+                    shown = state;
                 }
             }
         }
-        
-        // Countdown trigger pulses every buffer
-        if (a->gateTriggerCounter[track] > 0) {
-            a->gateTriggerCounter[track] -= numFrames;  // Countdown by buffer size
-            if (a->gateTriggerCounter[track] < 0) {
-                a->gateTriggerCounter[track] = 0;
+    } else {
+        // The rows of a column share pixels (the top row's underline and the bottom row's step
+        // indicator), so a column repaints as a whole
+        int stepCount = a->tracks[seq].length;
+        int numRows = (a->dims.maxSteps + 15) / 16;
+        int barsWidth = cvBarsWidth(a);
+        for (int col = 0; col < 16 && col < a->dims.maxSteps; col++) {
+            uint32_t states[2];
+            bool changed = false;
+            for (int row = 0; row < numRows; row++) {
+                int step = col + (row * 16);
+                if (step >= a->dims.maxSteps) break;
+                states[row] = cvCellState(a, seq, step, stepCount);
+                changed |= (states[row] != a->shownCells[step]);
             }
-        }
-        
-        // Output trigger pulse
-        if (outputBus > 0 && outputBus <= 28) {
-            bool triggerActive = a->gateTriggerCounter[track] > 0;
+            if (!changed) continue;
             
-            // Write to all frames in the output bus
-            float* outBus = busFrames + ((outputBus - 1) * numFrames);
-            for (int frame = 0; frame < numFrames; frame++) {
-                outBus[frame] = triggerActive ? 5.0f : 0.0f;  // 5V trigger
+            int x = col * (barsWidth + kCvStepGap);
+            int bottomY = kCvStartY + ((numRows - 1) * kCvRowHeight) + kCvMaxBarHeight + 2;
+            copyRect(a->frame, a->background, x, kCvStartY - 3, x + barsWidth - 1, bottomY);
+            for (int row = 0; row < numRows; row++) {
+                int step = col + (row * 16);
+                if (step >= a->dims.maxSteps) break;
+                drawCvCell(a, a->frame, step, states[row]);
+                a->shownCells[step] = states[row];
             }
         }
     }
 }
 
-bool draw(_NT_algorithm* self) {
-    VSeq* a = (VSeq*)self;
+// Copy the retained frame to the screen and add the title text
+static void presentFrame(VSeq* a) {
+    memcpy(NT_screen, a->frame, kScreenBytes);
     
-    // Clear screen
-    NT_drawShapeI(kNT_rectangle, 0, 0, 256, 64, 0);  // Black background
+    // Playing pattern bank, and the one a switch is waiting for
+    if (a->dims.banks > 1) {
+        char bankInfo[40];
+        int pending = a->pendingBank;
+        if (pending >= 0) {
+            // The lead track's plan tells how many ticks until the switch, when that is close
+            int boundary = (a->bankSwitchMode == kBankSwitchLoop) ? kCrossLoop : kCrossSection;
+            int ticks = a->tracks[0].plan.ticksUntil(boundary);
+            if (ticks > 0 && a->haveLastEdge) {
+                snprintf(bankInfo, sizeof(bankInfo), "P%d>%d %d", a->activeBank() + 1, pending + 1, ticks);
+            } else {
+                snprintf(bankInfo, sizeof(bankInfo), "P%d>%d", a->activeBank() + 1, pending + 1);
+            }
+        } else {
+            snprintf(bankInfo, sizeof(bankInfo), "P%d", a->activeBank() + 1);
+        }
+        NT_drawText(200, 0, bankInfo, pending >= 0 ? 255 : 100);
+    }
     
-    int seq = a->selectedSeq;  // 0-2 for CV, 3 for gate
+    // Recording: a dot left of the pattern number
+    if (a->recording) {
+        fillRect(NT_screen, 192, 1, 195, 4, 255);
+    }
     
-    // If seq 3 (4th sequencer), draw gate sequencer instead
-    if (seq == 3) {
+    if (a->selectedSeq == a->dims.cvSeqs) {
         // Show track and step info
         char info[32];
         snprintf(info, sizeof(info), "T%d S%d", a->selectedTrack + 1, a->selectedStep + 1);
         NT_drawText(0, 0, info, 255);
         
         // Show gate state for current selection
-        bool currentGateState = a->gateSteps[a->selectedTrack][a->selectedStep];
+        uint8_t currentStep = a->gateStep(a->selectedTrack, a->selectedStep);
+        bool currentGateState = gateState(currentStep) != 0;
         NT_drawText(60, 0, currentGateState ? "ON" : "off", currentGateState ? 255 : 100);
         
-        // Draw page indicators at top - same as CV sequencers
-        // 4 lines representing the 4 sequencer pages (CV1, CV2, CV3, Gate)
-        int pageBarY = 4;
-        int pageBarWidth = 64;  // 256px / 4 = 64px per sequencer
-        for (int i = 0; i < 4; i++) {
-            int barStartX = (i * pageBarWidth) + 4;
-            int barEndX = ((i + 1) * pageBarWidth) - 4;
-            int brightness = (i == seq) ? 255 : 80;  // Bright if current page, dim otherwise
-            NT_drawShapeI(kNT_line, barStartX, pageBarY, barEndX, pageBarY, brightness);
+        // Ratchets and chance, when the step has them
+        if (currentStep & ~kGateStateMask) {
+            char extra[16];
+            snprintf(extra, sizeof(extra), "R%d %d%%", gateRatchets(currentStep),
+                     gateChance(currentStep) * 100 / kChanceLevels);
+            NT_drawText(90, 0, extra, currentGateState ? 255 : 100);
         }
         
-        // 6 tracks × 32 steps
-        // Screen: 256px wide, 64px tall
-        // Step size: 256/32 = 8px per step
-        // Track height: (64-8)/6 = ~9px per track (leave 8px for title)
-        
-        int stepWidth = 8;
-        int trackHeight = 9;
-        int startY = 8;
-        
-        for (int track = 0; track < 6; track++) {
-            int y = startY + (track * trackHeight);
-            
-            // Get track parameters (now 9 params per track, not 10)
-            int lenParam = kParamGate1Length + (track * 9);
-            int splitParam = kParamGate1SplitPoint + (track * 9);
-            int trackLength = self->v[lenParam];
-            int splitPoint = self->v[splitParam];
-            int currentStep = a->gateCurrentStep[track];
-            
-            // Highlight selected track with a line on the left
-            if (track == a->selectedTrack) {
-                NT_drawShapeI(kNT_line, 0, y, 0, y + trackHeight - 1, 255);
-                NT_drawShapeI(kNT_line, 1, y, 1, y + trackHeight - 1, 255);
-            }
-            
-            // Draw split point line if active
-            if (splitPoint > 0 && splitPoint < trackLength) {
-                int splitX = splitPoint * stepWidth;
-                NT_drawShapeI(kNT_line, splitX, y, splitX, y + trackHeight - 1, 200);
-            }
-            
-            for (int step = 0; step < 32; step++) {
-                int x = step * stepWidth;
-                
-                // Determine if this step is active (within track length)
-                bool isActive = (step < trackLength);
-                
-                // Only draw steps that are within the track length
-                if (!isActive) continue;  // Skip inactive steps entirely
-                
-                // Get gate state for this track/step (0=off, 1=normal, 2=accent)
-                uint8_t gateState = a->gateSteps[track][step];
-                
-                // Calculate center position
-                int centerX = x + (stepWidth / 2);
-                int centerY = y + (trackHeight / 2);
-                
-                // Draw based on gate state
-                if (gateState == 2) {
-                    // Accent: draw filled 7x7 diamond
-                    NT_drawShapeI(kNT_line, centerX, centerY - 3, centerX + 3, centerY, 255);     // Top-right
-                    NT_drawShapeI(kNT_line, centerX + 3, centerY, centerX, centerY + 3, 255);     // Bottom-right
-                    NT_drawShapeI(kNT_line, centerX, centerY + 3, centerX - 3, centerY, 255);     // Bottom-left
-                    NT_drawShapeI(kNT_line, centerX - 3, centerY, centerX, centerY - 3, 255);     // Top-left
-                    // Fill diamond interior
-                    NT_drawShapeI(kNT_line, centerX, centerY - 2, centerX + 2, centerY, 255);
-                    NT_drawShapeI(kNT_line, centerX + 2, centerY, centerX, centerY + 2, 255);
-                    NT_drawShapeI(kNT_line, centerX, centerY + 2, centerX - 2, centerY, 255);
-                    NT_drawShapeI(kNT_line, centerX - 2, centerY, centerX, centerY - 2, 255);
-                    NT_drawShapeI(kNT_line, centerX - 1, centerY, centerX + 1, centerY, 255);     // Center horizontal
-                    NT_drawShapeI(kNT_line, centerX, centerY - 1, centerX, centerY + 1, 255);     // Center vertical
-                } else if (gateState == 1) {
-                    // Normal: draw filled 5x5 square
-                    NT_drawShapeI(kNT_rectangle, centerX - 2, centerY - 2, centerX + 2, centerY + 2, 255);
-                } else {
-                    // Off: just draw center pixel
-                    NT_drawShapeI(kNT_rectangle, centerX, centerY, centerX, centerY, 255);
-                }
-                
-                // Draw small box below the current playing step
-                if (step == currentStep) {
-                    NT_drawShapeI(kNT_rectangle, centerX, centerY + 3, centerX + 1, centerY + 3, 255);
-                }
-                
-                // Highlight selected step (for editing)
-                if (step == a->selectedStep && track == a->selectedTrack) {
-                    NT_drawShapeI(kNT_line, centerX - 3, centerY - 3, centerX + 3, centerY - 3, 200);  // Top
-                    NT_drawShapeI(kNT_line, centerX - 3, centerY + 3, centerX + 3, centerY + 3, 200);  // Bottom
-                    NT_drawShapeI(kNT_line, centerX - 3, centerY - 3, centerX - 3, centerY + 3, 200);  // Left
-                    NT_drawShapeI(kNT_line, centerX + 3, centerY - 3, centerX + 3, centerY + 3, 200);  // Right
-                }
+        // The selected track's generator
+        const TrackState& t = a->tracks[a->dims.cvSeqs + a->selectedTrack];
+        if (t.generator != kGeneratorOff) {
+            char gen[16];
+            if (t.generator == kGeneratorEuclidean) {
+                snprintf(gen, sizeof(gen), "E%d/%d", t.hits < t.length ? t.hits : t.length, t.length);
+            } else {
+                snprintf(gen, sizeof(gen), "RND %d%%", t.density);
             }
+            NT_drawText(140, 0, gen, 100);
         }
-        
-        return true;  // Suppress default parameter drawing
-    }
-    
-    // Original CV sequencer view for seq 0-2
-    // Get parameters for current sequencer
-    int stepParam = kParamSeq1StepCount + (seq * 6);
-    int splitParam = kParamSeq1SplitPoint + (seq * 6);
-    int stepCount = self->v[stepParam];
-    int splitPoint = self->v[splitParam];
-    
-    // Draw step view
-    char title[16];
-    snprintf(title, sizeof(title), "SEQ %d", seq + 1);
-    NT_drawText(0, 0, title, 255);
-    
-    // Draw 32 steps in 2 rows of 16
-    // Each step gets 3 skinny bars for 3 outputs
-    // Screen is 256 wide, divided into 2 rows of 16 steps
-    
-    int barWidth = 3;   // Width of each bar
-    int barSpacing = 1; // Space between bars within a step
-    int barsWidth = (3 * barWidth) + (2 * barSpacing);  // Width of 3 bars: 3*3 + 2*1 = 11
-    int stepGap = 4;    // Gap after each step (reduced to make room for dots)
-    int stepWidth = barsWidth + stepGap;  // Total width per step: 11 + 4 = 15
-    int startY = 10;    // Start below title
-    int rowHeight = 26; // Height of each row
-    int maxBarHeight = 22; // Maximum bar height
-    
-    for (int step = 0; step < 32; step++) {
-        int row = step / 16;     // 0 or 1
-        int col = step % 16;     // 0-15
-        
-        int x = col * stepWidth;
-        int y = startY + (row * rowHeight);
-        
-        // Determine if this step is active
-        bool isActive = (step < stepCount);
-        int brightness = isActive ? 255 : 40;  // Dim inactive steps
-        
-        // Draw 3 vertical bars for this step
-        for (int out = 0; out < 3; out++) {
-            int16_t value = a->stepValues[seq][step][out];
-            // Convert int16_t (-32768 to 32767) to 0.0-1.0
-            float normalized = (value + 32768.0f) / 65535.0f;
-            // Convert to bar height (1 to maxBarHeight pixels)
-            int barHeight = (int)(normalized * maxBarHeight);
-            if (barHeight < 1) barHeight = 1;
-            
-            int barX = x + (out * (barWidth + barSpacing));
-            int barBottomY = y + maxBarHeight;
-            int barTopY = barBottomY - barHeight;
-            
-            // Draw bar (filled rectangle from top to bottom)
-            NT_drawShapeI(kNT_rectangle, barX, barTopY, barX + barWidth - 1, barBottomY, brightness);
-        }
-        
-        // Draw step indicator dot if this is the current step
-        if (step == a->currentStep[seq]) {
-            // Draw more visible indicator above the step (2x2 box)
-            int dotX = x + (barWidth + barSpacing);  // Above middle bar
-            NT_drawShapeI(kNT_rectangle, dotX, y - 3, dotX + barWidth - 1, y - 2, 255);
-            NT_drawShapeI(kNT_rectangle, dotX, y - 2, dotX + barWidth - 1, y - 1, 255);
-        }
-        
-        // Draw selection underline if this is the selected step
-        if (step == a->selectedStep) {
-            NT_drawShapeI(kNT_line, x, y + maxBarHeight + 2, x + barsWidth - 1, y + maxBarHeight + 2, 255);
+    } else {
+        char title[16];
+        snprintf(title, sizeof(title), "SEQ %d", a->selectedSeq + 1);
+        NT_drawText(0, 0, title, 255);
+        if (a->active->glides[a->selectedSeq] & (1u << a->selectedStep)) {
+            NT_drawText(50, 0, "GLIDE", 100);
         }
         
-        // Draw percentage dots in the gap between steps
-        if (col < 15) {  // Don't draw after the last step in each row
-            int dotX = x + barsWidth + 2;  // Start of gap area (moved 1px right)
-            // 4 dots at 25%, 50%, 75%, 100% of bar height
-            int dot25Y = y + maxBarHeight - (maxBarHeight / 4);
-            int dot50Y = y + maxBarHeight - (maxBarHeight / 2);
-            int dot75Y = y + maxBarHeight - (3 * maxBarHeight / 4);
-            int dot100Y = y;
-            
-            NT_drawShapeI(kNT_rectangle, dotX, dot25Y, dotX, dot25Y, 128);
-            NT_drawShapeI(kNT_rectangle, dotX, dot50Y, dotX, dot50Y, 128);
-            NT_drawShapeI(kNT_rectangle, dotX, dot75Y, dotX, dot75Y, 128);
-            NT_drawShapeI(kNT_rectangle, dotX, dot100Y, dotX, dot100Y, 128);
+        // The next section boundary, when sections are on and it is within the plan
+        const TrackPlan& plan = a->tracks[a->selectedSeq].plan;
+        int ticks = plan.ticksUntil(kCrossSection);
+        if (ticks > 0 && a->stepTables[a->selectedSeq].section2Start < a->dims.maxSteps) {
+            char next[24];
+            snprintf(next, sizeof(next), "S%d in %d", (plan.ahead(ticks).flags & kPlanSection2) ? 2 : 1, ticks);
+            NT_drawText(100, 0, next, 100);
         }
         
-        // Draw triangle between last step of first section and first step of second section
-        if (step == (splitPoint - 1) && splitPoint > 0 && splitPoint < stepCount) {
-            int boxX = x + barsWidth + 1;  // In the gap after this step
-            int boxY = y + maxBarHeight + 3;  // Below the bars
-            // Draw small 2x2 box
-            NT_drawShapeI(kNT_rectangle, boxX, boxY, boxX + 1, boxY + 1, 255);
-        }
+        // Draw current step number in top right corner
+        char stepNum[12];
+        snprintf(stepNum, sizeof(stepNum), "%d", a->selectedStep + 1);
+        NT_drawText(248, 0, stepNum, 255);
     }
+}
+
+#ifdef VSEQ_PROFILE
+// The diagnostics page: min/avg/max cycles of each profiled stage over its recent calls
+static void drawDiagnostics(VSeq* a) {
+    static const char* const stageNames[kNumProfileStages] = {
+        "step", "edits", "scan", "advance", "output", "midi", "draw"
+    };
     
-    // Draw short separator lines at top and bottom of screen between groups of 4 steps
-    // Between steps 4-5, 8-9, 12-13
-    int separatorY1 = 0;  // Very top of screen
-    int separatorY2 = 63; // Very bottom of screen
-    int x1 = 4 * stepWidth - (stepGap / 2);
-    int x2 = 8 * stepWidth - (stepGap / 2);
-    int x3 = 12 * stepWidth - (stepGap / 2);
-    
-    NT_drawShapeI(kNT_line, x1, separatorY1, x1, separatorY1 + 3, 128);
-    NT_drawShapeI(kNT_line, x1, separatorY2 - 3, x1, separatorY2, 128);
-    NT_drawShapeI(kNT_line, x2, separatorY1, x2, separatorY1 + 3, 128);
-    NT_drawShapeI(kNT_line, x2, separatorY2 - 3, x2, separatorY2, 128);
-    NT_drawShapeI(kNT_line, x3, separatorY1, x3, separatorY1 + 3, 128);
-    NT_drawShapeI(kNT_line, x3, separatorY2 - 3, x3, separatorY2, 128);
+    memset(NT_screen, 0, kScreenBytes);
+    NT_drawText(0, 7, "CYCLES", 255, kNT_textLeft, kNT_textTiny);
+    NT_drawText(100, 7, "min", 100, kNT_textRight, kNT_textTiny);
+    NT_drawText(160, 7, "avg", 100, kNT_textRight, kNT_textTiny);
+    NT_drawText(220, 7, "max", 100, kNT_textRight, kNT_textTiny);
+    for (int stage = 0; stage < kNumProfileStages; stage++) {
+        uint32_t min, avg, max;
+        a->profile[stage].summarise(min, avg, max);
+        int y = 15 + (stage * 8);
+        char text[12];
+        NT_drawText(0, y, stageNames[stage], 255, kNT_textLeft, kNT_textTiny);
+        snprintf(text, sizeof(text), "%lu", (unsigned long)min);
+        NT_drawText(100, y, text, 200, kNT_textRight, kNT_textTiny);
+        snprintf(text, sizeof(text), "%lu", (unsigned long)avg);
+        NT_drawText(160, y, text, 255, kNT_textRight, kNT_textTiny);
+        snprintf(text, sizeof(text), "%lu", (unsigned long)max);
+        NT_drawText(220, y, text, 200, kNT_textRight, kNT_textTiny);
+    }
+}
+#endif
+
+bool draw(_NT_algorithm* self) {
+    VSeq* a = (VSeq*)self;
+    uint32_t mark = readCycles();
     
-    // Draw page indicators at the very top (above step view)
-    // 4 bars representing 4 sequencers, centered above groups of 4 steps
-    int pageBarY = 4;  // Just below the top separator lines
-    int groupWidth = 4 * stepWidth;  // Width of 4 steps including gaps
-    for (int i = 0; i < 4; i++) {
-        int barStartX = (i * groupWidth) + (stepGap / 2);
-        int barEndX = ((i + 1) * groupWidth) - (stepGap / 2) - stepGap;
-        int brightness = (i == seq) ? 255 : 80;  // Bright if active, dim otherwise
-        NT_drawShapeI(kNT_line, barStartX, pageBarY, barEndX, pageBarY, brightness);
+#ifdef VSEQ_PROFILE
+    if (a->onDiagnosticsPage()) {
+        drawDiagnostics(a);
+        a->drawnEditGeneration = a->editGeneration - 1;   // The next frame draws over the page
+        return true;
     }
+#endif
     
-    // Draw current step number in top right corner
-    char stepNum[4];
-    snprintf(stepNum, sizeof(stepNum), "%d", a->selectedStep + 1);
-    NT_drawText(248, 0, stepNum, 255);
+    // Only draw after an edit (queued or applied), or when a playhead moved and its rate limit allows.
+    // Otherwise the screen still shows the last frame: the title text only changes with those
+    // generations too (parameters, selection, bank switches and recording all count as edits).
+    uint32_t edits = a->editGeneration;
+    uint32_t applied = a->appliedGeneration;
+    uint32_t playheads = a->playheadGeneration;
+    bool edited = (edits != a->drawnEditGeneration) || (applied != a->drawnAppliedGeneration);
+    bool moved = (playheads != a->drawnPlayheadGeneration) &&
+                 (a->sampleTime - a->playheadDrawTime) >= a->playheadInterval;
+    if (!edited && !moved) {
+        profileAdd(a, kProfileDraw, profileLap(mark));
+        return true;
+    }
+    a->drawnEditGeneration = edits;
+    a->drawnAppliedGeneration = applied;
+    a->drawnPlayheadGeneration = playheads;
+    a->playheadDrawTime = a->sampleTime;
+    updateFrame(a);
     
+    presentFrame(a);
+    profileAdd(a, kProfileDraw, profileLap(mark));
     return true;  // Suppress default parameter line
 }
 
-uint32_t hasCustomUi(_NT_algorithm* self) {
+uint32_t hasCustomUi(_NT_algorithm*) {
     return kNT_potL | kNT_potC | kNT_potR | kNT_encoderL | kNT_encoderR | kNT_encoderButtonR | kNT_button4;
 }
 
-void customUi(_NT_algorithm* self, const _NT_uiData& data) {
+// Map a pot to one of 'levels' evenly spaced positions once it has caught the current level.
+// Returns the new level, or -1 while uncaught or unchanged.
+static int catchLevelPot(bool& caught, float potValue, int current, int levels) {
+    float last = (float)(levels - 1);
+    if (!caught && fabsf(potValue - current / last) < 0.5f / last) caught = true;
+    if (!caught) return -1;
+    int level = (int)(potValue * last + 0.5f);
+    if (level < 0) level = 0;
+    if (level > levels - 1) level = levels - 1;
+    return (level != current) ? level : -1;
+}
+
+static void handleControls(_NT_algorithm* self, const _NT_uiData& data) {
     VSeq* a = (VSeq*)self;
+    const ParamLayout& P = a->layout;
     
-    // Left encoder: select sequencer (0-2 for CV, 3 for gate)
+    // The pots must catch the values again after the pattern bank changes
+    if (a->active != a->editedBank) {
+        a->editedBank = a->active;
+        for (int i = 0; i < kMaxOuts; i++) {
+            a->potCaught[i] = false;
+        }
+    }
+    
+    // Left encoder: select sequencer (CV sequencers, then gate)
     if (data.encoders[0] != 0) {
         int delta = data.encoders[0];
         int oldSeq = a->selectedSeq;
         a->selectedSeq += delta;
-        // Clamp to 0-3 range (no wraparound)
+        // Clamp to the sequencer range (no wraparound)
         if (a->selectedSeq < 0) a->selectedSeq = 0;
-        if (a->selectedSeq > 3) a->selectedSeq = 3;
+        if (a->selectedSeq >= a->numUiPages() + kDiagnosticsPages) {
+            a->selectedSeq = a->numUiPages() + kDiagnosticsPages - 1;
+        }
         
         // If sequencer changed, clamp selectedStep to new sequencer's length
-        if (a->selectedSeq != oldSeq) {
+        if (a->selectedSeq != oldSeq && !a->onDiagnosticsPage()) {
+            a->editGeneration++;
+            
             // Determine new sequencer's length
             int newLength;
-            if (a->selectedSeq == 3) {
-                // Gate sequencer - get current track's length (9 params per track now)
-                int lenParam = kParamGate1Length + (a->selectedTrack * 9);
-                newLength = self->v[lenParam];
-                // Reset track pot catch when entering gate sequencer
+            if (a->selectedSeq == a->dims.cvSeqs) {
+                // Gate sequencer - get current track's length
+                newLength = self->v[P.gateParam(a->selectedTrack, kGateLength)];
+                // Reset track, ratchet and chance pot catch when entering gate sequencer
                 a->trackPotCaught = false;
+                a->potCaught[1] = false;
+                a->potCaught[2] = false;
             } else {
                 // CV sequencer - get step count
-                int lengthParam;
-                if (a->selectedSeq == 0) lengthParam = kParamSeq1StepCount;
-                else if (a->selectedSeq == 1) lengthParam = kParamSeq2StepCount;
-                else lengthParam = kParamSeq3StepCount;
-                newLength = self->v[lengthParam];
+                newLength = self->v[P.seqParam(a->selectedSeq, kSeqStepCount)];
             }
             
             // Clamp selectedStep to new length
             if (a->selectedStep >= newLength) {
                 a->selectedStep = newLength - 1;
             }
+        } else if (a->selectedSeq != oldSeq) {
+            a->editGeneration++;
         }
     }
     
-    // Gate sequencer mode (seq 3)
-    if (a->selectedSeq == 3) {
-        // Left pot: select track (0-5) with catch behavior
-        // Each track has a virtual position: track 0 = 0%, track 1 = 20%, ..., track 5 = 100%
+    // The diagnostics page only pages back
+    if (a->onDiagnosticsPage()) return;
+    
+    // Gate sequencer mode
+    if (a->selectedSeq == a->dims.cvSeqs) {
+        // Left pot: select track with catch behavior
+        // Each track has a virtual position spread evenly over the pot: with 6 tracks,
+        // track 0 = 0%, track 1 = 20%, ..., track 5 = 100%
         // Pot must "catch" current track position before it can change tracks
-        if (data.controls & kNT_potL) {
+        if (a->dims.gateTracks > 1 && (data.controls & kNT_potL)) {
             float potValue = data.pots[0];
+            float lastTrack = (float)(a->dims.gateTracks - 1);
             
-            // Calculate virtual position for current track (0-5 maps to 0.0-1.0)
-            float trackPosition = a->selectedTrack / 5.0f;
+            // Calculate virtual position for current track (maps to 0.0-1.0)
+            float trackPosition = a->selectedTrack / lastTrack;
             
             // Check if pot has caught the track position (within 5% tolerance)
             if (!a->trackPotCaught) {
@@ -1496,23 +3705,22 @@ void customUi(_NT_algorithm* self, const _NT_uiData& data) {
             
             // Only allow track changes when caught
             if (a->trackPotCaught) {
-                // Map pot to track with hysteresis to prevent flickering
-                // 0.00-0.10 = track 0, 0.10-0.30 = track 1, etc.
-                int newTrack;
-                if (potValue < 0.10f) newTrack = 0;
-                else if (potValue < 0.30f) newTrack = 1;
-                else if (potValue < 0.50f) newTrack = 2;
-                else if (potValue < 0.70f) newTrack = 3;
-                else if (potValue < 0.90f) newTrack = 4;
-                else newTrack = 5;
+                // Map pot to the nearest track position
+                // With 6 tracks: 0.00-0.10 = track 0, 0.10-0.30 = track 1, etc.
+                int newTrack = (int)(potValue * lastTrack + 0.5f);
+                if (newTrack < 0) newTrack = 0;
+                if (newTrack > a->dims.gateTracks - 1) newTrack = a->dims.gateTracks - 1;
                 
                 // If track changed, update selection and reset catch
                 if (newTrack != a->selectedTrack) {
                     a->selectedTrack = newTrack;
+                    a->editGeneration++;
                     a->trackPotCaught = false;  // Must re-catch at new position
+                    a->potCaught[1] = false;
+                    a->potCaught[2] = false;
                     
-                    // Clamp selected step to new track's length (9 params per track now)
-                    int lenParam = kParamGate1Length + (a->selectedTrack * 9);
+                    // Clamp selected step to new track's length
+                    int lenParam = P.gateParam(a->selectedTrack, kGateLength);
                     if (a->selectedStep >= self->v[lenParam]) {
                         a->selectedStep = self->v[lenParam] - 1;
                     }
@@ -1520,9 +3728,8 @@ void customUi(_NT_algorithm* self, const _NT_uiData& data) {
             }
         }
         
-        // Get current track length for encoder bounds (9 params per track now)
-        int lenParam = kParamGate1Length + (a->selectedTrack * 9);
-        int trackLength = self->v[lenParam];  // 1-32
+        // Get current track length for encoder bounds
+        int trackLength = self->v[P.gateParam(a->selectedTrack, kGateLength)];  // 1 to maxSteps
         
         // Right encoder: select step (0 to trackLength-1)
         if (data.encoders[1] != 0) {
@@ -1532,19 +3739,46 @@ void customUi(_NT_algorithm* self, const _NT_uiData& data) {
             // Wrap around based on track length
             if (a->selectedStep < 0) a->selectedStep = trackLength - 1;
             if (a->selectedStep >= trackLength) a->selectedStep = 0;
+            a->editGeneration++;
+            a->potCaught[1] = false;
+            a->potCaught[2] = false;
+        }
+        
+        // Centre pot: ratchets (1-8), right pot: chance (100% down to 12.5%), both with catch behavior
+        uint8_t stepByte = a->gateSteps(a->selectedTrack)[a->selectedStep];
+        if (data.controls & kNT_potC) {
+            int level = catchLevelPot(a->potCaught[1], data.pots[1], gateRatchets(stepByte) - 1, kMaxRatchets);
+            if (level >= 0) {
+                StepEdit edit = { kEditGateRatchet, (uint8_t)a->activeBank(), (uint8_t)a->selectedTrack,
+                                  (uint8_t)a->selectedStep, 0, (int16_t)(level + 1) };
+                a->edits.push(edit);
+                a->editGeneration++;
+            }
+        }
+        if (data.controls & kNT_potR) {
+            int level = catchLevelPot(a->potCaught[2], data.pots[2], gateChance(stepByte) - 1, kChanceLevels);
+            if (level >= 0) {
+                StepEdit edit = { kEditGateChance, (uint8_t)a->activeBank(), (uint8_t)a->selectedTrack,
+                                  (uint8_t)a->selectedStep, 0, (int16_t)(kChanceLevels - 1 - level) };
+                a->edits.push(edit);
+                a->editGeneration++;
+            }
         }
         
         // Right encoder button: toggle gate (3-state: Off → Normal → Accent → Off)
         uint16_t currentEncoderRButton = data.controls & kNT_encoderButtonR;
         uint16_t lastEncoderRButton = a->lastEncoderRButton & kNT_encoderButtonR;
-        if (currentEncoderRButton && !lastEncoderRButton) {  // Rising edge
+        // Generated tracks have to be baked before their steps can be set
+        bool generated = a->tracks[a->dims.cvSeqs + a->selectedTrack].generator != kGeneratorOff;
+        if (currentEncoderRButton && !lastEncoderRButton && !generated) {  // Rising edge
             // Cycle through 3 states: 0 (off) → 1 (normal) → 2 (accent) → 0
-            int track = a->selectedTrack;
-            int step = a->selectedStep;
-            a->gateSteps[track][step] = (a->gateSteps[track][step] + 1) % 3;
+            StepEdit edit = { kEditGateCycle, (uint8_t)a->activeBank(), (uint8_t)a->selectedTrack,
+                              (uint8_t)a->selectedStep, 0, 0 };
+            a->edits.push(edit);
+            a->editGeneration++;
             
             // Force update by incrementing a counter to verify button is being pressed
-            a->selectedSeq = 3;  // Force redraw
+            a->selectedSeq = a->dims.cvSeqs;  // Force redraw
         }
         a->lastEncoderRButton = data.controls;
         
@@ -1558,16 +3792,11 @@ void customUi(_NT_algorithm* self, const _NT_uiData& data) {
         return;  // Skip CV sequencer controls
     }
     
-    // CV Sequencer mode (seq 0-2)
+    // CV Sequencer mode
     
     // Get current sequencer's length
     int seq = a->selectedSeq;
-    int lengthParam;
-    if (seq == 0) lengthParam = kParamSeq1StepCount;
-    else if (seq == 1) lengthParam = kParamSeq2StepCount;
-    else lengthParam = kParamSeq3StepCount;
-    
-    int seqLength = self->v[lengthParam];  // 1-32
+    int seqLength = self->v[P.seqParam(seq, kSeqStepCount)];  // 1 to maxSteps
     
     // Right encoder: select step (0 to seqLength-1)
     if (data.encoders[1] != 0) {
@@ -1577,20 +3806,27 @@ void customUi(_NT_algorithm* self, const _NT_uiData& data) {
         // Wrap around based on sequencer length
         if (a->selectedStep < 0) a->selectedStep = seqLength - 1;
         if (a->selectedStep >= seqLength) a->selectedStep = 0;
+        a->editGeneration++;
         
         // Reset pot catch state when step changes
-        a->potCaught[0] = false;
-        a->potCaught[1] = false;
-        a->potCaught[2] = false;
+        for (int i = 0; i < kMaxOuts; i++) {
+            a->potCaught[i] = false;
+        }
     }
     
-    // Button 4: (currently unused - previously was ratchet/repeat mode cycling)
+    // Button 4: toggle glide into the selected step
+    if ((data.controls & kNT_button4) && !(a->lastButton4State & kNT_button4)) {
+        StepEdit edit = { kEditCvGlide, (uint8_t)a->activeBank(), (uint8_t)a->selectedSeq,
+                          (uint8_t)a->selectedStep, 0, 0 };
+        a->edits.push(edit);
+        a->editGeneration++;
+    }
     a->lastButton4State = data.controls;
     
     // Pots control the 3 values for the selected step with catch logic
     if (data.controls & kNT_potL) {
         float potValue = data.pots[0];
-        int16_t currentValue = a->stepValues[a->selectedSeq][a->selectedStep][0];
+        int16_t currentValue = a->stepValues(a->selectedSeq, a->selectedStep)[0];
         float currentNormalized = (currentValue + 32768) / 65535.0f;
         
         // Check if pot has caught the current value (within 2% tolerance)
@@ -1602,13 +3838,17 @@ void customUi(_NT_algorithm* self, const _NT_uiData& data) {
         
         // Only update if caught
         if (a->potCaught[0]) {
-            a->stepValues[a->selectedSeq][a->selectedStep][0] = (int16_t)((potValue * 65535.0f) - 32768);
+            StepEdit edit = { kEditCvValue, (uint8_t)a->activeBank(), (uint8_t)a->selectedSeq,
+                              (uint8_t)a->selectedStep, 0,
+                              (int16_t)((potValue * 65535.0f) - 32768) };
+            a->edits.push(edit);
+            a->editGeneration++;
         }
     }
     
-    if (data.controls & kNT_potC) {
+    if (a->dims.outs > 1 && (data.controls & kNT_potC)) {
         float potValue = data.pots[1];
-        int16_t currentValue = a->stepValues[a->selectedSeq][a->selectedStep][1];
+        int16_t currentValue = a->stepValues(a->selectedSeq, a->selectedStep)[1];
         float currentNormalized = (currentValue + 32768) / 65535.0f;
         
         if (!a->potCaught[1]) {
@@ -1618,13 +3858,17 @@ void customUi(_NT_algorithm* self, const _NT_uiData& data) {
         }
         
         if (a->potCaught[1]) {
-            a->stepValues[a->selectedSeq][a->selectedStep][1] = (int16_t)((potValue * 65535.0f) - 32768);
+            StepEdit edit = { kEditCvValue, (uint8_t)a->activeBank(), (uint8_t)a->selectedSeq,
+                              (uint8_t)a->selectedStep, 1,
+                              (int16_t)((potValue * 65535.0f) - 32768) };
+            a->edits.push(edit);
+            a->editGeneration++;
         }
     }
     
-    if (data.controls & kNT_potR) {
+    if (a->dims.outs > 2 && (data.controls & kNT_potR)) {
         float potValue = data.pots[2];
-        int16_t currentValue = a->stepValues[a->selectedSeq][a->selectedStep][2];
+        int16_t currentValue = a->stepValues(a->selectedSeq, a->selectedStep)[2];
         float currentNormalized = (currentValue + 32768) / 65535.0f;
         
         if (!a->potCaught[2]) {
@@ -1634,19 +3878,30 @@ void customUi(_NT_algorithm* self, const _NT_uiData& data) {
         }
         
         if (a->potCaught[2]) {
-            a->stepValues[a->selectedSeq][a->selectedStep][2] = (int16_t)((potValue * 65535.0f) - 32768);
+            StepEdit edit = { kEditCvValue, (uint8_t)a->activeBank(), (uint8_t)a->selectedSeq,
+                              (uint8_t)a->selectedStep, 2,
+                              (int16_t)((potValue * 65535.0f) - 32768) };
+            a->edits.push(edit);
+            a->editGeneration++;
         }
     }
 }
 
+// Edits made by one call are published together, so step() applies them in the same block
+void customUi(_NT_algorithm* self, const _NT_uiData& data) {
+    VSeq* a = (VSeq*)self;
+    handleControls(self, data);
+    a->edits.commit();
+}
+
 void setupUi(_NT_algorithm* self, _NT_float3& pots) {
     VSeq* a = (VSeq*)self;
     
-    // Only update pot positions when step changes
-    if (a->selectedStep != a->lastSelectedStep) {
+    // Only update pot positions when step changes on a CV sequencer
+    if (a->selectedStep != a->lastSelectedStep && a->selectedSeq < a->dims.cvSeqs) {
         a->lastSelectedStep = a->selectedStep;
-        for (int i = 0; i < 3; i++) {
-            int16_t value = a->stepValues[a->selectedSeq][a->selectedStep][i];
+        for (int i = 0; i < a->dims.outs; i++) {
+            int16_t value = a->stepValues(a->selectedSeq, a->selectedStep)[i];
             // Convert from int16_t to 0.0-1.0
             pots[i] = (value + 32768) / 65535.0f;
         }
@@ -1655,180 +3910,416 @@ void setupUi(_NT_algorithm* self, _NT_float3& pots) {
 
 void parameterChanged(_NT_algorithm* self, int parameterIndex) {
     VSeq* a = (VSeq*)self;
+    const ParamLayout& P = a->layout;
+    
+    // Lengths and split points are part of the drawn grid
+    a->gridDirty = true;
+    a->editGeneration++;
+    
+    // Snapshot the changed parameter so step() never reads self->v
+    int track = trackForParam(a, parameterIndex);
+    if (track >= 0) {
+        snapshotTrack(a, self->v, track);
+    } else {
+        snapshotGlobals(a, self->v);
+    }
+    
+    // Pattern selection switches banks at the next boundary (parameter is 1-based)
+    if (parameterIndex == P.bank) {
+        StepEdit edit = { kEditSelectBank, 0, 0, 0, 0, (int16_t)(self->v[P.bank] - 1) };
+        a->edits.push(edit);
+        a->edits.commit();
+    }
+    
+    // The quantiser table is rebuilt on the audio side, which owns the step caches
+    if (parameterIndex >= P.cvScale && parameterIndex < P.cvScaleMask + a->dims.cvSeqs) {
+        StepEdit edit = { kEditScale, 0, (uint8_t)track, 0, 0, 0 };
+        a->edits.push(edit);
+        a->edits.commit();
+    }
     
-    // Update debug output bus tracking when output parameters change
-    if (parameterIndex >= kParamSeq1Out1 && parameterIndex <= kParamSeq3Out3) {
-        int debugIdx = parameterIndex - kParamSeq1Out1;
-        a->debugOutputBus[debugIdx] = self->v[parameterIndex];  // Store parameter value (1-28)
+    // Bake runs on the audio side, against the bank that is playing
+    if (parameterIndex >= P.gateBake && parameterIndex < P.gateBake + a->dims.gateTracks && self->v[parameterIndex]) {
+        StepEdit edit = { kEditBake, 0, (uint8_t)(parameterIndex - P.gateBake), 0, 0, 0 };
+        a->edits.push(edit);
+        a->edits.commit();
     }
     
     // Reset split/section parameters when step count changes
-    if (parameterIndex == kParamSeq1StepCount || 
-        parameterIndex == kParamSeq2StepCount ||
-        parameterIndex == kParamSeq3StepCount) {
-        
-        int seq = 0;
-        if (parameterIndex == kParamSeq1StepCount) seq = 0;
-        else if (parameterIndex == kParamSeq2StepCount) seq = 1;
-        else if (parameterIndex == kParamSeq3StepCount) seq = 2;
+    if (track >= 0 && track < a->dims.cvSeqs && parameterIndex == P.seqParam(track, kSeqStepCount)) {
+        int seq = track;
         
         int stepCount = self->v[parameterIndex];
-        int splitParam = kParamSeq1SplitPoint + (seq * 6);
-        int sec1Param = kParamSeq1Section1Reps + (seq * 6);
-        int sec2Param = kParamSeq1Section2Reps + (seq * 6);
         
         // Calculate new split point (middle of sequence)
         int newSplit = stepCount / 2;
         if (newSplit < 1) newSplit = 1;
         if (newSplit >= stepCount) newSplit = stepCount - 1;
         
-        // Reset parameters using NT_setParameterFromAudio
-        int32_t algoIdx = NT_algorithmIndex(self);
-        NT_setParameterFromAudio(algoIdx, splitParam + NT_parameterOffset(), newSplit);
-        NT_setParameterFromAudio(algoIdx, sec1Param + NT_parameterOffset(), 1);
-        NT_setParameterFromAudio(algoIdx, sec2Param + NT_parameterOffset(), 1);
-        
-        // Reset section counters
-        a->section1Counter[seq] = 0;
-        a->section2Counter[seq] = 0;
-        a->inSection2[seq] = false;
+        // step() sets the parameters from the audio side and resets the section counters
+        StepEdit edit = { kEditSectionReset, 0, (uint8_t)seq, 0, 0, (int16_t)newSplit };
+        a->edits.push(edit);
+        a->edits.commit();
     }
 }
 
-void serialise(_NT_algorithm* self, _NT_jsonStream& stream) {
-    VSeq* a = (VSeq*)self;
+// Zigzag mapping, so small negative deltas pack as small varints
+static uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t z) {
+    return (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+}
+
+static void packBank(VSeq* a, Base64Writer& w, const PatternBank& bank) {
+    const VSeqDims& dims = a->dims;
     
-    // Save all step values as 3D array
-    stream.addMemberName("stepValues");
-    stream.openArray();
-    for (int seq = 0; seq < 3; seq++) {
-        stream.openArray();
-        for (int step = 0; step < 32; step++) {
-            stream.openArray();
-            for (int out = 0; out < 3; out++) {
-                stream.addNumber((int)a->stepValues[seq][step][out]);
-            }
-            stream.closeArray();
+    // Gate states, 4 steps per byte from the low bits up
+    int numGates = dims.gateTracks * dims.maxSteps;
+    uint8_t packed = 0;
+    for (int i = 0; i < numGates; i++) {
+        packed |= (uint8_t)((bank.gates[i] & 3) << (2 * (i & 3)));
+        if ((i & 3) == 3 || i == numGates - 1) {
+            w.put(packed);
+            packed = 0;
         }
-        stream.closeArray();
     }
-    stream.closeArray();
     
-    // Save debug output bus assignments
-    stream.addMemberName("debugOutputBus");
-    stream.openArray();
-    for (int i = 0; i < 12; i++) {
-        stream.addNumber(a->debugOutputBus[i]);
+    // Ratchets and chance of the steps that have them
+    int numExtended = 0;
+    for (int i = 0; i < numGates; i++) {
+        if (bank.gates[i] & ~kGateStateMask) numExtended++;
+    }
+    w.putVarint(numExtended);
+    int next = 0;
+    for (int i = 0; i < numGates; i++) {
+        if (!(bank.gates[i] & ~kGateStateMask)) continue;
+        w.putVarint(i - next);
+        w.put((uint8_t)(bank.gates[i] >> kGateRatchetShift));
+        next = i + 1;
     }
-    stream.closeArray();
     
-    // Save gate sequencer data (6 tracks × 32 steps) as uint8_t (0=off, 1=normal, 2=accent)
-    stream.addMemberName("gateSteps");
-    stream.openArray();
-    for (int track = 0; track < 6; track++) {
-        stream.openArray();
-        for (int step = 0; step < 32; step++) {
-            stream.addNumber((int)a->gateSteps[track][step]);
+    // CV values as deltas along each output's steps, with runs of repeats counted
+    int32_t prev = 0;
+    int run = -1;   // Further zero deltas counted since the last zero delta written (-1 = none)
+    for (int seq = 0; seq < dims.cvSeqs; seq++) {
+        for (int out = 0; out < dims.outs; out++) {
+            for (int step = 0; step < dims.maxSteps; step++) {
+                int32_t value = a->bankValues(bank, seq, step)[out];
+                int32_t delta = value - prev;
+                prev = value;
+                if (run >= 0) {
+                    if (delta == 0 && run < 255) {
+                        run++;
+                        continue;
+                    }
+                    w.put((uint8_t)run);
+                    run = -1;
+                }
+                w.putVarint(zigzag(delta));
+                if (delta == 0) run = 0;
+            }
         }
-        stream.closeArray();
     }
-    stream.closeArray();
+    if (run >= 0) w.put((uint8_t)run);
+    
+    for (int seq = 0; seq < dims.cvSeqs; seq++) {
+        w.putVarint(bank.glides[seq]);
+    }
 }
 
-bool deserialise(_NT_algorithm* self, _NT_jsonParse& parse) {
-    VSeq* a = (VSeq*)self;
+// Pack every bank into presetText
+static void packPreset(VSeq* a) {
+    const VSeqDims& dims = a->dims;
+    Base64Writer w(a->presetText);
+    w.put(kPresetMagic[0]);
+    w.put(kPresetMagic[1]);
+    w.put(kPresetVersion);
+    w.put((uint8_t)dims.cvSeqs);
+    w.put((uint8_t)dims.outs);
+    w.put((uint8_t)dims.gateTracks);
+    w.put((uint8_t)dims.maxSteps);
+    w.put((uint8_t)dims.banks);
+    for (int bank = 0; bank < dims.banks; bank++) {
+        packBank(a, w, a->banks[bank]);
+    }
+    w.finish();
+}
+
+// Unpack one bank saved with dimensions 'saved' in format 'version'. Data outside this instance's
+// dimensions is read and dropped; a NULL bank drops all of it.
+static bool unpackBank(VSeq* a, Base64Reader& r, PatternBank* bank, const VSeqDims& saved, int version) {
+    const VSeqDims& dims = a->dims;
     
-    // Match "stepValues"
-    if (parse.matchName("stepValues")) {
-        int numSeqs = 0;
-        if (parse.numberOfArrayElements(numSeqs)) {
-            // Support both 3 and 4 sequencer presets (backwards compatibility)
-            int seqsToLoad = (numSeqs < 3) ? numSeqs : 3;
-            for (int seq = 0; seq < seqsToLoad; seq++) {
-                int numSteps = 0;
-                if (parse.numberOfArrayElements(numSteps)) {
-                    // Support both 16 and 32 step presets
-                    int stepsToLoad = (numSteps < 32) ? numSteps : 32;
-                    for (int step = 0; step < stepsToLoad; step++) {
-                        int numOuts = 0;
-                        if (parse.numberOfArrayElements(numOuts) && numOuts == 3) {
-                            for (int out = 0; out < 3; out++) {
-                                int value;
-                                if (parse.number(value)) {
-                                    a->stepValues[seq][step][out] = (int16_t)value;
-                                }
-                            }
-                        }
-                    }
-                }
+    int numGates = saved.gateTracks * saved.maxSteps;
+    uint8_t packed = 0;
+    for (int i = 0; i < numGates; i++) {
+        if ((i & 3) == 0 && !r.get(packed)) return false;
+        int track = i / saved.maxSteps;
+        int step = i % saved.maxSteps;
+        uint8_t state = (packed >> (2 * (i & 3))) & 3;
+        if (bank && track < dims.gateTracks && step < dims.maxSteps) {
+            a->bankGates(*bank, track)[step] = (state > 2) ? 1 : state;
+        }
+    }
+    
+    if (version >= 2) {
+        uint32_t numExtended;
+        if (!r.getVarint(numExtended)) return false;
+        uint32_t next = 0;
+        for (uint32_t n = 0; n < numExtended; n++) {
+            uint32_t gap;
+            uint8_t extra;
+            if (!r.getVarint(gap) || !r.get(extra)) return false;
+            uint32_t i = next + gap;
+            next = i + 1;
+            if (i >= (uint32_t)numGates) return false;
+            int track = i / saved.maxSteps;
+            int step = i % saved.maxSteps;
+            if (bank && track < dims.gateTracks && step < dims.maxSteps) {
+                uint8_t& gate = a->bankGates(*bank, track)[step];
+                gate = (uint8_t)((gate & kGateStateMask) | (extra << kGateRatchetShift));
             }
         }
     }
     
-    // Match "debugOutputBus" (optional)
-    if (parse.matchName("debugOutputBus")) {
-        int numBuses = 0;
-        if (parse.numberOfArrayElements(numBuses)) {
-            for (int i = 0; i < numBuses && i < 12; i++) {
-                int bus;
-                if (parse.number(bus)) {
-                    a->debugOutputBus[i] = bus;
+    int32_t value = 0;
+    int repeats = 0;
+    for (int seq = 0; seq < saved.cvSeqs; seq++) {
+        for (int out = 0; out < saved.outs; out++) {
+            for (int step = 0; step < saved.maxSteps; step++) {
+                if (repeats > 0) {
+                    repeats--;
+                } else {
+                    uint32_t z;
+                    if (!r.getVarint(z)) return false;
+                    int32_t delta = unzigzag(z);
+                    value += delta;
+                    if (delta == 0) {
+                        uint8_t run;
+                        if (!r.get(run)) return false;
+                        repeats = run;
+                    }
+                }
+                if (bank && seq < dims.cvSeqs && out < dims.outs && step < dims.maxSteps) {
+                    a->bankValues(*bank, seq, step)[out] = (int16_t)value;
                 }
             }
         }
     }
     
-    // Match "gateSteps" (optional, for gate sequencer)
-    // Support both old bool format (0/1) and new uint8_t format (0/1/2)
-    if (parse.matchName("gateSteps")) {
-        int numTracks = 0;
-        if (parse.numberOfArrayElements(numTracks)) {
-            int tracksToLoad = (numTracks < 6) ? numTracks : 6;
-            for (int track = 0; track < tracksToLoad; track++) {
-                int numSteps = 0;
-                if (parse.numberOfArrayElements(numSteps)) {
-                    int stepsToLoad = (numSteps < 32) ? numSteps : 32;
-                    for (int step = 0; step < stepsToLoad; step++) {
-                        int value;
-                        if (parse.number(value)) {
-                            // Clamp to valid range 0-2 for backwards compatibility
-                            if (value < 0) value = 0;
-                            if (value > 2) value = 1;  // Old presets may have any non-zero as "on"
-                            a->gateSteps[track][step] = (uint8_t)value;
-                        }
-                    }
+    // Glide masks; older presets have no glides
+    uint32_t stepMask = (dims.maxSteps >= 32) ? 0xFFFFFFFFu : ((1u << dims.maxSteps) - 1);
+    if (bank) {
+        for (int seq = 0; seq < dims.cvSeqs; seq++) bank->glides[seq] = 0;
+    }
+    if (version >= 3) {
+        for (int seq = 0; seq < saved.cvSeqs; seq++) {
+            uint32_t glides;
+            if (!r.getVarint(glides)) return false;
+            if (bank && seq < dims.cvSeqs) bank->glides[seq] = glides & stepMask;
+        }
+    }
+    return true;
+}
+
+// Decode a packed preset into the banks in one pass. Returns false for a version this build
+// does not know or a damaged string; banks decoded before the damage keep their data.
+static bool unpackPreset(VSeq* a, const char* text) {
+    Base64Reader r(text);
+    uint8_t header[kPresetHeaderBytes];
+    for (int i = 0; i < kPresetHeaderBytes; i++) {
+        if (!r.get(header[i])) return false;
+    }
+    if (header[0] != kPresetMagic[0] || header[1] != kPresetMagic[1] || header[2] < 1 || header[2] > kPresetVersion) return false;
+    
+    VSeqDims saved;
+    saved.cvSeqs = header[3];
+    saved.outs = header[4];
+    saved.gateTracks = header[5];
+    saved.maxSteps = header[6];
+    saved.banks = header[7];
+    if (saved.maxSteps == 0) return false;
+    
+    for (int bank = 0; bank < saved.banks; bank++) {
+        PatternBank* target = (bank < a->dims.banks) ? &a->banks[bank] : NULL;
+        if (!unpackBank(a, r, target, saved, header[2])) return false;
+    }
+    return true;
+}
+
+void serialise(_NT_algorithm* self, _NT_jsonStream& stream) {
+    VSeq* a = (VSeq*)self;
+    
+    // Every bank as one packed string. Output bus assignments come back from the parameters.
+    packPreset(a);
+    stream.addMemberName("patterns");
+    stream.addString(a->presetText);
+}
+
+// Read an older preset's [seq][step][out] array into one bank. Presets with more sequencers or
+// steps than this instance (older 4 sequencer presets, 32 step presets in a 16 step instance)
+// load the ones that fit.
+static bool readStepValues(VSeq* a, _NT_jsonParse& parse, const PatternBank& bank) {
+    int numSeqs = 0;
+    if (!parse.numberOfArrayElements(numSeqs)) return false;
+    for (int seq = 0; seq < numSeqs; seq++) {
+        int numSteps = 0;
+        if (!parse.numberOfArrayElements(numSteps)) return false;
+        for (int step = 0; step < numSteps; step++) {
+            int numOuts = 0;
+            if (!parse.numberOfArrayElements(numOuts)) return false;
+            for (int out = 0; out < numOuts; out++) {
+                int value;
+                if (!parse.number(value)) return false;
+                if (seq < a->dims.cvSeqs && step < a->dims.maxSteps && out < a->dims.outs) {
+                    a->bankValues(bank, seq, step)[out] = (int16_t)value;
                 }
             }
         }
     }
+    return true;
+}
+
+// Read an older preset's [track][step] array into one bank
+// Support both old bool format (0/1) and new uint8_t format (0/1/2)
+static bool readGateSteps(VSeq* a, _NT_jsonParse& parse, const PatternBank& bank) {
+    int numTracks = 0;
+    if (!parse.numberOfArrayElements(numTracks)) return false;
+    for (int track = 0; track < numTracks; track++) {
+        int numSteps = 0;
+        if (!parse.numberOfArrayElements(numSteps)) return false;
+        for (int step = 0; step < numSteps; step++) {
+            int value;
+            if (!parse.number(value)) return false;
+            if (track < a->dims.gateTracks && step < a->dims.maxSteps) {
+                // Clamp to valid range 0-2 for backwards compatibility
+                if (value < 0) value = 0;
+                if (value > 2) value = 1;  // Old presets may have any non-zero as "on"
+                a->bankGates(bank, track)[step] = (uint8_t)value;
+            }
+        }
+    }
+    return true;
+}
+
+bool deserialise(_NT_algorithm* self, _NT_jsonParse& parse) {
+    VSeq* a = (VSeq*)self;
+    const ParamLayout& P = a->layout;
+    bool legacy = false;
+    
+    int numMembers = 0;
+    if (!parse.numberOfObjectMembers(numMembers)) return false;
+    for (int i = 0; i < numMembers; i++) {
+        if (parse.matchName("patterns")) {
+            const char* text;
+            if (!parse.string(text)) return false;
+            unpackPreset(a, text);
+        } else if (parse.matchName("stepValues")) {
+            // Presets from before the packed format hold one pattern as number arrays
+            if (!readStepValues(a, parse, a->banks[0])) return false;
+            legacy = true;
+        } else if (parse.matchName("gateSteps")) {
+            if (!readGateSteps(a, parse, a->banks[0])) return false;
+            legacy = true;
+        } else {
+            // Anything else, including the "debugOutputBus" of older presets: the output buses are parameters
+            if (!parse.skipMember()) return false;
+        }
+    }
     
-    // After deserialization, sync debug array from current parameter values
-    // (in case parameters were loaded but custom data wasn't)
-    for (int i = 0; i < 12; i++) {
-        a->debugOutputBus[i] = self->v[kParamSeq1Out1 + i];
+    // Clock Div did nothing in the versions that wrote number arrays, so whatever those presets
+    // saved (usually the old /16 default) they advance once per clock, as they always did
+    if (legacy) {
+        int32_t algoIdx = NT_algorithmIndex(a);
+        for (int seq = 0; seq < a->dims.cvSeqs; seq++) {
+            NT_setParameterFromUi(algoIdx, P.seqParam(seq, kSeqClockDiv) + NT_parameterOffset(), kClockDivX1);
+        }
+        for (int track = 0; track < a->dims.gateTracks; track++) {
+            NT_setParameterFromUi(algoIdx, P.gateParam(track, kGateClockDiv) + NT_parameterOffset(), kClockDivX1);
+        }
     }
     
+    // Loaded step values replace everything the output cache was built from
+    a->invalidateAllSteps();
+    a->editGeneration++;
+    
     return true;
 }
 
-// Factory
+// MIDI clock, Start, Continue and Stop, queued for step(). Other realtime bytes are ignored.
+void midiRealtime(_NT_algorithm* self, uint8_t byte) {
+    VSeq* a = (VSeq*)self;
+    if (byte == 0xF8 || byte == 0xFA || byte == 0xFB || byte == 0xFC) {
+        a->midiClock.receive(byte);
+    }
+}
+
+// Song position pointer: 14 bits of 16th notes since the start of the song
+void midiMessage(_NT_algorithm* self, uint8_t byte0, uint8_t byte1, uint8_t byte2) {
+    VSeq* a = (VSeq*)self;
+    if (byte0 == 0xF2) {
+        a->midiClock.songPosition = (uint16_t)((byte1 & 0x7F) | ((byte2 & 0x7F) << 7));
+        a->midiClock.receive(kMidiSongPosition);
+    }
+}
+
+// Static memory for the clock the instances share
+void calculateStaticRequirements(_NT_staticRequirements& req) {
+    req.dram = sizeof(SharedClock);
+}
+
+// Both factories ask for the block; the first one given is used by every instance
+void initialise(_NT_staticMemoryPtrs& ptrs, const _NT_staticRequirements& req) {
+    if (sharedClock || req.dram < sizeof(SharedClock)) return;
+    sharedClock = (SharedClock*)ptrs.dram;
+    sharedClock->init();
+}
+
+// Factories
 extern "C" {
 
 static const _NT_factory factory = {
     .guid = NT_MULTICHAR('C','G','S','Q'),
     .name = "VSeq",
     .description = "4-channel 16-step sequencer with clock/reset",
-    .numSpecifications = 0,
-    .specifications = NULL,
-    .calculateStaticRequirements = NULL,
-    .initialise = NULL,
+    .numSpecifications = kNumSpecifications,
+    .specifications = specifications,
+    .calculateStaticRequirements = calculateStaticRequirements,
+    .initialise = initialise,
     .calculateRequirements = calculateRequirements,
     .construct = construct,
     .parameterChanged = parameterChanged,
     .step = step,  // Note: step callback processes audio
     .draw = draw,
-    .midiRealtime = NULL,
-    .midiMessage = NULL,
+    .midiRealtime = midiRealtime,
+    .midiMessage = midiMessage,
+    .tags = kNT_tagUtility,
+    .hasCustomUi = hasCustomUi,
+    .customUi = customUi,
+    .setupUi = setupUi,
+    .serialise = serialise,
+    .deserialise = deserialise,
+    .midiSysEx = NULL
+};
+
+// Same sequencer with smaller specification ranges: up to 1 CV sequencer and 4 trigger tracks of 16 steps
+static const _NT_factory liteFactory = {
+    .guid = NT_MULTICHAR('C','G','S','L'),
+    .name = "VSeq Lite",
+    .description = "1 CV sequencer + 4 trigger tracks, 16 steps",
+    .numSpecifications = kNumSpecifications,
+    .specifications = liteSpecifications,
+    .calculateStaticRequirements = calculateStaticRequirements,
+    .initialise = initialise,
+    .calculateRequirements = calculateRequirements,
+    .construct = construct,
+    .parameterChanged = parameterChanged,
+    .step = step,
+    .draw = draw,
+    .midiRealtime = midiRealtime,
+    .midiMessage = midiMessage,
     .tags = kNT_tagUtility,
     .hasCustomUi = hasCustomUi,
     .customUi = customUi,
@@ -1838,14 +4329,17 @@ static const _NT_factory factory = {
     .midiSysEx = NULL
 };
 
+static const _NT_factory* const factories[] = { &factory, &liteFactory };
+static const uint32_t kNumFactories = sizeof(factories) / sizeof(factories[0]);
+
 uintptr_t pluginEntry(_NT_selector selector, uint32_t data) {
     switch (selector) {
         case kNT_selector_version:
             return kNT_apiVersionCurrent;
         case kNT_selector_numFactories:
-            return 1;
+            return kNumFactories;
         case kNT_selector_factoryInfo:
-            return (uintptr_t)((data == 0) ? &factory : NULL);
+            return (uintptr_t)((data < kNumFactories) ? factories[data] : NULL);
         default:
             return 0;
     }
@@ -0,0 +1,206 @@
+// Host benchmarks for the plugin as shipped: src/main.cpp built against the stub API headers
+// in stub/ and driven only through its factory, like the Disting NT firmware does.
+//
+// Reports the cost of step() for a range of block sizes and clock rates, of draw() on the CV
+// and gate pages, and of a serialise/deserialise round trip, and checks that none of them
+// allocate. Timings are host timings: compare them between builds, not with the hardware.
+
+#include "nt_mock.h"
+#include "vseq_host.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+// Every operator new is counted, so a timed section can check it allocated nothing
+static long allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedNs(Clock::time_point start) {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+static const int kClockBus = 0;         // Bus of the Clock in parameter's default input
+static const int kClockPulse = 5;       // Clock input pulse length in samples
+
+// Clock input pulses of 'period' samples; 'time' is the first frame of the block
+static void fillClock(std::vector<float>& buses, int numFrames, long time, int period) {
+    memset(buses.data(), 0, buses.size() * sizeof(float));
+    float* clock = buses.data() + kClockBus * numFrames;
+    for (int frame = 0; frame < numFrames; frame++) {
+        clock[frame] = ((time + frame) % period) < kClockPulse ? 5.0f : 0.0f;
+    }
+}
+
+static void pressEncoder(Instance& inst, int encoder, int delta) {
+    _NT_uiData data;
+    memset(&data, 0, sizeof(data));
+    data.encoders[encoder] = (int8_t)delta;
+    inst.factory->customUi(inst.algo, data);
+}
+
+static bool allocationFree = true;
+
+static void checkAllocations(long before, const char* what) {
+    if (allocations != before) {
+        printf("  FAIL: %s allocated %ld times\n", what, allocations - before);
+        allocationFree = false;
+    }
+}
+
+static const char* const divisionNames[] = { "/16", "/8", "/4", "/2", "x1", "x2", "x4", "x8", "x16" };
+
+static void benchStep(int factoryIndex, const int32_t* specs) {
+    static const int blockSizes[] = { 4, 8, 16, 32, 64, 128 };
+    static const int divisions[] = { 4, 6, 8 };     // x1, x4, x16
+    static const int kClockPeriod = 6000;           // 16th notes at 120 BPM
+    static const long kFrames = 48000 * 20;         // 20 seconds of audio per row
+    
+    printf("\nstep(): %d CV sequencers, %d trigger tracks, %d steps, clock every %d samples\n",
+           specs[0], specs[1], specs[2], kClockPeriod);
+    printf("  %-6s %-5s %12s %12s %10s\n", "block", "div", "ns/block", "ns/frame", "midi");
+    
+    for (unsigned d = 0; d < sizeof(divisions) / sizeof(divisions[0]); d++) {
+        for (unsigned b = 0; b < sizeof(blockSizes) / sizeof(blockSizes[0]); b++) {
+            int numFrames = blockSizes[b];
+            Instance inst(factoryIndex, specs);
+            configure(inst, specs[0], specs[1], divisions[d]);
+            loadPattern(inst, specs[0], specs[1], specs[2]);
+            std::vector<float> buses(kNumBuses * numFrames);
+            mockReset();
+            
+            long blocks = kFrames / numFrames;
+            long before = allocations;
+            double ns = 0;
+            for (long block = 0; block < blocks; block++) {
+                fillClock(buses, numFrames, block * numFrames, kClockPeriod);
+                Clock::time_point start = Clock::now();
+                inst.factory->step(inst.algo, buses.data(), numFrames / 4);
+                ns += elapsedNs(start);
+            }
+            checkAllocations(before, "step()");
+            printf("  %-6d %-5s %12.1f %12.2f %10d\n", numFrames, divisionNames[divisions[d]],
+                   ns / blocks, ns / (blocks * numFrames), mockMidiMessages);
+        }
+    }
+}
+
+static void benchDraw(int factoryIndex, const int32_t* specs) {
+    static const int kNumFrames = 32;
+    static const int kClockPeriod = 480;    // A step every 10ms, so most draws see a moved playhead
+    static const int kDraws = 20000;
+    
+    printf("\ndraw(): %d CV sequencers, %d trigger tracks, %d steps, one draw per %d frame block\n",
+           specs[0], specs[1], specs[2], kNumFrames);
+    printf("  %-6s %12s %12s\n", "page", "ns/draw", "calls/draw");
+    
+    for (int page = 0; page < 2; page++) {
+        if (page == 0 && specs[0] == 0) continue;
+        if (page == 1 && specs[1] == 0) continue;
+        Instance inst(factoryIndex, specs);
+        configure(inst, specs[0], specs[1], 4);
+        loadPattern(inst, specs[0], specs[1], specs[2]);
+        if (page == 1) pressEncoder(inst, 0, specs[0]);
+        std::vector<float> buses(kNumBuses * kNumFrames);
+        
+        long before = allocations;
+        double ns = 0;
+        int calls = 0;
+        for (int i = 0; i < kDraws; i++) {
+            fillClock(buses, kNumFrames, (long)i * kNumFrames, kClockPeriod);
+            inst.factory->step(inst.algo, buses.data(), kNumFrames / 4);
+            mockReset();
+            Clock::time_point start = Clock::now();
+            inst.factory->draw(inst.algo);
+            ns += elapsedNs(start);
+            calls += mockDrawCalls;
+        }
+        checkAllocations(before, "draw()");
+        printf("  %-6s %12.1f %12.1f\n", page == 0 ? "CV" : "gate", ns / kDraws, (double)calls / kDraws);
+    }
+}
+
+static bool benchSerialise(int factoryIndex, const int32_t* specs) {
+    static const int kRounds = 2000;
+    
+    printf("\nserialise()/deserialise(): %d CV sequencers, %d trigger tracks, %d steps, %d banks\n",
+           specs[0], specs[1], specs[2], specs[3]);
+    
+    Instance from(factoryIndex, specs);
+    Instance to(factoryIndex, specs);
+    configure(from, specs[0], specs[1], 4);
+    loadPattern(from, specs[0], specs[1], specs[2]);
+    
+    _NT_jsonStream stream(NULL);
+    _NT_jsonParse parse(NULL, 0);
+    long before = allocations;
+    double writeNs = 0;
+    double readNs = 0;
+    for (int i = 0; i < kRounds; i++) {
+        mockJsonClear();
+        Clock::time_point start = Clock::now();
+        from.factory->serialise(from.algo, stream);
+        writeNs += elapsedNs(start);
+        
+        mockJsonRewind();
+        start = Clock::now();
+        to.factory->deserialise(to.algo, parse);
+        readNs += elapsedNs(start);
+    }
+    checkAllocations(before, "serialise()/deserialise()");
+    
+    // The loaded instance must write the same document back
+    mockJsonClear();
+    from.factory->serialise(from.algo, stream);
+    uint32_t written = mockJsonHash();
+    mockJsonClear();
+    to.factory->serialise(to.algo, stream);
+    bool same = mockJsonHash() == written;
+    
+    printf("  serialise %10.1f ns   deserialise %10.1f ns   round trip %s\n",
+           writeNs / kRounds, readNs / kRounds, same ? "identical" : "DIFFERS");
+    return same;
+}
+
+int main() {
+    // Full size VSeq, and VSeq Lite at its defaults
+    static const int32_t full[] = { 3, 6, 32, 1 };
+    static const int32_t lite[] = { 1, 4, 16, 1 };
+    static const int32_t banks[] = { 3, 6, 32, 16 };
+    
+    printf("VSeq host benchmarks\n");
+    printf("====================\n");
+    
+    benchStep(0, full);
+    benchStep(1, lite);
+    benchDraw(0, full);
+    benchDraw(1, lite);
+    bool ok = benchSerialise(0, full);
+    ok = benchSerialise(0, banks) && ok;
+    
+    printf("\nAllocation-free: %s\n", allocationFree ? "yes" : "NO");
+    return (ok && allocationFree) ? 0 : 1;
+}
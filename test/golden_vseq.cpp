@@ -0,0 +1,342 @@
+// Golden output regression for the timing-critical paths: clock edges, divisions and
+// multiplications, swing, section order, gate lengths, ratchets, chance, glides, pattern bank
+// switches, MIDI clock and MIDI output.
+//
+// Each scene drives the plugin through its factory with scripted clock, reset and MIDI clock
+// input and parameter changes, and renders every change of every output bus, to the sample, and every MIDI message
+// sent. The render must match the scene's file in golden/ at every block size, so a change
+// that is meant to be a pure speed-up moves nothing. Each render also reports its throughput.
+//
+//   vseq_golden            compare every scene with its golden file
+//   vseq_golden --update   rewrite the golden files from the current plugin
+
+#include "nt_mock.h"
+#include "vseq_host.h"
+#include "../src/main.cpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static const int kClockBus = 0;         // Bus of the Clock in parameter's default input
+static const int kResetBus = 1;         // Bus of the Reset in parameter's default input
+static const int kClockPulse = 5;       // Clock and reset input pulse length in samples
+static const long kSceneFrames = 32768; // Frames rendered per scene, a multiple of every block size
+static const int kMidiClockSpacing = 256;   // Samples between MIDI clocks, a multiple of every block size
+
+// Block sizes every scene is rendered at. MIDI clock arrives between blocks, so its bytes are
+// only sent on frames that start a block at all of these sizes.
+static const int blockSizes[] = { 8, 32, 128 };
+
+struct Scene {
+    const char* name;
+    int factoryIndex;
+    int32_t specs[4];
+    void (*setup)(Instance& inst);
+    void (*cue)(Instance& inst, long time);     // Parameter changes before the block at 'time' (NULL = none)
+    int clockPeriod;            // Clock input period in samples (0 = no clock input)
+    long resetFrame;            // Frame of the one reset input pulse (-1 = none)
+    bool midiClock;             // Send MIDI Start, clocks, Stop and Continue
+};
+
+// Every output routed, x1 clocks with swing on every other trigger track, and mixed divisions
+static void setupDivisions(Instance& inst) {
+    configure(inst, 3, 6, 4);
+    loadPattern(inst, 3, 6, 32);
+    inst.set("Seq 2 Clock Div", 5);     // x2
+    inst.set("Seq 3 Clock Div", 3);     // /2
+    inst.set("Gate 1 ClockDiv", 2);     // /4
+    inst.set("Gate 3 ClockDiv", 6);     // x4
+    inst.set("Gate 4 ClockDiv", 8);     // x16
+    inst.set("Gate 5 Gate Len", 20);
+    inst.set("Clock Out", 20);
+}
+
+// Section repeats, fills and every direction
+static void setupSections(Instance& inst) {
+    configure(inst, 3, 6, 4);
+    loadPattern(inst, 3, 6, 32);
+    inst.set("Seq 1 Steps", 12);
+    inst.set("Seq 1 Split Point", 5);
+    inst.set("Seq 1 Sec1 Reps", 3);
+    inst.set("Seq 1 Sec2 Reps", 2);
+    inst.set("Seq 2 Direction", 1);
+    inst.set("Seq 2 Split Point", 3);
+    inst.set("Seq 2 Sec1 Reps", 2);
+    inst.set("Seq 3 Direction", 2);
+    inst.set("Seq 3 Steps", 7);
+    inst.set("Gate 1 Split", 8);
+    inst.set("Gate 1 Sec1 Reps", 3);
+    inst.set("Gate 1 Fill Start", 6);
+    inst.set("Gate 2 Direction", 1);
+    inst.set("Gate 2 Split", 4);
+    inst.set("Gate 2 Sec2 Reps", 3);
+    inst.set("Gate 3 Direction", 2);
+    inst.set("Gate 3 Length", 5);
+    inst.set("Seq 1 Note Len", 30);
+}
+
+// Swing and multipliers on every track at once, over sections, the settings the per-track
+// state arrays were checked against when they became one TrackState array
+static void setupSwing(Instance& inst) {
+    configure(inst, 3, 6, 4);
+    loadPattern(inst, 3, 6, 32);
+    char name[32];
+    for (int track = 0; track < 6; track++) {
+        snprintf(name, sizeof(name), "Gate %d Swing", track + 1);
+        inst.set(name, 15 * track);
+        snprintf(name, sizeof(name), "Gate %d ClockDiv", track + 1);
+        inst.set(name, 3 + track);      // /2 to x16
+    }
+    inst.set("Gate 2 Split", 6);
+    inst.set("Gate 2 Sec1 Reps", 2);
+    inst.set("Seq 1 Clock Div", 6);     // x4
+    inst.set("Seq 1 Split Point", 6);
+    inst.set("Seq 1 Sec2 Reps", 3);
+    inst.set("Seq 2 Clock Div", 7);     // x8
+    inst.set("Seq 2 Direction", 2);
+    inst.set("Seq 3 Clock Div", 1);     // /8
+}
+
+// Step data as a preset would load it: ratchets and chance on the gate steps, glides on the CV
+// steps, and a second pattern bank with its own values and gates
+static void loadSteps(Instance& inst) {
+    VSeq* a = (VSeq*)inst.algo;
+    uint32_t state = 99;
+    for (int track = 0; track < 6; track++) {
+        for (int step = 0; step < 32; step++) {
+            uint8_t& gate = a->bankGates(a->banks[0], track)[step];
+            if (gateState(gate) == 0) gate = 1;
+            if (step % 3 == track % 3) gate |= (uint8_t)((patternRandom(state) % kMaxRatchets) << kGateRatchetShift);
+            if (step % 5 == 0) gate |= (uint8_t)((1 + patternRandom(state) % (kChanceLevels - 1)) << kGateChanceShift);
+            a->bankGates(a->banks[1], track)[step] = (uint8_t)((step + track) % 4 == 0 ? 2 : (step & 1));
+        }
+    }
+    for (int seq = 0; seq < 3; seq++) {
+        a->banks[0].glides[seq] = 0x11111111u << seq;
+        a->banks[1].glides[seq] = 0x01010101u;
+        for (int step = 0; step < 32; step++) {
+            int16_t* values = a->bankValues(a->banks[1], seq, step);
+            for (int out = 0; out < kOutsPerSeq; out++) {
+                values[out] = (int16_t)((int)(patternRandom(state) % 65536) - 32768);
+            }
+        }
+    }
+    a->invalidateAllSteps();
+}
+
+// Ratchets and chance on every trigger track, linear glides, and a switch to the second bank
+// at a section end, then back at a loop end. An exponential glide rounds differently in the
+// last bit when a block boundary splits it, so it cannot be compared across block sizes.
+static void setupRatchets(Instance& inst) {
+    configure(inst, 3, 6, 4);
+    loadPattern(inst, 3, 6, 32);
+    loadSteps(inst);
+    inst.set("Gate 2 ClockDiv", 5);     // x2
+    inst.set("Gate 4 ClockDiv", 3);     // /2
+    inst.set("Gate 5 Gate Len", 2);
+    inst.set("Seq 1 Slew 1", 5);
+    inst.set("Seq 1 Slew 2", 20);
+    inst.set("Seq 2 Slew 1", 10);
+    inst.set("Seq 3 Slew 3", 40);
+    inst.set("Seq 1 Steps", 8);
+    inst.set("Seq 1 Split Point", 4);
+}
+
+static void cueBankSwitches(Instance& inst, long time) {
+    if (time == 8192) inst.set("Pattern", 2);
+    if (time == 20480) {
+        inst.set("Pattern Switch", 1);  // Loop End
+        inst.set("Pattern", 1);
+    }
+}
+
+// The internal clock, with the quantiser on one sequencer
+static void setupInternal(Instance& inst) {
+    configure(inst, 3, 6, 4);
+    loadPattern(inst, 3, 6, 32);
+    inst.set("Clock Source", 2);
+    inst.set("Tempo", 2400);
+    inst.set("Seq 1 Scale", 2);
+    inst.set("Seq 1 Root", 2);
+    inst.set("Gate 6 ClockDiv", 7);     // x8
+    inst.set("Clock Out", 20);
+}
+
+// MIDI clock and transport
+static void setupMidiClock(Instance& inst) {
+    configure(inst, 3, 6, 4);
+    loadPattern(inst, 3, 6, 32);
+    inst.set("Clock Source", 1);
+    inst.set("Gate 2 ClockDiv", 6);     // x4
+}
+
+// VSeq Lite at its defaults
+static void setupLite(Instance& inst) {
+    configure(inst, 1, 4, 4);
+    loadPattern(inst, 1, 4, 16);
+}
+
+static const Scene scenes[] = {
+    { "divisions", 0, { 3, 6, 32, 1 }, setupDivisions, NULL, 701, 20000, false },
+    { "sections", 0, { 3, 6, 32, 1 }, setupSections, NULL, 499, -1, false },
+    { "swing", 0, { 3, 6, 32, 1 }, setupSwing, NULL, 997, 15000, false },
+    { "ratchets", 0, { 3, 6, 32, 2 }, setupRatchets, cueBankSwitches, 1201, -1, false },
+    { "internal", 0, { 3, 6, 32, 1 }, setupInternal, NULL, 0, 12345, false },
+    { "midi-clock", 0, { 3, 6, 32, 1 }, setupMidiClock, NULL, 0, -1, true },
+    { "lite", 1, { 1, 4, 16, 1 }, setupLite, NULL, 613, 9000, false },
+};
+static const int kNumScenes = sizeof(scenes) / sizeof(scenes[0]);
+
+// The MIDI realtime bytes due at the start of the block at 'time': Start, then a clock every
+// kMidiClockSpacing samples, Stop two thirds of the way through and Continue soon after
+static void sendMidiClock(Instance& inst, long time) {
+    static const long kStopFrame = (kSceneFrames * 2 / 3) / kMidiClockSpacing * kMidiClockSpacing;
+    static const long kContinueFrame = kStopFrame + 16 * kMidiClockSpacing;
+    if (time % kMidiClockSpacing != 0) return;
+    if (time == 0) inst.factory->midiRealtime(inst.algo, 0xFA);
+    if (time == kStopFrame) inst.factory->midiRealtime(inst.algo, 0xFC);
+    if (time == kContinueFrame) inst.factory->midiRealtime(inst.algo, 0xFB);
+    inst.factory->midiRealtime(inst.algo, 0xF8);
+}
+
+static void fillInputs(const Scene& scene, std::vector<float>& buses, int numFrames, long time) {
+    memset(buses.data(), 0, buses.size() * sizeof(float));
+    float* clock = buses.data() + kClockBus * numFrames;
+    float* reset = buses.data() + kResetBus * numFrames;
+    for (int frame = 0; frame < numFrames; frame++) {
+        long t = time + frame;
+        if (scene.clockPeriod > 0) clock[frame] = (t % scene.clockPeriod) < kClockPulse ? 5.0f : 0.0f;
+        if (scene.resetFrame >= 0) reset[frame] = (t >= scene.resetFrame && t < scene.resetFrame + kClockPulse) ? 5.0f : 0.0f;
+    }
+}
+
+// Render a scene at one block size: one line per output bus change, then the MIDI messages in
+// the order they were sent. Returns the seconds spent in step().
+static double render(const Scene& scene, int numFrames, std::string& out) {
+    Instance inst(scene.factoryIndex, scene.specs);
+    scene.setup(inst);
+    mockReset();
+    
+    std::vector<float> buses(kNumBuses * numFrames);
+    std::vector<float> last(kNumBuses, 0.0f);
+    std::string midi;
+    char line[64];
+    double seconds = 0;
+    
+    out = "# ";
+    out += scene.name;
+    out += "\n";
+    for (long time = 0; time < kSceneFrames; time += numFrames) {
+        fillInputs(scene, buses, numFrames, time);
+        if (scene.midiClock) sendMidiClock(inst, time);
+        if (scene.cue && time % kMidiClockSpacing == 0) scene.cue(inst, time);
+        
+        Clock::time_point start = Clock::now();
+        inst.factory->step(inst.algo, buses.data(), numFrames / 4);
+        seconds += std::chrono::duration<double>(Clock::now() - start).count();
+        
+        // The input buses are the scene's own, so only the rest are rendered
+        for (int frame = 0; frame < numFrames; frame++) {
+            for (int bus = kResetBus + 1; bus < kNumBuses; bus++) {
+                float value = buses[bus * numFrames + frame];
+                if (value == last[bus]) continue;
+                last[bus] = value;
+                snprintf(line, sizeof(line), "%ld bus %d %.4f\n", time + frame, bus + 1, value);
+                out += line;
+            }
+        }
+        for (int i = 0; i < mockMidiMessages && i < kMockMidiLog; i++) {
+            const MockMidiMessage& m = mockMidiLog[i];
+            snprintf(line, sizeof(line), "midi %02x %02x %02x\n", m.status, m.data1, m.data2);
+            midi += line;
+        }
+        mockReset();
+    }
+    out += midi;
+    return seconds;
+}
+
+static bool readFile(const std::string& path, std::string& text) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    char buffer[4096];
+    size_t n;
+    text.clear();
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+        text.append(buffer, n);
+    }
+    fclose(f);
+    return true;
+}
+
+static bool writeFile(const std::string& path, const std::string& text) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(text.data(), 1, text.size(), f) == text.size();
+    return (fclose(f) == 0) && ok;
+}
+
+// Line number of the first difference, counting from 1
+static int firstDifference(const std::string& a, const std::string& b) {
+    int line = 1;
+    for (size_t i = 0; i < a.size() && i < b.size(); i++) {
+        if (a[i] != b[i]) return line;
+        if (a[i] == '\n') line++;
+    }
+    return line;
+}
+
+int main(int argc, char** argv) {
+    bool update = argc > 1 && strcmp(argv[1], "--update") == 0;
+    bool ok = true;
+    
+    printf("VSeq golden output\n");
+    printf("==================\n");
+    printf("  %-12s %-6s %8s %14s  %s\n", "scene", "block", "lines", "blocks/s", "result");
+    
+    for (int s = 0; s < kNumScenes; s++) {
+        const Scene& scene = scenes[s];
+        std::string path = std::string("golden/") + scene.name + ".txt";
+        std::string golden;
+        bool haveGolden = readFile(path, golden);
+        
+        for (unsigned b = 0; b < sizeof(blockSizes) / sizeof(blockSizes[0]); b++) {
+            int numFrames = blockSizes[b];
+            std::string rendered;
+            double seconds = render(scene, numFrames, rendered);
+            int lines = 0;
+            for (size_t i = 0; i < rendered.size(); i++) {
+                if (rendered[i] == '\n') lines++;
+            }
+            
+            // An update writes the first block size's render; the others must agree with it
+            const char* result;
+            char detail[48];
+            if (update && b == 0) {
+                golden = rendered;
+                haveGolden = true;
+                result = writeFile(path, golden) ? "written" : "WRITE FAILED";
+            } else if (!haveGolden) {
+                result = "NO GOLDEN FILE";
+            } else if (rendered == golden) {
+                result = "match";
+            } else {
+                snprintf(detail, sizeof(detail), "DIFFERS at line %d", firstDifference(rendered, golden));
+                result = detail;
+            }
+            if (strcmp(result, "match") != 0 && strcmp(result, "written") != 0) ok = false;
+            
+            long blocks = kSceneFrames / numFrames;
+            printf("  %-12s %-6d %8d %14.0f  %s\n", scene.name, numFrames, lines, blocks / seconds, result);
+        }
+    }
+    
+    printf("\nGolden output: %s\n", ok ? "all scenes match" : "MISMATCH");
+    return ok ? 0 : 1;
+}
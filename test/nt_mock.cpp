@@ -0,0 +1,230 @@
+#include "nt_mock.h"
+
+#include <cstring>
+
+const _NT_globals NT_globals = { 48000, 128, NULL, 0 };
+uint8_t NT_screen[128 * 64];
+
+int mockDrawCalls = 0;
+int mockMidiMessages = 0;
+int mockParameterSets = 0;
+MockMidiMessage mockMidiLog[kMockMidiLog];
+
+void mockReset() {
+    mockDrawCalls = 0;
+    mockMidiMessages = 0;
+    mockParameterSets = 0;
+}
+
+extern "C" {
+
+void NT_drawText(int, int, const char*, int, _NT_textAlignment, _NT_textSize) {
+    mockDrawCalls++;
+}
+
+void NT_drawShapeI(_NT_shape, int, int, int, int, int) {
+    mockDrawCalls++;
+}
+
+void NT_sendMidi3ByteMessage(uint32_t, uint8_t status, uint8_t data1, uint8_t data2) {
+    if (mockMidiMessages < kMockMidiLog) {
+        MockMidiMessage& m = mockMidiLog[mockMidiMessages];
+        m.status = status;
+        m.data1 = data1;
+        m.data2 = data2;
+    }
+    mockMidiMessages++;
+}
+
+int32_t NT_algorithmIndex(const _NT_algorithm*) {
+    return 0;
+}
+
+uint32_t NT_parameterOffset(void) {
+    return 0;
+}
+
+void NT_setParameterFromAudio(uint32_t, uint32_t, int16_t) {
+    mockParameterSets++;
+}
+
+void NT_setParameterFromUi(uint32_t, uint32_t, int16_t) {
+    mockParameterSets++;
+}
+
+}
+
+// JSON tokens, in fixed storage so recording and playback never allocate
+enum {
+    kTokenName,
+    kTokenNumber,
+    kTokenString,
+    kTokenOpenArray,
+    kTokenCloseArray,
+    kTokenOpenObject,
+    kTokenCloseObject
+};
+
+struct JsonToken {
+    uint8_t kind;
+    int number;
+    const char* text;
+};
+
+static const int kMaxTokens = 8192;
+static const int kTextBytes = 1 << 17;
+
+static JsonToken tokens[kMaxTokens];
+static int numTokens = 0;
+static int cursor = 0;
+static char text[kTextBytes];
+static int textUsed = 0;
+
+void mockJsonClear() {
+    numTokens = 0;
+    cursor = 0;
+    textUsed = 0;
+}
+
+void mockJsonRewind() {
+    cursor = 0;
+}
+
+int mockJsonTokens() {
+    return numTokens;
+}
+
+uint32_t mockJsonHash() {
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < numTokens; i++) {
+        const JsonToken& t = tokens[i];
+        hash = (hash ^ t.kind) * 16777619u;
+        hash = (hash ^ (uint32_t)t.number) * 16777619u;
+        for (const char* c = t.text; c && *c; c++) {
+            hash = (hash ^ (uint8_t)*c) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+static void addToken(uint8_t kind, int number = 0, const char* str = NULL) {
+    if (numTokens >= kMaxTokens) return;
+    JsonToken& t = tokens[numTokens++];
+    t.kind = kind;
+    t.number = number;
+    t.text = NULL;
+    if (str) {
+        int len = (int)strlen(str) + 1;
+        if (textUsed + len > kTextBytes) return;
+        memcpy(text + textUsed, str, len);
+        t.text = text + textUsed;
+        textUsed += len;
+    }
+}
+
+void _NT_jsonStream::openArray() { addToken(kTokenOpenArray); }
+void _NT_jsonStream::closeArray() { addToken(kTokenCloseArray); }
+void _NT_jsonStream::openObject() { addToken(kTokenOpenObject); }
+void _NT_jsonStream::closeObject() { addToken(kTokenCloseObject); }
+void _NT_jsonStream::addMemberName(const char* name) { addToken(kTokenName, 0, name); }
+void _NT_jsonStream::addNumber(int value) { addToken(kTokenNumber, value); }
+void _NT_jsonStream::addNumber(float value) { addToken(kTokenNumber, (int)value); }
+void _NT_jsonStream::addString(const char* str) { addToken(kTokenString, 0, str); }
+void _NT_jsonStream::addFourCC(uint32_t fourcc) { addToken(kTokenNumber, (int)fourcc); }
+void _NT_jsonStream::addBoolean(bool value) { addToken(kTokenNumber, value ? 1 : 0); }
+void _NT_jsonStream::addNull() { addToken(kTokenNumber); }
+
+// The parser is driven by element counts, so closing brackets are skipped before each read
+static void skipCloses() {
+    while (cursor < numTokens &&
+           (tokens[cursor].kind == kTokenCloseArray || tokens[cursor].kind == kTokenCloseObject)) {
+        cursor++;
+    }
+}
+
+// Index just past the value starting at 'p'
+static int skipValue(int p) {
+    int depth = 0;
+    do {
+        if (p >= numTokens) return numTokens;
+        uint8_t kind = tokens[p].kind;
+        if (kind == kTokenOpenArray || kind == kTokenOpenObject) depth++;
+        if (kind == kTokenCloseArray || kind == kTokenCloseObject) depth--;
+        p++;
+    } while (depth > 0);
+    return p;
+}
+
+bool _NT_jsonParse::numberOfObjectMembers(int& num) {
+    skipCloses();
+    int p = cursor;
+    if (p < numTokens && tokens[p].kind == kTokenOpenObject) {
+        cursor = ++p;
+    }
+    num = 0;
+    while (p < numTokens && tokens[p].kind == kTokenName) {
+        num++;
+        p = skipValue(p + 1);
+    }
+    return true;
+}
+
+bool _NT_jsonParse::numberOfArrayElements(int& num) {
+    skipCloses();
+    if (cursor >= numTokens || tokens[cursor].kind != kTokenOpenArray) return false;
+    int p = cursor + 1;
+    num = 0;
+    while (p < numTokens && tokens[p].kind != kTokenCloseArray) {
+        p = skipValue(p);
+        num++;
+    }
+    cursor++;
+    return true;
+}
+
+bool _NT_jsonParse::matchName(const char* name) {
+    skipCloses();
+    if (cursor >= numTokens || tokens[cursor].kind != kTokenName || strcmp(tokens[cursor].text, name) != 0) return false;
+    cursor++;
+    return true;
+}
+
+bool _NT_jsonParse::skipMember() {
+    skipCloses();
+    if (cursor >= numTokens || tokens[cursor].kind != kTokenName) return false;
+    cursor = skipValue(cursor + 1);
+    return true;
+}
+
+bool _NT_jsonParse::number(int& value) {
+    skipCloses();
+    if (cursor >= numTokens || tokens[cursor].kind != kTokenNumber) return false;
+    value = tokens[cursor++].number;
+    return true;
+}
+
+bool _NT_jsonParse::number(float& value) {
+    int i;
+    if (!number(i)) return false;
+    value = (float)i;
+    return true;
+}
+
+bool _NT_jsonParse::boolean(bool& value) {
+    int i;
+    if (!number(i)) return false;
+    value = i != 0;
+    return true;
+}
+
+bool _NT_jsonParse::string(const char*& value) {
+    skipCloses();
+    if (cursor >= numTokens || tokens[cursor].kind != kTokenString) return false;
+    value = tokens[cursor++].text;
+    return true;
+}
+
+bool _NT_jsonParse::null() {
+    int i;
+    return number(i);
+}
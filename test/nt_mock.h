@@ -0,0 +1,30 @@
+// Host implementation of the Disting NT API functions src/main.cpp calls, with counters and a
+// JSON token store so tests can inspect what the plugin did. See stub/distingnt/api.h.
+#pragma once
+
+#include <distingnt/api.h>
+#include <distingnt/serialisation.h>
+
+// Calls counted since the last mockReset()
+extern int mockDrawCalls;           // NT_drawText and NT_drawShapeI
+extern int mockMidiMessages;        // NT_sendMidi3ByteMessage
+extern int mockParameterSets;       // NT_setParameterFromAudio and NT_setParameterFromUi
+
+void mockReset();
+
+// The first kMockMidiLog MIDI messages sent since the last mockReset(), oldest first
+struct MockMidiMessage {
+    uint8_t status;
+    uint8_t data1;
+    uint8_t data2;
+};
+
+static const int kMockMidiLog = 1024;
+extern MockMidiMessage mockMidiLog[kMockMidiLog];
+
+// JSON written through _NT_jsonStream is kept as tokens; _NT_jsonParse reads them back from
+// the start after mockJsonRewind(). mockJsonClear() drops them before a new document.
+void mockJsonClear();
+void mockJsonRewind();
+int mockJsonTokens();
+uint32_t mockJsonHash();            // FNV-1a over every token, for comparing documents
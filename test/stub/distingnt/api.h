@@ -0,0 +1,193 @@
+// Host stand-in for the Disting NT API header, for building src/main.cpp in the host tests.
+// Only what the plugin uses is declared; layouts follow the real API so the plugin source
+// compiles unchanged. The functions are implemented by nt_mock.cpp.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define NT_MULTICHAR(a, b, c, d) (((uint32_t)(a) << 0) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+
+enum { kNT_apiVersionCurrent = 6 };
+
+enum _NT_selector {
+    kNT_selector_version,
+    kNT_selector_numFactories,
+    kNT_selector_factoryInfo,
+};
+
+struct _NT_globals {
+    uint32_t sampleRate;
+    uint32_t maxFramesPerStep;
+    float* workBuffer;
+    uint32_t workBufferSizeBytes;
+};
+
+extern const _NT_globals NT_globals;
+extern uint8_t NT_screen[128 * 64];
+
+enum _NT_textSize { kNT_textTiny, kNT_textNormal, kNT_textLarge };
+enum _NT_textAlignment { kNT_textLeft, kNT_textCentre, kNT_textRight };
+enum _NT_shape { kNT_point, kNT_line, kNT_box, kNT_circle, kNT_rectangle };
+
+enum {
+    kNT_destinationBreakout = 1,
+    kNT_destinationSelectBus = 2,
+    kNT_destinationUSB = 4,
+    kNT_destinationInternal = 8,
+};
+
+enum {
+    kNT_unitNone,
+    kNT_unitEnum,
+    kNT_unitDb,
+    kNT_unitDb_minInf,
+    kNT_unitPercent,
+    kNT_unitHz,
+    kNT_unitSemitones,
+    kNT_unitCents,
+    kNT_unitMs,
+    kNT_unitSeconds,
+    kNT_unitFrames,
+    kNT_unitMIDINote,
+    kNT_unitMillivolts,
+    kNT_unitVolts,
+    kNT_unitBPM,
+    kNT_unitAudioInput = 100,
+    kNT_unitCvInput,
+    kNT_unitAudioOutput,
+    kNT_unitCvOutput,
+    kNT_unitOutputMode,
+};
+
+enum { kNT_scalingNone, kNT_scaling10, kNT_scaling100, kNT_scaling1000 };
+enum { kNT_typeGeneric, kNT_typeChannels, kNT_typeTrigger };
+enum { kNT_tagInstrument = 1 << 0, kNT_tagEffect = 1 << 1, kNT_tagFilter = 1 << 2, kNT_tagUtility = 1 << 9 };
+
+enum {
+    kNT_button1 = (1 << 0),
+    kNT_button2 = (1 << 1),
+    kNT_button3 = (1 << 2),
+    kNT_button4 = (1 << 3),
+    kNT_potButtonL = (1 << 4),
+    kNT_potButtonC = (1 << 5),
+    kNT_potButtonR = (1 << 6),
+    kNT_encoderButtonL = (1 << 7),
+    kNT_encoderButtonR = (1 << 8),
+    kNT_encoderL = (1 << 9),
+    kNT_encoderR = (1 << 10),
+    kNT_potL = (1 << 11),
+    kNT_potC = (1 << 12),
+    kNT_potR = (1 << 13),
+};
+
+struct _NT_parameter {
+    const char* name;
+    int16_t min;
+    int16_t max;
+    int16_t def;
+    uint8_t unit;
+    uint8_t scaling;
+    char const* const* enumStrings;
+};
+
+struct _NT_parameterPage {
+    const char* name;
+    uint8_t numParams;
+    uint8_t group;
+    uint8_t unused[2];
+    const uint8_t* params;
+};
+
+struct _NT_parameterPages {
+    uint32_t numPages;
+    const _NT_parameterPage* pages;
+};
+
+struct _NT_specification {
+    const char* name;
+    int32_t min;
+    int32_t max;
+    int32_t def;
+    int32_t type;
+};
+
+struct _NT_staticRequirements {
+    uint32_t dram;
+};
+
+struct _NT_staticMemoryPtrs {
+    uint8_t* dram;
+};
+
+struct _NT_algorithmRequirements {
+    uint32_t numParameters;
+    uint32_t sram;
+    uint32_t dram;
+    uint32_t dtc;
+    uint32_t itc;
+};
+
+struct _NT_algorithmMemoryPtrs {
+    uint8_t* sram;
+    uint8_t* dram;
+    uint8_t* dtc;
+    uint8_t* itc;
+};
+
+struct _NT_algorithm {
+    _NT_algorithm() : parameters(NULL), parameterPages(NULL), vIncludingCommon(NULL), v(NULL) {}
+    
+    const _NT_parameter* parameters;
+    const _NT_parameterPages* parameterPages;
+    const int16_t* vIncludingCommon;
+    const int16_t* v;
+};
+
+struct _NT_uiData {
+    float pots[3];
+    uint16_t controls;
+    uint16_t lastButtons;
+    int8_t encoders[2];
+    uint8_t unused[2];
+};
+
+typedef float _NT_float3[3];
+
+class _NT_jsonStream;
+class _NT_jsonParse;
+
+struct _NT_factory {
+    uint32_t guid;
+    const char* name;
+    const char* description;
+    uint32_t numSpecifications;
+    const _NT_specification* specifications;
+    void (*calculateStaticRequirements)(_NT_staticRequirements& req);
+    void (*initialise)(_NT_staticMemoryPtrs& ptrs, const _NT_staticRequirements& req);
+    void (*calculateRequirements)(_NT_algorithmRequirements& req, const int32_t* specifications);
+    _NT_algorithm* (*construct)(const _NT_algorithmMemoryPtrs& ptrs, const _NT_algorithmRequirements& req, const int32_t* specifications);
+    void (*parameterChanged)(_NT_algorithm* self, int p);
+    void (*step)(_NT_algorithm* self, float* busFrames, int numFramesBy4);
+    bool (*draw)(_NT_algorithm* self);
+    void (*midiRealtime)(_NT_algorithm* self, uint8_t byte);
+    void (*midiMessage)(_NT_algorithm* self, uint8_t byte0, uint8_t byte1, uint8_t byte2);
+    uint32_t tags;
+    uint32_t (*hasCustomUi)(_NT_algorithm* self);
+    void (*customUi)(_NT_algorithm* self, const _NT_uiData& data);
+    void (*setupUi)(_NT_algorithm* self, _NT_float3& pots);
+    void (*serialise)(_NT_algorithm* self, _NT_jsonStream& stream);
+    bool (*deserialise)(_NT_algorithm* self, _NT_jsonParse& parse);
+    void (*midiSysEx)(uint8_t byte, bool end);
+};
+
+extern "C" {
+void NT_drawText(int x, int y, const char* str, int colour = 15, _NT_textAlignment align = kNT_textLeft, _NT_textSize size = kNT_textNormal);
+void NT_drawShapeI(_NT_shape shape, int x0, int y0, int x1, int y1, int colour = 15);
+void NT_sendMidi3ByteMessage(uint32_t destination, uint8_t b0, uint8_t b1, uint8_t b2);
+int32_t NT_algorithmIndex(const _NT_algorithm* algorithm);
+uint32_t NT_parameterOffset(void);
+void NT_setParameterFromAudio(uint32_t algorithmIndex, uint32_t parameter, int16_t value);
+void NT_setParameterFromUi(uint32_t algorithmIndex, uint32_t parameter, int16_t value);
+uintptr_t pluginEntry(_NT_selector selector, uint32_t data);
+}
@@ -0,0 +1,44 @@
+// Host stand-in for the Disting NT JSON serialisation header. nt_mock.cpp records what
+// serialise() writes and plays it back to deserialise().
+#pragma once
+
+#include <stdint.h>
+
+class _NT_jsonStream {
+public:
+    _NT_jsonStream(void* refCon) : refCon(refCon) {}
+    
+    void openArray();
+    void closeArray();
+    void openObject();
+    void closeObject();
+    void addMemberName(const char* name);
+    void addNumber(int value);
+    void addNumber(float value);
+    void addString(const char* str);
+    void addFourCC(uint32_t fourcc);
+    void addBoolean(bool value);
+    void addNull();
+    
+private:
+    void* refCon;
+};
+
+class _NT_jsonParse {
+public:
+    _NT_jsonParse(void* refCon, int idx) : refCon(refCon), idx(idx) {}
+    
+    bool numberOfObjectMembers(int& num);
+    bool numberOfArrayElements(int& num);
+    bool matchName(const char* name);
+    bool skipMember();
+    bool number(int& value);
+    bool number(float& value);
+    bool boolean(bool& value);
+    bool string(const char*& value);
+    bool null();
+    
+private:
+    void* refCon;
+    int idx;
+};
@@ -1,3 +1,12 @@
+// Unit tests for the sequencer as shipped: src/main.cpp is built into this file against the stub
+// API headers in stub/, so the tests clock the real step() and use the real customUi() while
+// still reading the engine's track cursors.
+
+#include "nt_mock.h"
+#include "vseq_host.h"
+#include "../src/main.cpp"
+
+#include <chrono>
 #include <cstdint>
 #include <cstring>
 #include <iostream>
@@ -40,414 +49,96 @@ int failedTests = 0;
     } \
 } while(0)
 
-#define TEST_F(fixture, name) void test_##fixture##_##name()
+#define TEST_F(fixture, name) void test_##fixture##_##name(VSeqTest& vseq)
 
 class VSeqSequencerTest {
 protected:
     void SetUp() {}
 };
 
-// Mock distingNT API structures and globals
-struct _NT_algorithm {
-    float v[128];  // Parameter values
-};
-
-// Mock UI data structure
-struct _NT_uiData {
-    float pots[3];          // current pot positions [0.0-1.0]
-    uint16_t controls;      // current button states, and which pots changed
-    uint16_t lastButtons;   // previous button states
-    int8_t encoders[2];     // encoder change ±1 or 0
-    uint8_t unused[2];
-};
-
-// Mock control constants
-enum {
-    kNT_button1         = (1<<0),
-    kNT_button2         = (1<<1),
-    kNT_button3         = (1<<2),
-    kNT_button4         = (1<<3),
-    kNT_potButtonL      = (1<<4),
-    kNT_potButtonC      = (1<<5),
-    kNT_potButtonR      = (1<<6),
-    kNT_encoderButtonL  = (1<<7),
-    kNT_encoderButtonR  = (1<<8),
-    kNT_encoderL        = (1<<9),
-    kNT_encoderR        = (1<<10),
-    kNT_potL            = (1<<11),
-    kNT_potC            = (1<<12),
-    kNT_potR            = (1<<13),
-};
+static const int32_t kFullSpecs[] = { 3, 6, 32, 1 };
+static const int kBlock = 32;
 
-uint8_t NT_screen[128 * 64];  // Mock screen buffer
-
-// Include VSeq struct definition (we'll extract it to a header later)
-// For now, copy the struct with only what we need for testing
-
-struct VSeqTest : public _NT_algorithm {
-    // Sequencer data: 4 sequencers × 32 steps × 3 outputs
-    int16_t stepValues[4][32][3];
-    uint8_t stepMode[4][32];
-    bool gateSteps[6][32];
-    
-    // Sequencer state
-    int currentStep[4];
-    bool pingpongForward[4];
-    int ratchetCounter[4];
-    int repeatCounter[4];
-    int section1Counter[4];
-    int section2Counter[4];
-    bool inSection2[4];
-    
-    // Gate sequencer state (6 tracks)
-    int gateCurrentStep[6];
-    bool gatePingpongForward[6];
-    int gateSwingCounter[6];
-    int gateSection1Counter[6];
-    int gateSection2Counter[6];
-    bool gateInSection2[6];
-    bool gateInFill[6];
-    int gateTriggerCounter[6];
-    bool gateTriggered[6];
-    
-    float lastClockIn;
-    float lastResetIn;
-    int selectedStep;
-    int selectedSeq;
-    int selectedTrack;
-    int lastSelectedStep;
-    uint16_t lastButton4State;
-    uint16_t lastEncoderRButton;
-    float lastPotLValue;
-    bool potCaught[3];
-    bool trackPotCaught;
-    int debugOutputBus[12];
-    
-    VSeqTest() {
-        // Initialize everything to default state
-        for (int seq = 0; seq < 4; seq++) {
-            for (int step = 0; step < 32; step++) {
-                for (int out = 0; out < 3; out++) {
-                    stepValues[seq][step][out] = 0;
-                }
-                stepMode[seq][step] = 0;
-            }
-            currentStep[seq] = 0;
-            pingpongForward[seq] = true;
-            ratchetCounter[seq] = 0;
-            repeatCounter[seq] = 0;
-            section1Counter[seq] = 0;
-            section2Counter[seq] = 0;
-            inSection2[seq] = false;
-        }
-        
+// A full size instance (3 CV sequencers, 6 trigger tracks, 32 steps, by default one pattern bank)
+// with every trigger track running. Each clock() is one block with a clock edge on its first
+// frame, so every track at x1 takes one step.
+struct VSeqTest {
+    Instance inst;
+    VSeq* a;
+    std::vector<float> buses;
+    
+    explicit VSeqTest(const int32_t* specs = kFullSpecs) : inst(0, specs), buses(kNumBuses * kBlock) {
+        a = (VSeq*)inst.algo;
+        char name[32];
         for (int track = 0; track < 6; track++) {
-            for (int step = 0; step < 32; step++) {
-                gateSteps[track][step] = false;
-            }
-            gateCurrentStep[track] = 0;
-            gatePingpongForward[track] = true;
-            gateSwingCounter[track] = 0;
-            gateSection1Counter[track] = 0;
-            gateSection2Counter[track] = 0;
-            gateInSection2[track] = false;
-            gateInFill[track] = false;
-            gateTriggerCounter[track] = 0;
-            gateTriggered[track] = false;
-        }
-        
-        lastClockIn = 0.0f;
-        lastResetIn = 0.0f;
-        selectedStep = 0;
-        selectedSeq = 0;
-        selectedTrack = 0;
-        lastSelectedStep = 0;
-        lastButton4State = 0;
-        lastEncoderRButton = 0;
-        lastPotLValue = 0.5f;
-        potCaught[0] = false;
-        potCaught[1] = false;
-        potCaught[2] = false;
-        trackPotCaught = false;
-        
-        for (int i = 0; i < 12; i++) {
-            debugOutputBus[i] = 0;
+            snprintf(name, sizeof(name), "Gate %d Run", track + 1);
+            inst.set(name, 1);
         }
     }
     
-    // CV sequencer advancement
-    void advanceSequencer(int seq, int direction, int stepCount, int splitPoint, int sec1Reps, int sec2Reps) {
-        // If no sections (splitPoint >= stepCount), use simple wrapping logic
-        if (splitPoint >= stepCount) {
-            if (direction == 0) {
-                // Forward
-                currentStep[seq]++;
-                if (currentStep[seq] >= stepCount) {
-                    currentStep[seq] = 0;
-                }
-            } else if (direction == 1) {
-                // Backward
-                currentStep[seq]--;
-                if (currentStep[seq] < 0) {
-                    currentStep[seq] = stepCount - 1;
-                }
-            } else {
-                // Pingpong
-                if (pingpongForward[seq]) {
-                    currentStep[seq]++;
-                    if (currentStep[seq] >= stepCount) {
-                        currentStep[seq] = stepCount - 1;  // Stay at max
-                        pingpongForward[seq] = false;  // Reverse direction
-                    }
-                } else {
-                    currentStep[seq]--;
-                    if (currentStep[seq] < 0) {
-                        currentStep[seq] = 0;  // Stay at min
-                        pingpongForward[seq] = true;  // Reverse direction
-                    }
-                }
-            }
-            return;
-        }
-        
-        // Section-based logic
-        if (direction == 0) {
-            // Forward
-            currentStep[seq]++;
-            
-            if (!inSection2[seq]) {
-                if (currentStep[seq] >= splitPoint) {
-                    section1Counter[seq]++;
-                    if (section1Counter[seq] >= sec1Reps) {
-                        inSection2[seq] = true;
-                        section1Counter[seq] = 0;
-                    } else {
-                        currentStep[seq] = 0;
-                    }
-                }
-            } else {
-                if (currentStep[seq] >= stepCount) {
-                    section2Counter[seq]++;
-                    if (section2Counter[seq] >= sec2Reps) {
-                        inSection2[seq] = false;
-                        section2Counter[seq] = 0;
-                        currentStep[seq] = 0;
-                    } else {
-                        currentStep[seq] = splitPoint;
-                    }
-                }
-            }
-        } else if (direction == 1) {
-            // Backward
-            currentStep[seq]--;
-            
-            if (inSection2[seq]) {
-                if (currentStep[seq] < splitPoint) {
-                    section2Counter[seq]++;
-                    if (section2Counter[seq] >= sec2Reps) {
-                        inSection2[seq] = false;
-                        section2Counter[seq] = 0;
-                    } else {
-                        currentStep[seq] = stepCount - 1;
-                    }
-                }
-            } else {
-                if (currentStep[seq] < 0) {
-                    section1Counter[seq]++;
-                    if (section1Counter[seq] >= sec1Reps) {
-                        inSection2[seq] = true;
-                        section1Counter[seq] = 0;
-                        currentStep[seq] = stepCount - 1;
-                    } else {
-                        currentStep[seq] = splitPoint - 1;
-                    }
-                }
-            }
-        } else {
-            // Pingpong
-            if (pingpongForward[seq]) {
-                currentStep[seq]++;
-                if (currentStep[seq] >= stepCount) {
-                    currentStep[seq] = stepCount - 1;
-                    pingpongForward[seq] = false;
-                }
-            } else {
-                currentStep[seq]--;
-                if (currentStep[seq] <= 0) {
-                    currentStep[seq] = 0;
-                    pingpongForward[seq] = true;
-                }
-            }
-        }
+    // Configure a CV sequencer (direction 0 = forward, 1 = backward, 2 = pingpong)
+    void configureSequencer(int seq, int direction, int stepCount, int splitPoint, int sec1Reps, int sec2Reps) {
+        char name[32];
+        snprintf(name, sizeof(name), "Seq %d Direction", seq + 1);
+        inst.set(name, direction);
+        snprintf(name, sizeof(name), "Seq %d Steps", seq + 1);
+        inst.set(name, stepCount);
+        snprintf(name, sizeof(name), "Seq %d Split Point", seq + 1);
+        inst.set(name, splitPoint);
+        snprintf(name, sizeof(name), "Seq %d Sec1 Reps", seq + 1);
+        inst.set(name, sec1Reps);
+        snprintf(name, sizeof(name), "Seq %d Sec2 Reps", seq + 1);
+        inst.set(name, sec2Reps);
     }
     
-    // Gate sequencer advancement
-    void advanceGateSequencer(int track, int direction, int trackLength, int splitPoint, 
-                              int sec1Reps, int sec2Reps, int fillStart) {
-        // If no sections (splitPoint >= trackLength), use simple wrapping logic
-        if (splitPoint >= trackLength) {
-            if (direction == 0) {
-                // Forward
-                gateCurrentStep[track]++;
-                if (gateCurrentStep[track] >= trackLength) {
-                    gateCurrentStep[track] = 0;
-                }
-            } else if (direction == 1) {
-                // Backward
-                gateCurrentStep[track]--;
-                if (gateCurrentStep[track] < 0) {
-                    gateCurrentStep[track] = trackLength - 1;
-                }
-            } else if (direction == 2) {
-                // Pingpong
-                if (gatePingpongForward[track]) {
-                    gateCurrentStep[track]++;
-                    if (gateCurrentStep[track] >= trackLength) {
-                        gateCurrentStep[track] = trackLength - 2;
-                        if (gateCurrentStep[track] < 0) gateCurrentStep[track] = 0;
-                        gatePingpongForward[track] = false;
-                    }
-                } else {
-                    gateCurrentStep[track]--;
-                    if (gateCurrentStep[track] < 0) {
-                        gateCurrentStep[track] = 1;
-                        if (gateCurrentStep[track] >= trackLength) gateCurrentStep[track] = trackLength - 1;
-                        gatePingpongForward[track] = true;
-                    }
-                }
-            }
-            return;
-        }
-        
-        // Section-based logic
-        int section1End = (splitPoint > 0 && splitPoint < trackLength) ? splitPoint : trackLength;
-        
-        if (direction == 0) {  // Forward
-            gateCurrentStep[track]++;
-            
-            // Check for fill trigger on last repetition of section 1
-            if (!gateInSection2[track] && 
-                splitPoint > 0 && 
-                splitPoint < trackLength &&  // Only if sections are actually being used
-                fillStart > 0 &&  // Only if fill is enabled (fillStart > 0)
-                fillStart < splitPoint &&
-                sec1Reps > 1 &&  // Only if repeating section 1
-                gateSection1Counter[track] == sec1Reps - 1 &&
-                gateCurrentStep[track] >= fillStart) {
-                gateSection1Counter[track] = 0;
-                gateInSection2[track] = true;
-                gateCurrentStep[track] = splitPoint;
-            }
-            else if (!gateInSection2[track] && gateCurrentStep[track] >= section1End) {
-                gateSection1Counter[track]++;
-                if (gateSection1Counter[track] >= sec1Reps) {
-                    gateSection1Counter[track] = 0;
-                    gateInSection2[track] = true;
-                    gateCurrentStep[track] = (splitPoint > 0) ? splitPoint : 0;
-                } else {
-                    gateCurrentStep[track] = 0;
-                }
-            } else if (gateInSection2[track] && gateCurrentStep[track] >= trackLength) {
-                gateSection2Counter[track]++;
-                if (gateSection2Counter[track] >= sec2Reps) {
-                    gateSection2Counter[track] = 0;
-                    gateInSection2[track] = false;
-                }
-                gateCurrentStep[track] = (splitPoint > 0) ? splitPoint : 0;
-                if (!gateInSection2[track]) {
-                    gateCurrentStep[track] = 0;
-                }
-            }
-        } else if (direction == 1) {  // Backward
-            gateCurrentStep[track]--;
-            
-            if (gateInSection2[track] && gateCurrentStep[track] < splitPoint) {
-                gateSection2Counter[track]++;
-                if (gateSection2Counter[track] >= sec2Reps) {
-                    gateSection2Counter[track] = 0;
-                    gateInSection2[track] = false;
-                    gateCurrentStep[track] = section1End - 1;
-                } else {
-                    gateCurrentStep[track] = trackLength - 1;
-                }
-            } else if (!gateInSection2[track] && gateCurrentStep[track] < 0) {
-                gateSection1Counter[track]++;
-                if (gateSection1Counter[track] >= sec1Reps) {
-                    gateSection1Counter[track] = 0;
-                    gateInSection2[track] = true;
-                    gateCurrentStep[track] = trackLength - 1;
-                } else {
-                    gateCurrentStep[track] = section1End - 1;
-                }
-            }
-        } else if (direction == 2) {  // Pingpong
-            if (gatePingpongForward[track]) {
-                gateCurrentStep[track]++;
-                if (gateCurrentStep[track] >= trackLength) {
-                    gateCurrentStep[track] = trackLength - 2;
-                    if (gateCurrentStep[track] < 0) gateCurrentStep[track] = 0;
-                    gatePingpongForward[track] = false;
-                }
-            } else {
-                gateCurrentStep[track]--;
-                if (gateCurrentStep[track] < 0) {
-                    gateCurrentStep[track] = 1;
-                    if (gateCurrentStep[track] >= trackLength) gateCurrentStep[track] = trackLength - 1;
-                    gatePingpongForward[track] = true;
-                }
-            }
-        }
+    // Configure a gate track; fillStart 0 = no fill (a fill start at or past the split never fires)
+    void configureGateTrack(int track, int direction, int trackLength, int splitPoint, int sec1Reps, int sec2Reps,
+                            int fillStart) {
+        char name[32];
+        snprintf(name, sizeof(name), "Gate %d Direction", track + 1);
+        inst.set(name, direction);
+        snprintf(name, sizeof(name), "Gate %d Length", track + 1);
+        inst.set(name, trackLength);
+        snprintf(name, sizeof(name), "Gate %d Split", track + 1);
+        inst.set(name, splitPoint);
+        snprintf(name, sizeof(name), "Gate %d Sec1 Reps", track + 1);
+        inst.set(name, sec1Reps);
+        snprintf(name, sizeof(name), "Gate %d Sec2 Reps", track + 1);
+        inst.set(name, sec2Reps);
+        snprintf(name, sizeof(name), "Gate %d Fill Start", track + 1);
+        inst.set(name, fillStart > 0 ? fillStart : trackLength);
     }
     
-    // UI function for testing track selection with catch behavior
-    void customUi(const _NT_uiData& data) {
-        // Gate sequencer mode (seq 3)
-        if (selectedSeq == 3) {
-            // Left pot: select track (0-5) with catch behavior
-            if (data.controls & kNT_potL) {
-                float potValue = data.pots[0];
-                
-                // Calculate virtual position for current track
-                float trackPosition = selectedTrack / 5.0f;
-                
-                // Check if pot has caught the track position
-                if (!trackPotCaught) {
-                    if (fabsf(potValue - trackPosition) < 0.05f) {
-                        trackPotCaught = true;
-                    }
-                }
-                
-                // Only allow track changes when caught
-                if (trackPotCaught) {
-                    // Map pot to track with hysteresis
-                    int newTrack;
-                    if (potValue < 0.10f) newTrack = 0;
-                    else if (potValue < 0.30f) newTrack = 1;
-                    else if (potValue < 0.50f) newTrack = 2;
-                    else if (potValue < 0.70f) newTrack = 3;
-                    else if (potValue < 0.90f) newTrack = 4;
-                    else newTrack = 5;
-                    
-                    // If track changed, reset catch
-                    if (newTrack != selectedTrack) {
-                        selectedTrack = newTrack;
-                        trackPotCaught = false;
-                    }
-                }
-            }
+    void clock() {
+        memset(buses.data(), 0, buses.size() * sizeof(float));
+        for (int frame = 0; frame < 5; frame++) {
+            buses[frame] = 5.0f;    // Clock in is bus 1
         }
+        inst.factory->step(inst.algo, buses.data(), kBlock / 4);
+    }
+    
+    // One block with no clock edge
+    void step() {
+        memset(buses.data(), 0, buses.size() * sizeof(float));
+        inst.factory->step(inst.algo, buses.data(), kBlock / 4);
+    }
+    
+    // Queue a step edit in the playing bank, as the editor does; step() applies it on the next block
+    void edit(int type, int lane, int step, int out, int value) {
+        StepEdit e = { (uint8_t)type, (uint8_t)a->activeBank(), (uint8_t)lane, (uint8_t)step, (uint8_t)out,
+                       (int16_t)value };
+        a->edits.push(e);
+        a->edits.commit();
     }
+    
+    TrackState& sequencer(int seq) { return a->tracks[seq]; }
+    TrackState& gateTrack(int track) { return a->tracks[a->dims.cvSeqs + track]; }
 };
 
-// Standalone customUi function for VSeqTest
-void customUi(_NT_algorithm* self, const _NT_uiData& data) {
-    VSeqTest* vseq = static_cast<VSeqTest*>(self);
-    vseq->customUi(data);
+static void customUi(VSeqTest& vseq, const _NT_uiData& data) {
+    vseq.inst.factory->customUi(vseq.inst.algo, data);
 }
 
-// Test fixture
-VSeqTest vseq;
-
 // ============================================================================
 // CV Sequencer Tests
 // ============================================================================
@@ -455,80 +146,156 @@ VSeqTest vseq;
 TEST_F(VSeqSequencerTest, CVForwardBasic) {
     // Test basic forward sequencing with 8 steps
     // Start at 0, advance 8 times should go through 1,2,3,4,5,6,7,0
+    vseq.configureSequencer(0, 0, 8, 8, 1, 1);  // direction=0 (forward), 8 steps, no sections
     for (int i = 1; i <= 8; i++) {
-        vseq.advanceSequencer(0, 0, 8, 8, 1, 1);  // direction=0 (forward), 8 steps, no sections
+        vseq.clock();
         int expected = (i < 8) ? i : 0;  // After 8th advance, should wrap to 0
-        EXPECT_EQ(vseq.currentStep[0], expected);
+        EXPECT_EQ(vseq.sequencer(0).step, expected);
     }
 }
 
 TEST_F(VSeqSequencerTest, CVBackwardBasic) {
     // Start at step 7 for backward
-    vseq.currentStep[0] = 7;
+    vseq.configureSequencer(0, 1, 8, 8, 1, 1);  // direction=1 (backward)
+    vseq.sequencer(0).step = 7;
     
     // Advance backward 8 times: 7→6,5,4,3,2,1,0,7
     for (int i = 6; i >= -1; i--) {
-        vseq.advanceSequencer(0, 1, 8, 8, 1, 1);  // direction=1 (backward)
+        vseq.clock();
         int expected = (i >= 0) ? i : 7;  // After going below 0, should wrap to 7
-        EXPECT_EQ(vseq.currentStep[0], expected);
+        EXPECT_EQ(vseq.sequencer(0).step, expected);
     }
 }
 
 TEST_F(VSeqSequencerTest, CVPingpongBasic) {
-    // Test pingpong motion - starts at 0, direction forward
-    std::vector<int> expectedSteps = {1, 2, 3, 4, 5, 6, 7, 7, 6, 5, 4, 3, 2, 1, 0, 0, 1, 2};
+    // Test pingpong motion - starts at 0, direction forward, end steps play once
+    std::vector<int> expectedSteps = {1, 2, 3, 4, 5, 6, 7, 6, 5, 4, 3, 2, 1, 0, 1, 2};
+    vseq.configureSequencer(0, 2, 8, 8, 1, 1);  // direction=2 (pingpong)
     
     for (int expected : expectedSteps) {
-        vseq.advanceSequencer(0, 2, 8, 8, 1, 1);  // direction=2 (pingpong)
-        EXPECT_EQ(vseq.currentStep[0], expected);
+        vseq.clock();
+        EXPECT_EQ(vseq.sequencer(0).step, expected);
     }
 }
 
 TEST_F(VSeqSequencerTest, CVSectionLooping) {
     // Test section 1 repeating 3 times before moving to section 2
     // splitPoint=4, sec1Reps=3, sec2Reps=1
+    vseq.configureSequencer(0, 0, 8, 4, 3, 1);
     
     // First loop of section 1 (0→1,2,3,0 - wraps after reaching splitPoint 4)
     for (int i = 0; i < 4; i++) {
-        vseq.advanceSequencer(0, 0, 8, 4, 3, 1);
+        vseq.clock();
         int expected = (i < 3) ? (i + 1) : 0;  // 1,2,3,0
-        EXPECT_EQ(vseq.currentStep[0], expected);
-        EXPECT_FALSE(vseq.inSection2[0]);
+        EXPECT_EQ(vseq.sequencer(0).step, expected);
+        EXPECT_FALSE(vseq.sequencer(0).inSection2);
     }
     
     // Second loop of section 1
     for (int i = 0; i < 4; i++) {
-        vseq.advanceSequencer(0, 0, 8, 4, 3, 1);
+        vseq.clock();
         int expected = (i < 3) ? (i + 1) : 0;
-        EXPECT_EQ(vseq.currentStep[0], expected);
-        EXPECT_FALSE(vseq.inSection2[0]);
+        EXPECT_EQ(vseq.sequencer(0).step, expected);
+        EXPECT_FALSE(vseq.sequencer(0).inSection2);
     }
     
     // Third loop of section 1
     for (int i = 0; i < 4; i++) {
-        vseq.advanceSequencer(0, 0, 8, 4, 3, 1);
+        vseq.clock();
         if (i < 3) {
             int expected = i + 1;  // 1,2,3
-            EXPECT_EQ(vseq.currentStep[0], expected);
-            EXPECT_FALSE(vseq.inSection2[0]);
+            EXPECT_EQ(vseq.sequencer(0).step, expected);
+            EXPECT_FALSE(vseq.sequencer(0).inSection2);
         } else {
             // After 3rd rep completes, moves to section 2
-            EXPECT_EQ(vseq.currentStep[0], 4);  // Jumps to splitPoint
-            EXPECT_TRUE(vseq.inSection2[0]);
+            EXPECT_EQ(vseq.sequencer(0).step, 4);  // Jumps to splitPoint
+            EXPECT_TRUE(vseq.sequencer(0).inSection2);
         }
     }
     
     // Now in section 2 (steps 4-7, continues to 8 then wraps)
     for (int i = 0; i < 4; i++) {
-        vseq.advanceSequencer(0, 0, 8, 4, 3, 1);
+        vseq.clock();
         if (i < 3) {
-            EXPECT_EQ(vseq.currentStep[0], 5 + i);  // 5,6,7
-            EXPECT_TRUE(vseq.inSection2[0]);
+            EXPECT_EQ(vseq.sequencer(0).step, 5 + i);  // 5,6,7
+            EXPECT_TRUE(vseq.sequencer(0).inSection2);
         } else {
             // After section 2 completes, wraps back to section 1
-            EXPECT_EQ(vseq.currentStep[0], 0);
-            EXPECT_FALSE(vseq.inSection2[0]);
+            EXPECT_EQ(vseq.sequencer(0).step, 0);
+            EXPECT_FALSE(vseq.sequencer(0).inSection2);
+        }
+    }
+}
+
+TEST_F(VSeqSequencerTest, GlideRampLength) {
+    // A glide step ramps over its output's slew time from the clock edge, across block ends,
+    // and lands on the step value; a step without glide jumps on its edge
+    vseq.configureSequencer(0, 0, 4, 4, 1, 1);
+    vseq.inst.set("Seq 1 Out 1", 13);
+    vseq.inst.set("Seq 1 Slew 1", 2);   // 96 frames at 48kHz
+    for (int step = 0; step < 4; step++) {
+        vseq.edit(kEditCvValue, 0, step, 0, (step & 1) ? 32767 : -32768);
+    }
+    vseq.edit(kEditCvGlide, 0, 1, 0, 0);
+    const float* out = vseq.buses.data() + 12 * kBlock;
+    
+    std::vector<float> frames;
+    for (int block = 0; block < 16; block++) {
+        if (block % 8 == 0) {
+            vseq.clock();
+        } else {
+            vseq.step();
+        }
+        frames.insert(frames.end(), out, out + kBlock);
+    }
+    
+    // Step 1 glides from 0V to 1V, then step 2 jumps back
+    int landed = -1;
+    bool rising = true;
+    for (int frame = 1; frame < 8 * kBlock; frame++) {
+        if (frames[frame] < frames[frame - 1]) rising = false;
+        if (landed < 0 && frames[frame] == 1.0f) landed = frame;
+    }
+    EXPECT_EQ(landed, 96);
+    EXPECT_TRUE(rising);
+    EXPECT_TRUE(frames[48] > 0.49f && frames[48] < 0.51f);
+    EXPECT_EQ(frames[8 * kBlock - 1], 1.0f);
+    EXPECT_EQ(frames[8 * kBlock], 0.0f);
+    
+    // An exponential glide is about 1% short of its target at the end of the slew time, where it
+    // lands on it
+    vseq.inst.set("Seq 1 Glide Shape", 1);
+    vseq.clock();
+    vseq.clock();
+    EXPECT_EQ(vseq.sequencer(0).step, 0);
+    frames.clear();
+    for (int block = 0; block < 8; block++) {
+        if (block == 0) {
+            vseq.clock();
+        } else {
+            vseq.step();
+        }
+        frames.insert(frames.end(), out, out + kBlock);
+    }
+    EXPECT_TRUE(frames[24] > 0.5f);
+    EXPECT_TRUE(frames[95] > 0.985f && frames[95] < 1.0f);
+    EXPECT_EQ(frames[96], 1.0f);
+}
+
+TEST_F(VSeqSequencerTest, ModInputHysteresis) {
+    // At 3.2 steps per volt 1.0V and 1.1V both add 3 steps and 1.2V adds 4. Coming back down,
+    // 1.1V holds the 4 until the input is clearly below it.
+    vseq.configureSequencer(0, 0, 16, 16, 1, 1);
+    vseq.inst.set("Mod 1 In", 20);
+    static const float volts[] = { 1.0f, 1.1f, 1.2f, 1.1f, 0.9f, 0.0f };
+    static const int lengths[] = { 19, 19, 20, 20, 19, 16 };
+    for (int i = 0; i < 6; i++) {
+        memset(vseq.buses.data(), 0, vseq.buses.size() * sizeof(float));
+        for (int frame = 0; frame < kBlock; frame++) {
+            vseq.buses[19 * kBlock + frame] = volts[i];
         }
+        vseq.inst.factory->step(vseq.inst.algo, vseq.buses.data(), kBlock / 4);
+        EXPECT_EQ((int)vseq.sequencer(0).length, lengths[i]);
     }
 }
 
@@ -538,70 +305,74 @@ TEST_F(VSeqSequencerTest, CVSectionLooping) {
 
 TEST_F(VSeqSequencerTest, GateForwardBasic) {
     // Test basic forward sequencing with 16 steps
+    vseq.configureGateTrack(0, 0, 16, 16, 1, 1, 0);
     for (int i = 1; i <= 16; i++) {
-        vseq.advanceGateSequencer(0, 0, 16, 16, 1, 1, 0);
+        vseq.clock();
         int expected = (i < 16) ? i : 0;  // After 16th advance, wraps to 0
-        EXPECT_EQ(vseq.gateCurrentStep[0], expected);
+        EXPECT_EQ(vseq.gateTrack(0).step, expected);
     }
 }
 
 TEST_F(VSeqSequencerTest, GateBackwardBasic) {
     // Start at step 15 for backward
-    vseq.gateCurrentStep[0] = 15;
+    vseq.configureGateTrack(0, 1, 16, 16, 1, 1, 0);
+    vseq.gateTrack(0).step = 15;
     
     // Advance backward 16 times
     for (int i = 14; i >= -1; i--) {
-        vseq.advanceGateSequencer(0, 1, 16, 16, 1, 1, 0);
+        vseq.clock();
         int expected = (i >= 0) ? i : 15;  // After going below 0, wraps to 15
-        EXPECT_EQ(vseq.gateCurrentStep[0], expected);
+        EXPECT_EQ(vseq.gateTrack(0).step, expected);
     }
 }
 
 TEST_F(VSeqSequencerTest, GatePingpongBasic) {
     // Test pingpong motion with 8 steps - starts at 0, forward
     std::vector<int> expectedSteps = {1, 2, 3, 4, 5, 6, 7, 6, 5, 4, 3, 2, 1, 0, 1, 2};
+    vseq.configureGateTrack(0, 2, 8, 8, 1, 1, 0);
     
     for (int expected : expectedSteps) {
-        vseq.advanceGateSequencer(0, 2, 8, 8, 1, 1, 0);
-        EXPECT_EQ(vseq.gateCurrentStep[0], expected);
+        vseq.clock();
+        EXPECT_EQ(vseq.gateTrack(0).step, expected);
     }
 }
 
 TEST_F(VSeqSequencerTest, GateSectionLooping) {
     // Test section 1 repeating 2 times before section 2
     // splitPoint=8, trackLength=16, sec1Reps=2, sec2Reps=1
+    vseq.configureGateTrack(0, 0, 16, 8, 2, 1, 0);
     
     // First loop of section 1 (0→1,2,3,4,5,6,7,0)
     for (int i = 0; i < 8; i++) {
-        vseq.advanceGateSequencer(0, 0, 16, 8, 2, 1, 0);
+        vseq.clock();
         int expected = (i < 7) ? (i + 1) : 0;  // 1,2,3,4,5,6,7,0
-        EXPECT_EQ(vseq.gateCurrentStep[0], expected);
-        EXPECT_FALSE(vseq.gateInSection2[0]);
+        EXPECT_EQ(vseq.gateTrack(0).step, expected);
+        EXPECT_FALSE(vseq.gateTrack(0).inSection2);
     }
     
     // Second loop of section 1
     for (int i = 0; i < 8; i++) {
-        vseq.advanceGateSequencer(0, 0, 16, 8, 2, 1, 0);
+        vseq.clock();
         if (i < 7) {
-            EXPECT_EQ(vseq.gateCurrentStep[0], i + 1);  // 1,2,3,4,5,6,7
-            EXPECT_FALSE(vseq.gateInSection2[0]);
+            EXPECT_EQ(vseq.gateTrack(0).step, i + 1);  // 1,2,3,4,5,6,7
+            EXPECT_FALSE(vseq.gateTrack(0).inSection2);
         } else {
             // After 2nd rep, moves to section 2
-            EXPECT_EQ(vseq.gateCurrentStep[0], 8);  // Jumps to splitPoint
-            EXPECT_TRUE(vseq.gateInSection2[0]);
+            EXPECT_EQ(vseq.gateTrack(0).step, 8);  // Jumps to splitPoint
+            EXPECT_TRUE(vseq.gateTrack(0).inSection2);
         }
     }
     
     // Now in section 2 (steps 8-15)
     for (int i = 0; i < 8; i++) {
-        vseq.advanceGateSequencer(0, 0, 16, 8, 2, 1, 0);
+        vseq.clock();
         if (i < 7) {
-            EXPECT_EQ(vseq.gateCurrentStep[0], 9 + i);  // 9,10,11,12,13,14,15
-            EXPECT_TRUE(vseq.gateInSection2[0]);
+            EXPECT_EQ(vseq.gateTrack(0).step, 9 + i);  // 9,10,11,12,13,14,15
+            EXPECT_TRUE(vseq.gateTrack(0).inSection2);
         } else {
             // After section 2, wraps back to section 1
-            EXPECT_EQ(vseq.gateCurrentStep[0], 0);
-            EXPECT_FALSE(vseq.gateInSection2[0]);
+            EXPECT_EQ(vseq.gateTrack(0).step, 0);
+            EXPECT_FALSE(vseq.gateTrack(0).inSection2);
         }
     }
 }
@@ -609,172 +380,1021 @@ TEST_F(VSeqSequencerTest, GateSectionLooping) {
 TEST_F(VSeqSequencerTest, GateFillFeature) {
     // Test fill triggering jump to section 2
     // splitPoint=8, fillStart=6, sec1Reps=2
+    vseq.configureGateTrack(0, 0, 16, 8, 2, 1, 6);
     
     // First loop of section 1 - normal playback (0→1,2,3,4,5,6,7,0)
     for (int i = 0; i < 8; i++) {
-        vseq.advanceGateSequencer(0, 0, 16, 8, 2, 1, 6);
-        EXPECT_FALSE(vseq.gateInSection2[0]);
+        vseq.clock();
+        EXPECT_FALSE(vseq.gateTrack(0).inSection2);
     }
     
     // Second loop (last rep) - advance until step 5 (before fill trigger)
     for (int i = 0; i < 5; i++) {
-        vseq.advanceGateSequencer(0, 0, 16, 8, 2, 1, 6);
-        EXPECT_FALSE(vseq.gateInSection2[0]);
+        vseq.clock();
+        EXPECT_FALSE(vseq.gateTrack(0).inSection2);
     }
     
     // Next advance reaches step 6, should trigger fill and jump to section 2
-    vseq.advanceGateSequencer(0, 0, 16, 8, 2, 1, 6);
-    EXPECT_TRUE(vseq.gateInSection2[0]);
-    EXPECT_EQ(vseq.gateCurrentStep[0], 8);  // Should jump to splitPoint
+    vseq.clock();
+    EXPECT_TRUE(vseq.gateTrack(0).inSection2);
+    EXPECT_EQ(vseq.gateTrack(0).step, 8);  // Should jump to splitPoint
 }
 
 TEST_F(VSeqSequencerTest, GateBackwardSectionLooping) {
     // Test backward with sections
-    vseq.gateCurrentStep[0] = 15;
-    vseq.gateInSection2[0] = true;
+    vseq.configureGateTrack(0, 1, 16, 8, 1, 1, 0);
+    vseq.gateTrack(0).step = 15;
+    vseq.gateTrack(0).inSection2 = true;
     
     // Play section 2 backward (15→14,13,12,11,10,9,8,7)
     // After reaching splitPoint (8), it should move to section 1
     for (int i = 14; i >= 7; i--) {
-        vseq.advanceGateSequencer(0, 1, 16, 8, 1, 1, 0);
+        vseq.clock();
         if (i >= 8) {
-            EXPECT_EQ(vseq.gateCurrentStep[0], i);
-            EXPECT_TRUE(vseq.gateInSection2[0]);
+            EXPECT_EQ(vseq.gateTrack(0).step, i);
+            EXPECT_TRUE(vseq.gateTrack(0).inSection2);
         } else {
             // At step 7 (section1End - 1), moved to section 1
-            EXPECT_EQ(vseq.gateCurrentStep[0], 7);
-            EXPECT_FALSE(vseq.gateInSection2[0]);
+            EXPECT_EQ(vseq.gateTrack(0).step, 7);
+            EXPECT_FALSE(vseq.gateTrack(0).inSection2);
+        }
+    }
+}
+
+TEST_F(VSeqSequencerTest, RatchetsSpreadOverStep) {
+    // A ratcheted step fires its triggers evenly over the measured step period, from the
+    // step's own clock edge, and the next step's edge ends them
+    vseq.inst.set("Gate 1 Out", 15);
+    vseq.configureGateTrack(0, 0, 4, 4, 1, 1, 0);
+    for (int step = 0; step < 4; step++) {
+        vseq.edit(kEditGateSet, 0, step, 0, 1);
+    }
+    vseq.edit(kEditGateRatchet, 0, 2, 0, 4);
+    vseq.edit(kEditGateRatchet, 0, 3, 0, 3);
+    
+    // A clock every 8 blocks, so every step is 256 frames
+    const float* out = vseq.buses.data() + 14 * kBlock;
+    std::vector<int> edges;
+    float last = 0.0f;
+    for (int block = 0; block < 32; block++) {
+        if (block % 8 == 0) {
+            vseq.clock();
+        } else {
+            vseq.step();
+        }
+        for (int frame = 0; frame < kBlock; frame++) {
+            if (out[frame] > 0.0f && last == 0.0f) edges.push_back(block * kBlock + frame);
+            last = out[frame];
+        }
+    }
+    static const int expected[] = { 0, 256, 320, 384, 448, 512, 597, 682, 768 };
+    EXPECT_EQ((int)edges.size(), 9);
+    for (int i = 0; i < 9 && i < (int)edges.size(); i++) {
+        EXPECT_EQ(edges[i], expected[i]);
+    }
+}
+
+TEST_F(VSeqSequencerTest, ChancePlaysItsShare) {
+    // A step at 4/8 chance plays about half its clocks, 1/8 about an eighth, and a step that
+    // does not play fires none of its ratchets
+    vseq.inst.set("Gate 1 Out", 15);
+    vseq.inst.set("Gate 2 Out", 16);
+    vseq.configureGateTrack(0, 0, 1, 1, 1, 1, 0);
+    vseq.configureGateTrack(1, 0, 1, 1, 1, 1, 0);
+    vseq.edit(kEditGateSet, 0, 0, 0, 1);
+    vseq.edit(kEditGateChance, 0, 0, 0, 4);
+    vseq.edit(kEditGateSet, 1, 0, 0, 1);
+    vseq.edit(kEditGateChance, 1, 0, 0, 7);
+    vseq.edit(kEditGateRatchet, 1, 0, 0, 2);
+    
+    const float* half = vseq.buses.data() + 14 * kBlock;
+    const float* eighth = vseq.buses.data() + 15 * kBlock;
+    int halfTriggers = 0;
+    int eighthTriggers = 0;
+    float lastHalf = 0.0f;
+    float lastEighth = 0.0f;
+    const int kClocks = 800;
+    for (int block = 0; block < kClocks * 8; block++) {
+        if (block % 8 == 0) {
+            vseq.clock();
+        } else {
+            vseq.step();
+        }
+        for (int frame = 0; frame < kBlock; frame++) {
+            if (half[frame] > 0.0f && lastHalf == 0.0f) halfTriggers++;
+            if (eighth[frame] > 0.0f && lastEighth == 0.0f) eighthTriggers++;
+            lastHalf = half[frame];
+            lastEighth = eighth[frame];
+        }
+    }
+    EXPECT_TRUE(halfTriggers > kClocks * 4 / 10 && halfTriggers < kClocks * 6 / 10);
+    
+    // Two ratchets for every step that plays
+    EXPECT_EQ(eighthTriggers % 2, 0);
+    EXPECT_TRUE(eighthTriggers / 2 > kClocks / 16 && eighthTriggers / 2 < kClocks * 3 / 16);
+}
+
+TEST_F(VSeqSequencerTest, EuclideanAndBake) {
+    // Three hits in eight rotated by one play steps 1, 4 and 7. Bake writes those states into
+    // the stored steps, keeping their ratchets, and hands the generator parameter back to Off.
+    vseq.inst.set("Gate 1 Out", 15);
+    vseq.configureGateTrack(0, 0, 8, 8, 1, 1, 0);
+    vseq.inst.set("Gate 1 Generator", kGeneratorEuclidean);
+    vseq.inst.set("Gate 1 Hits", 3);
+    vseq.inst.set("Gate 1 Rotate", 1);
+    vseq.edit(kEditGateRatchet, 0, 4, 0, 2);
+    const float* out = vseq.buses.data() + 14 * kBlock;
+    
+    uint32_t played = 0;
+    for (int i = 0; i < 8; i++) {
+        vseq.clock();
+        if (out[0] > 0.0f) played |= 1u << vseq.gateTrack(0).step;
+        for (int block = 1; block < 8; block++) {
+            vseq.step();
+        }
+    }
+    EXPECT_EQ(played, 0x92u);
+    
+    mockReset();
+    vseq.inst.set("Gate 1 Bake", 1);
+    vseq.step();
+    EXPECT_EQ(mockParameterSets, 2);
+    vseq.inst.set("Gate 1 Bake", 0);
+    vseq.inst.set("Gate 1 Generator", kGeneratorOff);
+    const uint8_t* steps = vseq.a->gateSteps(0);
+    uint32_t baked = 0;
+    for (int step = 0; step < 8; step++) {
+        if (gateState(steps[step]) == 1) baked |= 1u << step;
+    }
+    EXPECT_EQ(baked, 0x92u);
+    EXPECT_EQ(gateRatchets(steps[4]), 2);
+    
+    played = 0;
+    for (int i = 0; i < 8; i++) {
+        vseq.clock();
+        if (out[0] > 0.0f) played |= 1u << vseq.gateTrack(0).step;
+        for (int block = 1; block < 8; block++) {
+            vseq.step();
+        }
+    }
+    EXPECT_EQ(played, 0x92u);
+}
+
+// Count the next kPlanSteps ticks of a track whose steps differ from what its plan said
+static int planMisses(VSeqTest& vseq, int track) {
+    TrackPlan plan = vseq.a->tracks[track].plan;
+    int misses = 0;
+    for (int ticks = 1; ticks <= kPlanSteps; ticks++) {
+        vseq.clock();
+        const PlannedStep& p = plan.ahead(ticks);
+        if (!TrackPlan::matches(p, vseq.a->tracks[track]) ||
+            ((p.flags & kPlanSection2) != 0) != vseq.a->tracks[track].inSection2) misses++;
+    }
+    return misses;
+}
+
+TEST_F(VSeqSequencerTest, PlanAfterEdits) {
+    // The plan lists the steps the next ticks really play, and is made again after the edits
+    // that move them: a length and split change, and a section reset from the editor
+    vseq.configureGateTrack(0, 2, 12, 5, 2, 1, 3);
+    vseq.configureSequencer(0, 0, 16, 8, 2, 2);
+    for (int i = 0; i < 5; i++) {
+        vseq.clock();
+    }
+    int gate = vseq.a->dims.cvSeqs;
+    int gateMisses = planMisses(vseq, gate);
+    int seqMisses = planMisses(vseq, 0);
+    EXPECT_EQ(gateMisses, 0);
+    EXPECT_EQ(seqMisses, 0);
+    
+    vseq.inst.set("Gate 1 Length", 7);
+    vseq.inst.set("Gate 1 Split", 3);
+    StepEdit e = { kEditSectionReset, 0, 0, 0, 0, 4 };
+    vseq.a->edits.push(e);
+    vseq.a->edits.commit();
+    vseq.step();
+    EXPECT_EQ((int)vseq.a->tracks[0].plan.generation, (int)vseq.a->tracks[0].tableGeneration);
+    gateMisses = planMisses(vseq, gate);
+    EXPECT_EQ(gateMisses, 0);
+    
+    // The section reset set the split from the audio side; the host echoes it back
+    vseq.inst.set("Seq 1 Split Point", 4);
+    vseq.inst.set("Seq 1 Sec1 Reps", 1);
+    vseq.inst.set("Seq 1 Sec2 Reps", 1);
+    vseq.step();
+    seqMisses = planMisses(vseq, 0);
+    EXPECT_EQ(seqMisses, 0);
+}
+
+// ============================================================================
+// Clock Tests
+// ============================================================================
+
+TEST_F(VSeqSequencerTest, InternalClockNoDrift) {
+    // Two hours of the internal clock at 175.3 BPM give exactly 175.3 * 4 * 120 16th notes
+    static const int kFrames = 128;
+    static const long kTotalFrames = 48000L * 60 * 120;
+    vseq.inst.set("Clock Source", 2);
+    vseq.inst.set("Tempo", 1753);
+    std::vector<float> buses(kNumBuses * kFrames, 0.0f);
+    for (long frame = 0; frame < kTotalFrames; frame += kFrames) {
+        vseq.inst.factory->step(vseq.inst.algo, buses.data(), kFrames / 4);
+    }
+    EXPECT_EQ(vseq.a->clockPosition, 84144u);
+}
+
+// ============================================================================
+// Clock Link Tests
+// ============================================================================
+
+// Give the plugin the static memory the instances share, which the mock host never does. The
+// plugin keeps the first block it is given, so every test shares this one.
+static void initialiseStatic(const _NT_factory* factory) {
+    static std::vector<uint8_t> shared;
+    if (!shared.empty()) return;
+    _NT_staticRequirements req = { 0 };
+    factory->calculateStaticRequirements(req);
+    shared.assign(req.dram, 0);
+    _NT_staticMemoryPtrs ptrs = { shared.data() };
+    factory->initialise(ptrs, req);
+}
+
+TEST_F(VSeqSequencerTest, FollowerLocksToLead) {
+    // A follower with no clock patched joins a lead already playing and, from the lead's next
+    // clock on, writes every output sample the lead does, through uneven clocks and a reset.
+    // The lead is reset after it has measured the clock, so its x4 sequencer has played every
+    // sub-tick since, as a follower moving to the lead's position assumes.
+    initialiseStatic(vseq.inst.factory);
+    
+    Instance lead(0, kFullSpecs);
+    Instance follower(0, kFullSpecs);
+    Instance* both[2] = { &lead, &follower };
+    for (int i = 0; i < 2; i++) {
+        configure(*both[i], 3, 6, kClockDivX1);
+        loadPattern(*both[i], 3, 6, 32);
+        both[i]->set("Seq 2 Clock Div", 6);     // x4
+        both[i]->set("Gate 3 ClockDiv", 2);     // /4
+    }
+    lead.set("Clock Link", kClockLinkLead);
+    follower.set("Clock Link", kClockLinkFollow);
+    
+    std::vector<float> leadBuses(kNumBuses * kBlock);
+    std::vector<float> followerBuses(kNumBuses * kBlock);
+    int mismatches = 0;
+    int nextClock = 0;
+    for (int block = 0; block < 3000; block++) {
+        memset(leadBuses.data(), 0, leadBuses.size() * sizeof(float));
+        for (int frame = 0; frame < kBlock; frame++) {
+            int t = block * kBlock + frame;
+            if (t >= nextClock && t < nextClock + 5) leadBuses[frame] = 5.0f;
+            if (t == nextClock + 4) nextClock += (block < 1200) ? 256 : 200 + (t % 7) * 13;
+            if ((block == 96 || block == 1700) && frame < 5) leadBuses[kBlock + frame] = 5.0f;
+        }
+        lead.factory->step(lead.algo, leadBuses.data(), kBlock / 4);
+        if (block < 500) continue;
+        
+        memset(followerBuses.data(), 0, followerBuses.size() * sizeof(float));
+        follower.factory->step(follower.algo, followerBuses.data(), kBlock / 4);
+        if (block < 504) continue;
+        for (int i = 2 * kBlock; i < kNumBuses * kBlock; i++) {
+            if (leadBuses[i] != followerBuses[i]) mismatches++;
+        }
+    }
+    EXPECT_EQ(mismatches, 0);
+    VSeq* l = (VSeq*)lead.algo;
+    VSeq* f = (VSeq*)follower.algo;
+    for (int track = 0; track < 9; track++) {
+        EXPECT_EQ((int)f->tracks[track].step, (int)l->tracks[track].step);
+    }
+}
+
+TEST_F(VSeqSequencerTest, FollowerJoinsFarIntoSong) {
+    // A follower joining a lead that a song position pointer sent to the last 16th puts its
+    // pingpong tracks there within the block, and then plays what the lead plays
+    initialiseStatic(vseq.inst.factory);
+    Instance lead(0, kFullSpecs);
+    Instance follower(0, kFullSpecs);
+    Instance* both[2] = { &lead, &follower };
+    for (int i = 0; i < 2; i++) {
+        configure(*both[i], 3, 6, kClockDivX1);
+        loadPattern(*both[i], 3, 6, 32);
+        both[i]->set("Seq 1 Direction", 2);
+        both[i]->set("Seq 2 Direction", 2);
+        both[i]->set("Seq 2 Clock Div", 8);     // x16
+        both[i]->set("Gate 1 Direction", 2);
+        both[i]->set("Gate 1 ClockDiv", 8);
+    }
+    lead.set("Clock Source", 1);
+    lead.set("Clock Link", kClockLinkLead);
+    follower.set("Clock Link", kClockLinkFollow);
+    
+    const int kPosition = 16383;
+    std::vector<float> leadBuses(kNumBuses * kBlock);
+    std::vector<float> followerBuses(kNumBuses * kBlock);
+    int mismatches = 0;
+    double joinMs = 0;
+    for (int block = 0; block < 600; block++) {
+        if (block == 0) {
+            lead.factory->midiMessage(lead.algo, 0xF2, kPosition & 0x7F, kPosition >> 7);
+            lead.factory->midiRealtime(lead.algo, 0xFB);
+        }
+        if (block % 4 == 0) lead.factory->midiRealtime(lead.algo, 0xF8);
+        memset(leadBuses.data(), 0, leadBuses.size() * sizeof(float));
+        lead.factory->step(lead.algo, leadBuses.data(), kBlock / 4);
+        
+        memset(followerBuses.data(), 0, followerBuses.size() * sizeof(float));
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        follower.factory->step(follower.algo, followerBuses.data(), kBlock / 4);
+        if (block == 0) {
+            joinMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        for (int i = 2 * kBlock; i < kNumBuses * kBlock; i++) {
+            if (leadBuses[i] != followerBuses[i]) mismatches++;
+        }
+    }
+    EXPECT_TRUE(joinMs < 1.0);
+    EXPECT_EQ(mismatches, 0);
+    VSeq* l = (VSeq*)lead.algo;
+    VSeq* f = (VSeq*)follower.algo;
+    EXPECT_EQ(f->clockPosition, l->clockPosition);
+    for (int track = 0; track < 9; track++) {
+        EXPECT_EQ((int)f->tracks[track].step, (int)l->tracks[track].step);
+    }
+}
+
+// ============================================================================
+// Output Tests
+// ============================================================================
+
+TEST_F(VSeqSequencerTest, OutputsReplaceBusContents) {
+    // An output with an unchanged value still writes every frame, over whatever is on its bus
+    vseq.inst.set("Gate 1 Out", 5);
+    for (int i = 0; i < 4; i++) {
+        vseq.step();
+    }
+    memset(vseq.buses.data(), 0, vseq.buses.size() * sizeof(float));
+    float* out = vseq.buses.data() + 4 * kBlock;
+    for (int frame = 10; frame < 15; frame++) {
+        out[frame] = 5.0f;  // Another algorithm's pulse, mid-block
+    }
+    vseq.inst.factory->step(vseq.inst.algo, vseq.buses.data(), kBlock / 4);
+    int high = 0;
+    for (int frame = 0; frame < kBlock; frame++) {
+        if (out[frame] != 0.0f) high++;
+    }
+    EXPECT_EQ(high, 0);
+}
+
+TEST_F(VSeqSequencerTest, EditsApplyAtBlockStart) {
+    // Edits published together reach the outputs together from the first frame of the next
+    // block; edits staged but not yet published wait for their commit
+    vseq.inst.set("Seq 1 Out 1", 13);
+    vseq.inst.set("Seq 1 Out 2", 14);
+    vseq.step();
+    const float* out1 = vseq.buses.data() + 12 * kBlock;
+    const float* out2 = vseq.buses.data() + 13 * kBlock;
+    float before = out1[0];
+    
+    StepEdit e = { kEditCvValue, (uint8_t)vseq.a->activeBank(), 0, 0, 0, 32767 };
+    vseq.a->edits.push(e);
+    e.out = 1;
+    e.value = -32768;
+    vseq.a->edits.push(e);
+    vseq.step();
+    EXPECT_EQ(out1[kBlock - 1], before);
+    
+    vseq.a->edits.commit();
+    const int16_t* values = vseq.a->bankValues(*vseq.a->active, 0, 0);
+    EXPECT_TRUE(values[0] != 32767);
+    vseq.step();
+    int torn = 0;
+    for (int frame = 0; frame < kBlock; frame++) {
+        if (out1[frame] != 1.0f || out2[frame] != 0.0f) torn++;
+    }
+    EXPECT_EQ(torn, 0);
+    
+    // Applying an edit marks only its own step for the cache rebuild
+    vseq.edit(kEditCvValue, 1, 5, 2, 1000);
+    applyEdits(vseq.a);
+    EXPECT_EQ(vseq.a->active->dirty[0], 0u);
+    EXPECT_EQ(vseq.a->active->dirty[1], 1u << 5);
+    EXPECT_EQ(vseq.a->active->dirty[2], 0u);
+}
+
+TEST_F(VSeqSequencerTest, BankSwitchOnBoundary) {
+    // A queued switch waits for the lead sequencer's section end, or with Loop End for the
+    // pattern to come round, and changes the outputs on that clock edge's frame
+    static const int32_t twoBanks[] = { 3, 6, 32, 2 };
+    VSeqTest banked(twoBanks);
+    VSeq* a = banked.a;
+    banked.configureSequencer(0, 0, 8, 4, 1, 1);
+    banked.inst.set("Seq 1 Out 1", 13);
+    for (int step = 0; step < 8; step++) {
+        a->bankValues(a->banks[0], 0, step)[0] = -32768;    // 0V
+        a->bankValues(a->banks[1], 0, step)[0] = 32767;     // 1V, the top of the unquantised range
+    }
+    a->invalidateAllSteps();
+    const float* out = banked.buses.data() + 12 * kBlock;
+    
+    banked.clock();
+    banked.inst.set("Pattern", 2);
+    for (int step = 2; step <= 3; step++) {
+        banked.clock();
+        EXPECT_EQ(a->activeBank(), 0);
+        EXPECT_EQ(out[kBlock - 1], 0.0f);
+    }
+    banked.clock();
+    EXPECT_EQ(banked.sequencer(0).step, 4);
+    EXPECT_EQ(a->activeBank(), 1);
+    EXPECT_EQ(out[0], 1.0f);
+    
+    // Loop End passes the section end at step 4 and switches back at step 0
+    banked.inst.set("Pattern Switch", 1);
+    banked.inst.set("Pattern", 1);
+    int switchedAt = -1;
+    for (int i = 0; i < 8 && switchedAt < 0; i++) {
+        banked.clock();
+        if (a->activeBank() == 0) switchedAt = banked.sequencer(0).step;
+    }
+    EXPECT_EQ(switchedAt, 0);
+    EXPECT_EQ(out[0], 0.0f);
+}
+
+// ============================================================================
+// MIDI Tests
+// ============================================================================
+
+TEST_F(VSeqSequencerTest, GateCcEveryTrigger) {
+    // A track of identical hits sends its CC on every trigger, not just the first
+    vseq.inst.set("Trigger MIDI Ch", 10);
+    vseq.inst.set("Gate 1 CC", 20);
+    vseq.configureGateTrack(0, 0, 16, 16, 1, 1, 0);
+    for (int step = 0; step < 16; step++) {
+        vseq.edit(kEditGateSet, 0, step, 0, 1);
+    }
+    mockReset();
+    for (int i = 0; i < 16; i++) {
+        vseq.clock();
+    }
+    int ccs = 0;
+    for (int i = 0; i < mockMidiMessages; i++) {
+        if (mockMidiLog[i].status == 0xB9 && mockMidiLog[i].data1 == 20) ccs++;
+    }
+    EXPECT_EQ(ccs, 16);
+}
+
+TEST_F(VSeqSequencerTest, MidiClockBurstKeepsTempo) {
+    // Two MIDI clocks before one block share its start time; the second must not be timed
+    vseq.inst.set("Clock Source", 1);
+    const _NT_factory* f = vseq.inst.factory;
+    f->midiRealtime(vseq.inst.algo, 0xFA);
+    for (int i = 0; i < 8; i++) {
+        f->midiRealtime(vseq.inst.algo, 0xF8);
+        for (int block = 0; block < 8; block++) {
+            vseq.step();
+        }
+    }
+    EXPECT_EQ((int)vseq.a->midiClock.clockPeriod, 8 * kBlock);
+    f->midiRealtime(vseq.inst.algo, 0xF8);
+    f->midiRealtime(vseq.inst.algo, 0xF8);
+    vseq.step();
+    EXPECT_EQ((int)vseq.a->midiClock.clockPeriod, 8 * kBlock);
+}
+
+TEST_F(VSeqSequencerTest, MidiClockIgnoredWhileCv) {
+    // MIDI clock received while the CV clock drives the tracks is not replayed on switching
+    vseq.configureSequencer(0, 0, 8, 8, 1, 1);
+    const _NT_factory* f = vseq.inst.factory;
+    f->midiRealtime(vseq.inst.algo, 0xFA);
+    for (int i = 0; i < 12; i++) {
+        f->midiRealtime(vseq.inst.algo, 0xF8);
+        vseq.step();
+    }
+    EXPECT_EQ(vseq.sequencer(0).step, 0);
+    vseq.inst.set("Clock Source", 1);
+    vseq.step();
+    EXPECT_EQ(vseq.sequencer(0).step, 0);
+    EXPECT_FALSE(vseq.a->midiClock.running);
+    
+    // Once MIDI is the clock, Start and clocks play as usual: clocks 1 and 7 each take a step
+    f->midiRealtime(vseq.inst.algo, 0xFA);
+    for (int i = 0; i < 7; i++) {
+        f->midiRealtime(vseq.inst.algo, 0xF8);
+        vseq.step();
+    }
+    EXPECT_EQ(vseq.sequencer(0).step, 2);
+}
+
+TEST_F(VSeqSequencerTest, MidiClockMatchesCvClock) {
+    // MIDI Start and a clock every 4 blocks play exactly what a reset and a CV clock on every
+    // 6th of those MIDI clocks do: every output sample and every MIDI message
+    Instance midi(0, kFullSpecs);
+    Instance cv(0, kFullSpecs);
+    Instance* both[2] = { &midi, &cv };
+    for (int i = 0; i < 2; i++) {
+        configure(*both[i], 3, 6, kClockDivX1);
+        loadPattern(*both[i], 3, 6, 32);
+        both[i]->set("Seq 2 Clock Div", 5);     // x2
+        both[i]->set("Seq 3 Direction", 2);
+        both[i]->set("Gate 2 ClockDiv", 6);     // x4
+        both[i]->set("Gate 3 ClockDiv", 2);     // /4
+        both[i]->set("Gate 4 Split", 8);
+        both[i]->set("Gate 4 Sec1 Reps", 2);
+    }
+    midi.set("Clock Source", 1);
+    
+    std::vector<float> midiBuses(kNumBuses * kBlock);
+    std::vector<float> cvBuses(kNumBuses * kBlock);
+    std::vector<MockMidiMessage> midiSent;
+    int sampleMismatches = 0;
+    int messageMismatches = 0;
+    for (int block = 0; block < 6000; block++) {
+        if (block == 0) midi.factory->midiRealtime(midi.algo, 0xFA);
+        if (block % 4 == 0) midi.factory->midiRealtime(midi.algo, 0xF8);
+        memset(midiBuses.data(), 0, midiBuses.size() * sizeof(float));
+        mockReset();
+        midi.factory->step(midi.algo, midiBuses.data(), kBlock / 4);
+        midiSent.assign(mockMidiLog, mockMidiLog + mockMidiMessages);
+        
+        memset(cvBuses.data(), 0, cvBuses.size() * sizeof(float));
+        for (int frame = 0; frame < 5; frame++) {
+            if (block % 24 == 0) cvBuses[frame] = 5.0f;                 // Clock in is bus 1
+            if (block == 0) cvBuses[kBlock + frame] = 5.0f;             // Reset in is bus 2
+        }
+        mockReset();
+        cv.factory->step(cv.algo, cvBuses.data(), kBlock / 4);
+        
+        for (int i = 2 * kBlock; i < kNumBuses * kBlock; i++) {
+            if (midiBuses[i] != cvBuses[i]) sampleMismatches++;
+        }
+        if ((int)midiSent.size() != mockMidiMessages) {
+            messageMismatches++;
+            continue;
+        }
+        for (int i = 0; i < mockMidiMessages; i++) {
+            const MockMidiMessage& m = midiSent[i];
+            if (m.status != mockMidiLog[i].status || m.data1 != mockMidiLog[i].data1 ||
+                m.data2 != mockMidiLog[i].data2) messageMismatches++;
+        }
+    }
+    EXPECT_EQ(sampleMismatches, 0);
+    EXPECT_EQ(messageMismatches, 0);
+}
+
+TEST_F(VSeqSequencerTest, SongPositionMatchesPlayback) {
+    // A song position pointer puts every track where playing that many clocks from a reset
+    // would, swing parity included, over random lengths, directions, sections, fills and
+    // divisions
+    uint32_t state = 5;
+    char name[32];
+    int mismatches = 0;
+    for (int round = 0; round < 40; round++) {
+        Instance played(0, kFullSpecs);
+        Instance sought(0, kFullSpecs);
+        Instance* both[2] = { &played, &sought };
+        int settings[9][7];
+        for (int track = 0; track < 9; track++) {
+            int length = 1 + (int)(patternRandom(state) % 32);
+            settings[track][0] = (int)(patternRandom(state) % 9);                 // Division
+            settings[track][1] = (int)(patternRandom(state) % 3);                 // Direction
+            settings[track][2] = length;
+            settings[track][3] = 1 + (int)(patternRandom(state) % 31);            // Split
+            settings[track][4] = 1 + (int)(patternRandom(state) % 3);             // Section 1 repeats
+            settings[track][5] = 1 + (int)(patternRandom(state) % 3);             // Section 2 repeats
+            settings[track][6] = 1 + (int)(patternRandom(state) % length);        // Fill start
+        }
+        for (int i = 0; i < 2; i++) {
+            for (int seq = 0; seq < 3; seq++) {
+                static const char* const names[] = { "Clock Div", "Direction", "Steps", "Split Point",
+                                                     "Sec1 Reps", "Sec2 Reps" };
+                for (int p = 0; p < 6; p++) {
+                    snprintf(name, sizeof(name), "Seq %d %s", seq + 1, names[p]);
+                    both[i]->set(name, settings[seq][p]);
+                }
+            }
+            for (int track = 0; track < 6; track++) {
+                static const char* const names[] = { "ClockDiv", "Direction", "Length", "Split",
+                                                     "Sec1 Reps", "Sec2 Reps", "Fill Start" };
+                for (int p = 0; p < 7; p++) {
+                    snprintf(name, sizeof(name), "Gate %d %s", track + 1, names[p]);
+                    both[i]->set(name, settings[3 + track][p]);
+                }
+                snprintf(name, sizeof(name), "Gate %d Run", track + 1);
+                both[i]->set(name, 1);
+            }
+        }
+        sought.set("Clock Source", 1);
+        
+        // A clock edge every block, so each edge's sub-ticks finish within it. The clock runs
+        // for a few blocks before the reset, so the first edge after it knows the period.
+        int position = (int)(patternRandom(state) % 400);
+        std::vector<float> buses(kNumBuses * kBlock);
+        for (int block = -4; block < position; block++) {
+            memset(buses.data(), 0, buses.size() * sizeof(float));
+            for (int frame = 0; frame < 5; frame++) {
+                buses[frame] = 5.0f;
+                if (block == 0) buses[kBlock + frame] = 5.0f;
+            }
+            played.factory->step(played.algo, buses.data(), kBlock / 4);
+        }
+        sought.factory->midiMessage(sought.algo, 0xF2, position & 0x7F, position >> 7);
+        memset(buses.data(), 0, buses.size() * sizeof(float));
+        sought.factory->step(sought.algo, buses.data(), kBlock / 4);
+        
+        for (int track = 0; track < 9; track++) {
+            const TrackState& p = ((VSeq*)played.algo)->tracks[track];
+            const TrackState& s = ((VSeq*)sought.algo)->tracks[track];
+            if (p.step != s.step || p.forward != s.forward || p.inSection2 != s.inSection2 ||
+                p.sec1Counter != s.sec1Counter || p.sec2Counter != s.sec2Counter ||
+                p.divCounter != s.divCounter || (track >= 3 && p.swingCounter != s.swingCounter)) mismatches++;
+        }
+    }
+    EXPECT_EQ(mismatches, 0);
+}
+
+TEST_F(VSeqSequencerTest, PingpongSeekIsBounded) {
+    // The furthest song position puts pingpong tracks at x1 and x16 on the right step while
+    // walking no more than two cycles of each. The old walk of every tick took milliseconds.
+    vseq.inst.set("Clock Source", 1);
+    for (int seq = 0; seq < 3; seq++) {
+        vseq.configureSequencer(seq, 2, 32, 32, 1, 1);
+    }
+    for (int track = 0; track < 6; track++) {
+        vseq.configureGateTrack(track, 2, 32, 32, 1, 1, 0);
+    }
+    vseq.inst.set("Seq 2 Clock Div", 8);    // x16
+    vseq.inst.set("Gate 1 ClockDiv", 8);
+    
+    const int kPosition = 16383;
+    vseq.inst.factory->midiMessage(vseq.inst.algo, 0xF2, kPosition & 0x7F, kPosition >> 7);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    vseq.step();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_TRUE(ms < 1.0);
+    
+    // After tick k a 32 step pingpong is 'm' = (k - 1) % 62 ticks into 1 ... 31, 30 ... 0
+    for (int track = 0; track < 9; track++) {
+        int ticks = (track == 1 || track == 3) ? kPosition * 16 : kPosition;
+        int m = (ticks - 1) % 62;
+        EXPECT_EQ(vseq.a->tracks[track].step, (m < 31) ? m + 1 : 61 - m);
+    }
+}
+
+// ============================================================================
+// Display Tests
+// ============================================================================
+
+// Nibble-addressed reference for the blits: even pixels in the high nibble
+static void referencePixel(uint8_t* fb, int x, int y, int shade) {
+    if (x < 0 || x >= kScreenWidth || y < 0 || y >= kScreenHeight) return;
+    uint8_t& b = fb[(y * 128) + (x / 2)];
+    b = (x & 1) ? (uint8_t)((b & 0xF0) | shade) : (uint8_t)((b & 0x0F) | (shade << 4));
+}
+
+static int referenceShade(const uint8_t* fb, int x, int y) {
+    uint8_t b = fb[(y * 128) + (x / 2)];
+    return (x & 1) ? (b & 0x0F) : (b >> 4);
+}
+
+TEST_F(VSeqSequencerTest, BlitsMatchPixelReference) {
+    // fillRect, copyRect and blitSprite over random rectangles, some partly off screen, write
+    // exactly the pixels a pixel by pixel reference does
+    static uint8_t fast[kScreenBytes];
+    static uint8_t slow[kScreenBytes];
+    static uint8_t source[kScreenBytes];
+    uint32_t state = 7;
+    for (int i = 0; i < kScreenBytes; i++) {
+        fast[i] = slow[i] = (uint8_t)patternRandom(state);
+        source[i] = (uint8_t)patternRandom(state);
+    }
+    int mismatches = 0;
+    for (int round = 0; round < 3000; round++) {
+        int x0 = (int)(patternRandom(state) % 272) - 8;
+        int y0 = (int)(patternRandom(state) % 80) - 8;
+        int x1 = x0 + (int)(patternRandom(state) % 40);
+        int y1 = y0 + (int)(patternRandom(state) % 20);
+        int kind = (int)(patternRandom(state) % 3);
+        if (kind == 0) {
+            int colour = (int)(patternRandom(state) % 256);
+            fillRect(fast, x0, y0, x1, y1, colour);
+            for (int y = y0; y <= y1; y++) {
+                for (int x = x0; x <= x1; x++) {
+                    referencePixel(slow, x, y, colour >> 4);
+                }
+            }
+        } else if (kind == 1) {
+            copyRect(fast, source, x0, y0, x1, y1);
+            for (int y = y0; y <= y1; y++) {
+                for (int x = x0; x <= x1; x++) {
+                    if (x < 0 || x >= kScreenWidth || y < 0 || y >= kScreenHeight) continue;
+                    referencePixel(slow, x, y, referenceShade(source, x, y));
+                }
+            }
+        } else {
+            int sprite = (int)(patternRandom(state) % kNumSprites);
+            blitSprite(fast, sprite, x0, y0);
+            bool inside = x0 >= 0 && y0 >= 0 && x0 + kSpriteSize <= kScreenWidth && y0 + kSpriteSize <= kScreenHeight;
+            for (int r = 0; inside && r < kSpriteSize; r++) {
+                for (int c = 0; c < kSpriteSize; c++) {
+                    if (spriteShapes[sprite].rows[r] & (1 << c)) {
+                        referencePixel(slow, x0 + c, y0 + r, spriteShapes[sprite].shade);
+                    }
+                }
+            }
+        }
+        if (memcmp(fast, slow, kScreenBytes) != 0) mismatches++;
+        memcpy(fast, slow, kScreenBytes);
+    }
+    EXPECT_EQ(mismatches, 0);
+}
+
+TEST_F(VSeqSequencerTest, RetainedFrameMatchesRedraw) {
+    // Over a random editing run on every page, the retained frame shows exactly what a redraw
+    // from scratch does
+    static uint8_t retained[kScreenBytes];
+    uint32_t state = 11;
+    int mismatches = 0;
+    for (int round = 0; round < 1500; round++) {
+        int action = (int)(patternRandom(state) % 6);
+        int step = (int)(patternRandom(state) % 32);
+        int lane = (int)(patternRandom(state) % 6);
+        if (action == 0) {
+            vseq.edit(kEditCvValue, lane % 3, step, lane % 3, (int)(patternRandom(state) % 65536) - 32768);
+        } else if (action == 1) {
+            vseq.edit(kEditGateCycle, lane, step, 0, 0);
+        } else if (action == 2) {
+            vseq.edit(kEditGateRatchet, lane, step, 0, 1 + (int)(patternRandom(state) % kMaxRatchets));
+        } else if (action == 3) {
+            vseq.edit(kEditCvGlide, lane % 3, step, 0, 0);
+        } else if (action == 4) {
+            vseq.a->selectedSeq = (int)(patternRandom(state) % 4);
+            vseq.a->selectedTrack = lane;
+            vseq.a->selectedStep = step;
+            vseq.a->editGeneration++;
+        } else {
+            vseq.inst.set("Seq 1 Steps", 1 + (int)(patternRandom(state) % 32));
+        }
+        vseq.clock();
+        vseq.inst.factory->draw(vseq.inst.algo);
+        memcpy(retained, NT_screen, kScreenBytes);
+        
+        vseq.a->gridDirty = true;
+        vseq.a->editGeneration++;
+        vseq.inst.factory->draw(vseq.inst.algo);
+        if (memcmp(retained, NT_screen, kScreenBytes) != 0) mismatches++;
+    }
+    EXPECT_EQ(mismatches, 0);
+}
+
+TEST_F(VSeqSequencerTest, DrawLeavesUnchangedFrame) {
+    // With nothing edited and no playhead moved, draw() leaves the screen as it is and draws
+    // no text; the next edit presents the whole frame again
+    vseq.clock();
+    vseq.inst.factory->draw(vseq.inst.algo);
+    static uint8_t drawn[kScreenBytes];
+    memcpy(drawn, NT_screen, kScreenBytes);
+    
+    NT_screen[0] = 0x5A;
+    mockReset();
+    vseq.step();
+    vseq.inst.factory->draw(vseq.inst.algo);
+    EXPECT_EQ((int)NT_screen[0], 0x5A);
+    EXPECT_EQ(mockDrawCalls, 0);
+    
+    vseq.a->editGeneration++;
+    vseq.inst.factory->draw(vseq.inst.algo);
+    EXPECT_EQ(memcmp(drawn, NT_screen, kScreenBytes), 0);
+}
+
+// ============================================================================
+// Parameter Tests
+// ============================================================================
+
+TEST_F(VSeqSequencerTest, RecordTargetsWithoutTracks) {
+    // Without CV sequencers or gate tracks, Rec Seq and Rec Track still show a valid string
+    static const int32_t noCv[] = { 0, 6, 32, 1 };
+    static const int32_t noGates[] = { 3, 0, 32, 1 };
+    Instance gatesOnly(0, noCv);
+    Instance cvOnly(0, noGates);
+    const char* const* seqs = gatesOnly.algo->parameters[gatesOnly.param("Rec Seq")].enumStrings;
+    const char* const* gates = cvOnly.algo->parameters[cvOnly.param("Rec Track")].enumStrings;
+    EXPECT_EQ(std::string(seqs[0]), std::string("None"));
+    EXPECT_TRUE(seqs[1] == NULL);
+    EXPECT_EQ(std::string(gates[0]), std::string("None"));
+    EXPECT_TRUE(gates[1] == NULL);
+    
+    // With both, each lists its own tracks
+    const char* const* fullGates = vseq.a->parameters[vseq.inst.param("Rec Track")].enumStrings;
+    EXPECT_EQ(std::string(fullGates[0]), std::string("Gate 1"));
+    EXPECT_TRUE(fullGates[6] == NULL);
+}
+
+TEST_F(VSeqSequencerTest, RecordsInputsAtTicks) {
+    // At x16 each tick writes the CV and gate inputs on its own frame into the step it moved
+    // to. The CV input is a staircase with a new level every 16 frames, so every tick of a
+    // 256 frame clock records a different level.
+    vseq.configureSequencer(0, 0, 16, 16, 1, 1);
+    vseq.configureGateTrack(0, 0, 16, 16, 1, 1, 0);
+    vseq.inst.set("Seq 1 Clock Div", 8);    // x16
+    vseq.inst.set("Gate 1 ClockDiv", 8);
+    vseq.inst.set("Rec CV In", 20);
+    vseq.inst.set("Rec Out", 2);
+    vseq.inst.set("Rec Gate In", 21);
+    const int kCycle = 256;
+    
+    // Two clocks measure the period, then one cycle records
+    int seqStart = 0;
+    int gateStart = 0;
+    for (int cycle = 0; cycle < 3; cycle++) {
+        if (cycle == 2) {
+            vseq.inst.set("Record", 1);
+            seqStart = vseq.sequencer(0).step;
+            gateStart = vseq.gateTrack(0).step;
+        }
+        for (int block = 0; block < kCycle / kBlock; block++) {
+            memset(vseq.buses.data(), 0, vseq.buses.size() * sizeof(float));
+            for (int frame = 0; frame < kBlock; frame++) {
+                int tick = (block * kBlock + frame) / 16;
+                if (block == 0 && frame < 5) vseq.buses[frame] = 5.0f;
+                vseq.buses[19 * kBlock + frame] = tick * 0.5f;
+                vseq.buses[20 * kBlock + frame] = (tick % 2 == 0) ? 5.0f : 0.0f;
+            }
+            vseq.inst.factory->step(vseq.inst.algo, vseq.buses.data(), kBlock / 4);
         }
     }
+    vseq.inst.set("Record", 0);
+    vseq.step();
+    
+    int cvMismatches = 0;
+    int gateMismatches = 0;
+    for (int tick = 0; tick < 16; tick++) {
+        const int16_t* values = vseq.a->bankValues(*vseq.a->active, 0, (seqStart + 1 + tick) % 16);
+        float volts = ((values[1] + 32768) / 65535.0f) * 10.0f;
+        if (fabsf(volts - (tick * 0.5f)) > 0.001f) cvMismatches++;
+        uint8_t gate = vseq.a->gateSteps(0)[(gateStart + 1 + tick) % 16];
+        if (gateState(gate) != ((tick % 2 == 0) ? 1 : 0)) gateMismatches++;
+    }
+    EXPECT_EQ(cvMismatches, 0);
+    EXPECT_EQ(gateMismatches, 0);
+    
+    // With Record off the steps keep what was recorded
+    int16_t kept = vseq.a->bankValues(*vseq.a->active, 0, 3)[1];
+    for (int block = 0; block < 16; block++) {
+        vseq.clock();
+    }
+    EXPECT_EQ(vseq.a->bankValues(*vseq.a->active, 0, 3)[1], kept);
+}
+
+TEST_F(VSeqSequencerTest, LegacyPresetClockDivAtX1) {
+    // A number-array preset comes from before Clock Div did anything, so loading it sets every
+    // track to x1; a packed preset keeps the divisions it saved
+    mockReset();
+    loadPattern(vseq.inst, 3, 6, 32);
+    EXPECT_EQ(mockParameterSets, 9);
+    
+    mockReset();
+    mockJsonClear();
+    _NT_jsonStream stream(NULL);
+    vseq.inst.factory->serialise(vseq.inst.algo, stream);
+    _NT_jsonParse parse(NULL, 0);
+    mockJsonRewind();
+    EXPECT_TRUE(vseq.inst.factory->deserialise(vseq.inst.algo, parse));
+    EXPECT_EQ(mockParameterSets, 0);
 }
 
 // UI Tests for catch-based track selection
 TEST_F(VSeqSequencerTest, TrackPotCatchBehavior) {
     // Test that pot must catch track position before responding
-    vseq.selectedSeq = 3;
-    vseq.selectedTrack = 1;  // Track 1 = 20% position
-    vseq.trackPotCaught = false;
+    vseq.a->selectedSeq = 3;
+    vseq.a->selectedTrack = 1;  // Track 1 = 20% position
+    vseq.a->trackPotCaught = false;
     
     _NT_uiData data = {};
     data.controls = kNT_potL;
     
     // Pot at 50% - far from track 1's 20% position
     data.pots[0] = 0.50f;
-    customUi(&vseq, data);
-    EXPECT_EQ(vseq.selectedTrack, 1);  // Should not change
-    EXPECT_FALSE(vseq.trackPotCaught);  // Not caught yet
+    customUi(vseq, data);
+    EXPECT_EQ(vseq.a->selectedTrack, 1);  // Should not change
+    EXPECT_FALSE(vseq.a->trackPotCaught);  // Not caught yet
     
     // Move pot closer - still outside 5% tolerance
     data.pots[0] = 0.26f;
-    customUi(&vseq, data);
-    EXPECT_EQ(vseq.selectedTrack, 1);  // Still no change
-    EXPECT_FALSE(vseq.trackPotCaught);  // Still not caught
+    customUi(vseq, data);
+    EXPECT_EQ(vseq.a->selectedTrack, 1);  // Still no change
+    EXPECT_FALSE(vseq.a->trackPotCaught);  // Still not caught
     
     // Move pot within catch range (20% ± 5%)
     data.pots[0] = 0.22f;
-    customUi(&vseq, data);
-    EXPECT_EQ(vseq.selectedTrack, 1);  // Track doesn't change yet
-    EXPECT_TRUE(vseq.trackPotCaught);   // But now it's caught!
+    customUi(vseq, data);
+    EXPECT_EQ(vseq.a->selectedTrack, 1);  // Track doesn't change yet
+    EXPECT_TRUE(vseq.a->trackPotCaught);   // But now it's caught!
     
     // Now that it's caught, can change tracks
     data.pots[0] = 0.45f;  // Move to track 2 range (30-50%)
-    customUi(&vseq, data);
-    EXPECT_EQ(vseq.selectedTrack, 2);  // Should change to track 2
-    EXPECT_FALSE(vseq.trackPotCaught);  // Catch resets on track change
+    customUi(vseq, data);
+    EXPECT_EQ(vseq.a->selectedTrack, 2);  // Should change to track 2
+    EXPECT_FALSE(vseq.a->trackPotCaught);  // Catch resets on track change
 }
 
 TEST_F(VSeqSequencerTest, TrackPotFullRange) {
     // Test moving through all tracks from 0 to 5
-    vseq.selectedSeq = 3;
-    vseq.selectedTrack = 0;
-    vseq.trackPotCaught = true;  // Start caught
+    vseq.a->selectedSeq = 3;
+    vseq.a->selectedTrack = 0;
+    vseq.a->trackPotCaught = true;  // Start caught
     
     _NT_uiData data = {};
     data.controls = kNT_potL;
     
     // Track 0: 0-10%
     data.pots[0] = 0.05f;
-    customUi(&vseq, data);
-    EXPECT_EQ(vseq.selectedTrack, 0);
+    customUi(vseq, data);
+    EXPECT_EQ(vseq.a->selectedTrack, 0);
     
     // Move to track 1: 10-30%
-    vseq.trackPotCaught = true;  // Manually catch for test
+    vseq.a->trackPotCaught = true;  // Manually catch for test
     data.pots[0] = 0.25f;
-    customUi(&vseq, data);
-    EXPECT_EQ(vseq.selectedTrack, 1);
+    customUi(vseq, data);
+    EXPECT_EQ(vseq.a->selectedTrack, 1);
     
     // Move to track 2: 30-50%
-    vseq.trackPotCaught = true;
+    vseq.a->trackPotCaught = true;
     data.pots[0] = 0.45f;
-    customUi(&vseq, data);
-    EXPECT_EQ(vseq.selectedTrack, 2);
+    customUi(vseq, data);
+    EXPECT_EQ(vseq.a->selectedTrack, 2);
     
     // Move to track 3: 50-70%
-    vseq.trackPotCaught = true;
+    vseq.a->trackPotCaught = true;
     data.pots[0] = 0.65f;
-    customUi(&vseq, data);
-    EXPECT_EQ(vseq.selectedTrack, 3);
+    customUi(vseq, data);
+    EXPECT_EQ(vseq.a->selectedTrack, 3);
     
     // Move to track 4: 70-90%
-    vseq.trackPotCaught = true;
+    vseq.a->trackPotCaught = true;
     data.pots[0] = 0.85f;
-    customUi(&vseq, data);
-    EXPECT_EQ(vseq.selectedTrack, 4);
+    customUi(vseq, data);
+    EXPECT_EQ(vseq.a->selectedTrack, 4);
     
     // Move to track 5: 90-100%
-    vseq.trackPotCaught = true;
+    vseq.a->trackPotCaught = true;
     data.pots[0] = 0.95f;
-    customUi(&vseq, data);
-    EXPECT_EQ(vseq.selectedTrack, 5);
+    customUi(vseq, data);
+    EXPECT_EQ(vseq.a->selectedTrack, 5);
     
     // Can't go beyond track 5
-    vseq.trackPotCaught = true;
+    vseq.a->trackPotCaught = true;
     data.pots[0] = 1.0f;
-    customUi(&vseq, data);
-    EXPECT_EQ(vseq.selectedTrack, 5);  // Stays at 5
+    customUi(vseq, data);
+    EXPECT_EQ(vseq.a->selectedTrack, 5);  // Stays at 5
 }
 
 TEST_F(VSeqSequencerTest, TrackPotNoWrapAround) {
     // Test that tracks don't wrap around
-    vseq.selectedSeq = 3;
+    vseq.a->selectedSeq = 3;
     
     // At track 5, pot at max
-    vseq.selectedTrack = 5;
-    vseq.trackPotCaught = true;
+    vseq.a->selectedTrack = 5;
+    vseq.a->trackPotCaught = true;
     
     _NT_uiData data = {};
     data.controls = kNT_potL;
     data.pots[0] = 1.0f;
-    customUi(&vseq, data);
-    EXPECT_EQ(vseq.selectedTrack, 5);  // Stays at 5, doesn't wrap to 0
+    customUi(vseq, data);
+    EXPECT_EQ(vseq.a->selectedTrack, 5);  // Stays at 5, doesn't wrap to 0
     
     // At track 0, pot at min
-    vseq.selectedTrack = 0;
-    vseq.trackPotCaught = true;
+    vseq.a->selectedTrack = 0;
+    vseq.a->trackPotCaught = true;
     data.pots[0] = 0.0f;
-    customUi(&vseq, data);
-    EXPECT_EQ(vseq.selectedTrack, 0);  // Stays at 0, doesn't wrap to 5
+    customUi(vseq, data);
+    EXPECT_EQ(vseq.a->selectedTrack, 0);  // Stays at 0, doesn't wrap to 5
 }
 
 TEST_F(VSeqSequencerTest, TrackPotHysteresis) {
     // Test hysteresis prevents flickering at boundaries
-    vseq.selectedSeq = 3;
-    vseq.selectedTrack = 1;
-    vseq.trackPotCaught = true;
+    vseq.a->selectedSeq = 3;
+    vseq.a->selectedTrack = 1;
+    vseq.a->trackPotCaught = true;
     
     _NT_uiData data = {};
     data.controls = kNT_potL;
     
     // At boundary between track 1 and 2 (30%)
     data.pots[0] = 0.295f;  // Just below 30%
-    customUi(&vseq, data);
-    EXPECT_EQ(vseq.selectedTrack, 1);  // Still track 1
+    customUi(vseq, data);
+    EXPECT_EQ(vseq.a->selectedTrack, 1);  // Still track 1
     
     // Cross the boundary
-    vseq.trackPotCaught = true;
+    vseq.a->trackPotCaught = true;
     data.pots[0] = 0.305f;  // Just above 30%
-    customUi(&vseq, data);
-    EXPECT_EQ(vseq.selectedTrack, 2);  // Now track 2
+    customUi(vseq, data);
+    EXPECT_EQ(vseq.a->selectedTrack, 2);  // Now track 2
+}
+
+// Each test gets a freshly constructed instance
+static void run(void (*test)(VSeqTest& vseq)) {
+    VSeqTest vseq;
+    test(vseq);
 }
 
 // Main function for running tests
@@ -787,67 +1407,149 @@ int main(int argc, char **argv) {
     std::cout << "------------------\n";
     
     std::cout << "Test: CVForwardBasic\n";
-    vseq = VSeqTest();
-    test_VSeqSequencerTest_CVForwardBasic();
+    run(test_VSeqSequencerTest_CVForwardBasic);
     
     std::cout << "Test: CVBackwardBasic\n";
-    vseq = VSeqTest();
-    test_VSeqSequencerTest_CVBackwardBasic();
+    run(test_VSeqSequencerTest_CVBackwardBasic);
     
     std::cout << "Test: CVPingpongBasic\n";
-    vseq = VSeqTest();
-    test_VSeqSequencerTest_CVPingpongBasic();
+    run(test_VSeqSequencerTest_CVPingpongBasic);
     
     std::cout << "Test: CVSectionLooping\n";
-    vseq = VSeqTest();
-    test_VSeqSequencerTest_CVSectionLooping();
+    run(test_VSeqSequencerTest_CVSectionLooping);
+    
+    std::cout << "Test: GlideRampLength\n";
+    run(test_VSeqSequencerTest_GlideRampLength);
+    
+    std::cout << "Test: ModInputHysteresis\n";
+    run(test_VSeqSequencerTest_ModInputHysteresis);
     
     std::cout << "\nGate Sequencer Tests:\n";
     std::cout << "--------------------\n";
     
     std::cout << "Test: GateForwardBasic\n";
-    vseq = VSeqTest();
-    test_VSeqSequencerTest_GateForwardBasic();
+    run(test_VSeqSequencerTest_GateForwardBasic);
     
     std::cout << "Test: GateBackwardBasic\n";
-    vseq = VSeqTest();
-    test_VSeqSequencerTest_GateBackwardBasic();
+    run(test_VSeqSequencerTest_GateBackwardBasic);
     
     std::cout << "Test: GatePingpongBasic\n";
-    vseq = VSeqTest();
-    test_VSeqSequencerTest_GatePingpongBasic();
+    run(test_VSeqSequencerTest_GatePingpongBasic);
     
     std::cout << "Test: GateSectionLooping\n";
-    vseq = VSeqTest();
-    test_VSeqSequencerTest_GateSectionLooping();
+    run(test_VSeqSequencerTest_GateSectionLooping);
     
     std::cout << "Test: GateFillFeature\n";
-    vseq = VSeqTest();
-    test_VSeqSequencerTest_GateFillFeature();
+    run(test_VSeqSequencerTest_GateFillFeature);
     
     std::cout << "Test: GateBackwardSectionLooping\n";
-    vseq = VSeqTest();
-    test_VSeqSequencerTest_GateBackwardSectionLooping();
+    run(test_VSeqSequencerTest_GateBackwardSectionLooping);
+    
+    std::cout << "Test: RatchetsSpreadOverStep\n";
+    run(test_VSeqSequencerTest_RatchetsSpreadOverStep);
+    
+    std::cout << "Test: ChancePlaysItsShare\n";
+    run(test_VSeqSequencerTest_ChancePlaysItsShare);
+    
+    std::cout << "Test: EuclideanAndBake\n";
+    run(test_VSeqSequencerTest_EuclideanAndBake);
+    
+    std::cout << "Test: PlanAfterEdits\n";
+    run(test_VSeqSequencerTest_PlanAfterEdits);
+    
+    // Clock Tests
+    std::cout << "\nClock Tests:\n";
+    std::cout << "------------\n";
+    
+    std::cout << "Test: InternalClockNoDrift\n";
+    run(test_VSeqSequencerTest_InternalClockNoDrift);
+    
+    // Clock Link Tests
+    std::cout << "\nClock Link Tests:\n";
+    std::cout << "-----------------\n";
+    
+    std::cout << "Test: FollowerLocksToLead\n";
+    run(test_VSeqSequencerTest_FollowerLocksToLead);
+    
+    std::cout << "Test: FollowerJoinsFarIntoSong\n";
+    run(test_VSeqSequencerTest_FollowerJoinsFarIntoSong);
+    
+    // Output Tests
+    std::cout << "\nOutput Tests:\n";
+    std::cout << "------------\n";
+    
+    std::cout << "Test: OutputsReplaceBusContents\n";
+    run(test_VSeqSequencerTest_OutputsReplaceBusContents);
+    
+    std::cout << "Test: EditsApplyAtBlockStart\n";
+    run(test_VSeqSequencerTest_EditsApplyAtBlockStart);
+    
+    std::cout << "Test: BankSwitchOnBoundary\n";
+    run(test_VSeqSequencerTest_BankSwitchOnBoundary);
+    
+    // MIDI Tests
+    std::cout << "\nMIDI Tests:\n";
+    std::cout << "----------\n";
+    
+    std::cout << "Test: GateCcEveryTrigger\n";
+    run(test_VSeqSequencerTest_GateCcEveryTrigger);
+    
+    std::cout << "Test: MidiClockBurstKeepsTempo\n";
+    run(test_VSeqSequencerTest_MidiClockBurstKeepsTempo);
+    
+    std::cout << "Test: MidiClockIgnoredWhileCv\n";
+    run(test_VSeqSequencerTest_MidiClockIgnoredWhileCv);
+    
+    std::cout << "Test: MidiClockMatchesCvClock\n";
+    run(test_VSeqSequencerTest_MidiClockMatchesCvClock);
+    
+    std::cout << "Test: SongPositionMatchesPlayback\n";
+    run(test_VSeqSequencerTest_SongPositionMatchesPlayback);
+    
+    std::cout << "Test: PingpongSeekIsBounded\n";
+    run(test_VSeqSequencerTest_PingpongSeekIsBounded);
+    
+    // Display Tests
+    std::cout << "\nDisplay Tests:\n";
+    std::cout << "--------------\n";
+    
+    std::cout << "Test: BlitsMatchPixelReference\n";
+    run(test_VSeqSequencerTest_BlitsMatchPixelReference);
+    
+    std::cout << "Test: RetainedFrameMatchesRedraw\n";
+    run(test_VSeqSequencerTest_RetainedFrameMatchesRedraw);
+    
+    std::cout << "Test: DrawLeavesUnchangedFrame\n";
+    run(test_VSeqSequencerTest_DrawLeavesUnchangedFrame);
+    
+    // Parameter Tests
+    std::cout << "\nParameter Tests:\n";
+    std::cout << "---------------\n";
+    
+    std::cout << "Test: RecordTargetsWithoutTracks\n";
+    run(test_VSeqSequencerTest_RecordTargetsWithoutTracks);
+    
+    std::cout << "Test: LegacyPresetClockDivAtX1\n";
+    run(test_VSeqSequencerTest_LegacyPresetClockDivAtX1);
+    
+    std::cout << "Test: RecordsInputsAtTicks\n";
+    run(test_VSeqSequencerTest_RecordsInputsAtTicks);
     
     // UI Tests
     std::cout << "\nUI Tests:\n";
     std::cout << "--------\n";
     
     std::cout << "Test: TrackPotCatchBehavior\n";
-    vseq = VSeqTest();
-    test_VSeqSequencerTest_TrackPotCatchBehavior();
+    run(test_VSeqSequencerTest_TrackPotCatchBehavior);
     
     std::cout << "Test: TrackPotFullRange\n";
-    vseq = VSeqTest();
-    test_VSeqSequencerTest_TrackPotFullRange();
+    run(test_VSeqSequencerTest_TrackPotFullRange);
     
     std::cout << "Test: TrackPotNoWrapAround\n";
-    vseq = VSeqTest();
-    test_VSeqSequencerTest_TrackPotNoWrapAround();
+    run(test_VSeqSequencerTest_TrackPotNoWrapAround);
     
     std::cout << "Test: TrackPotHysteresis\n";
-    vseq = VSeqTest();
-    test_VSeqSequencerTest_TrackPotHysteresis();
+    run(test_VSeqSequencerTest_TrackPotHysteresis);
     
     // Summary
     std::cout << "\n=======================\n";
@@ -0,0 +1,135 @@
+// One plugin instance on the host, driven only through its factory like the Disting NT firmware
+// does, for the benchmarks and the golden output renderer. Needs nt_mock.cpp.
+#pragma once
+
+#include "nt_mock.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static const int kNumBuses = 28;
+static const int kOutsPerSeq = 3;
+
+// One algorithm instance with its memory and parameter values
+struct Instance {
+    const _NT_factory* factory;
+    std::vector<uint8_t> sram;
+    std::vector<uint8_t> dram;
+    std::vector<int16_t> values;
+    _NT_algorithm* algo;
+    uint32_t numParameters;
+    
+    Instance(int factoryIndex, const int32_t* specs) {
+        factory = (const _NT_factory*)pluginEntry(kNT_selector_factoryInfo, factoryIndex);
+        _NT_algorithmRequirements req;
+        memset(&req, 0, sizeof(req));
+        factory->calculateRequirements(req, specs);
+        sram.assign(req.sram, 0);
+        dram.assign(req.dram, 0);
+        _NT_algorithmMemoryPtrs ptrs = { sram.data(), dram.data(), NULL, NULL };
+        algo = factory->construct(ptrs, req, specs);
+        numParameters = req.numParameters;
+        values.resize(numParameters);
+        for (uint32_t i = 0; i < numParameters; i++) {
+            values[i] = algo->parameters[i].def;
+        }
+        algo->v = values.data();
+        algo->vIncludingCommon = values.data();
+        applyAll();
+    }
+    
+    int param(const char* name) const {
+        for (uint32_t i = 0; i < numParameters; i++) {
+            if (strcmp(algo->parameters[i].name, name) == 0) return (int)i;
+        }
+        return -1;
+    }
+    
+    void set(const char* name, int value) {
+        int p = param(name);
+        if (p < 0) return;
+        values[p] = (int16_t)value;
+        factory->parameterChanged(algo, p);
+    }
+    
+    void applyAll() {
+        for (uint32_t i = 0; i < numParameters; i++) {
+            factory->parameterChanged(algo, (int)i);
+        }
+    }
+};
+
+// Pattern values from a fixed xorshift32 sequence rather than rand(), so every host C library
+// loads the same pattern
+inline uint32_t patternRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// Load a busy pattern through the older number-array preset members. Every instance gets the
+// same pattern, so runs are comparable. Gate steps are off, on or accented.
+inline void loadPattern(Instance& inst, int cvSeqs, int gateTracks, int maxSteps) {
+    uint32_t state = 1;
+    _NT_jsonStream stream(NULL);
+    mockJsonClear();
+    stream.addMemberName("stepValues");
+    stream.openArray();
+    for (int seq = 0; seq < cvSeqs; seq++) {
+        stream.openArray();
+        for (int step = 0; step < maxSteps; step++) {
+            stream.openArray();
+            for (int out = 0; out < kOutsPerSeq; out++) {
+                stream.addNumber((int)(patternRandom(state) % 65536) - 32768);
+            }
+            stream.closeArray();
+        }
+        stream.closeArray();
+    }
+    stream.closeArray();
+    stream.addMemberName("gateSteps");
+    stream.openArray();
+    for (int track = 0; track < gateTracks; track++) {
+        stream.openArray();
+        for (int step = 0; step < maxSteps; step++) {
+            stream.addNumber((int)(patternRandom(state) % 3));
+        }
+        stream.closeArray();
+    }
+    stream.closeArray();
+    
+    _NT_jsonParse parse(NULL, 0);
+    mockJsonRewind();
+    inst.factory->deserialise(inst.algo, parse);
+}
+
+// Route every output to a bus, run every trigger track and set every clock division
+inline void configure(Instance& inst, int cvSeqs, int gateTracks, int division) {
+    char name[32];
+    int bus = 3;    // Buses 1 and 2 are the clock and reset inputs
+    for (int seq = 0; seq < cvSeqs; seq++) {
+        for (int out = 0; out < kOutsPerSeq; out++) {
+            snprintf(name, sizeof(name), "Seq %d Out %d", seq + 1, out + 1);
+            inst.set(name, (bus++ - 1) % kNumBuses + 1);
+        }
+        snprintf(name, sizeof(name), "Seq %d MIDI 1", seq + 1);
+        inst.set(name, seq + 1);
+        snprintf(name, sizeof(name), "Seq %d Clock Div", seq + 1);
+        inst.set(name, division);
+    }
+    for (int track = 0; track < gateTracks; track++) {
+        snprintf(name, sizeof(name), "Gate %d Out", track + 1);
+        inst.set(name, (bus++ - 1) % kNumBuses + 1);
+        snprintf(name, sizeof(name), "Gate %d Run", track + 1);
+        inst.set(name, 1);
+        snprintf(name, sizeof(name), "Gate %d ClockDiv", track + 1);
+        inst.set(name, division);
+        snprintf(name, sizeof(name), "Gate %d Swing", track + 1);
+        inst.set(name, (track & 1) ? 30 : 0);
+        snprintf(name, sizeof(name), "Gate %d CC", track + 1);
+        inst.set(name, 20 + track);
+    }
+    inst.set("Trigger MIDI Ch", 10);
+}